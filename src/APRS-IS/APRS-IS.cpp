@@ -1,85 +1,520 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef ESP_PLATFORM
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#else
+#include <netdb.h>
+#endif
+
 #include "APRS-IS.h"
-#include <logger.h>
 
-void APRS_IS::setup(const String &user, const String &passcode, const String &tool_name, const String &version) {
-  _user      = user;
-  _passcode  = passcode;
-  _tool_name = tool_name;
-  _version   = version;
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#ifdef ESP_PLATFORM
+// runs in the lwIP task, possibly after we gave up on the request already
+static void dnsFound(const char *name, const ip_addr_t *address, void *arg) {
+  AprsIsDnsRequest *request = (AprsIsDnsRequest *)arg;
+  if (strcmp(name, request->host) != 0) {
+    return;
+  }
+  if (address != 0 && IP_IS_V4(address)) {
+    request->address = ip_2_ip4(address)->addr;
+    request->found   = true;
+  } else {
+    request->found = false;
+  }
+  request->done = true;
 }
+#endif
 
-APRS_IS::ConnectionStatus APRS_IS::connect(const String &server, const int port) {
-  const String login = "user " + _user + " pass " + _passcode + " vers " + _tool_name + " " + _version + "\n\r";
-  return _connect(server, port, login);
+APRS_IS::APRS_IS() : _serverCount(0), _currentServer(0), _state(Idle), _lastError(ErrorNone), _stateStart(0), _lastReceived(0), _now(0), _backoffDelay(0), _failures(0), _connectAttempts(0), _random(2463534242u), _socket(-1), _address(0), _rxStart(0), _rxLength(0), _rxSkipLine(false), _txLength(0), _txPackets(0), _txBatchBytes(0), _txQueuedAt(0), _txFlushing(false), _sendDropped(0) {
+  _user[0]  = 0;
+  _login[0] = 0;
+  memset(&_dns, 0, sizeof(_dns));
 }
 
-APRS_IS::ConnectionStatus APRS_IS::connect(const String &server, const int port, const String &filter) {
-  const String login = "user " + _user + " pass " + _passcode + " vers " + _tool_name + " " + _version + " filter " + filter + "\n\r";
-  return _connect(server, port, login);
+APRS_IS::~APRS_IS() {
+  closeSocket();
 }
 
-APRS_IS::ConnectionStatus APRS_IS::_connect(const String &server, const int port, const String &login_line) {
-  if (!_client.connect(server.c_str(), port)) {
-    return ERROR_CONNECTION;
+void APRS_IS::setup(const char *user, const char *passcode, const char *tool_name, const char *version, const char *filter) {
+  snprintf(_user, sizeof(_user), "%s", user);
+  if (filter != 0 && strlen(filter) > 0) {
+    snprintf(_login, sizeof(_login), "user %s pass %s vers %s %s filter %s\r\n", user, passcode, tool_name, version, filter);
+  } else {
+    snprintf(_login, sizeof(_login), "user %s pass %s vers %s %s\r\n", user, passcode, tool_name, version);
   }
-  sendMessage(login_line);
-  while (true) {
-    String line = _client.readStringUntil('\n');
-    if (line.indexOf("logresp") != -1) {
-      if (line.indexOf("unverified") == -1) {
-        return SUCCESS;
-      } else {
-        return ERROR_PASSCODE;
-      }
+}
+
+bool APRS_IS::addServer(const char *host, uint16_t port) {
+  if (_serverCount >= MAX_SERVERS || strlen(host) == 0 || strlen(host) >= sizeof(_servers[0].host)) {
+    return false;
+  }
+  strcpy(_servers[_serverCount].host, host);
+  _servers[_serverCount].port = port;
+  _serverCount++;
+  return true;
+}
+
+void APRS_IS::setRandomSeed(uint32_t seed) {
+  _random = seed != 0 ? seed : 2463534242u;
+}
+
+APRS_IS::State APRS_IS::loop(uint32_t now) {
+  _now = now;
+  switch (_state) {
+  case Idle:
+    if (_serverCount > 0) {
+      startResolve(now);
+    }
+    break;
+  case Resolving:
+    pollResolve(now);
+    break;
+  case Connecting:
+    pollConnect(now);
+    break;
+  case LoggingIn:
+    pollLogin(now);
+    break;
+  case Connected:
+    if (_txLength >= FLUSH_SIZE || (_txPackets > 0 && now - _txQueuedAt >= FLUSH_LATENCY)) {
+      _txFlushing = true;
+    }
+    if (_txFlushing && !flush()) {
+      fail(ErrorClosed, now);
+    } else if (now - _lastReceived >= IDLE_TIMEOUT) {
+      fail(ErrorIdleTimeout, now);
+    }
+    break;
+  case Backoff:
+    if (now - _stateStart >= _backoffDelay) {
+      startResolve(now);
     }
+    break;
   }
-  return SUCCESS;
+  return _state;
+}
+
+void APRS_IS::disconnect() {
+  closeSocket();
+  enter(Idle, _now);
+}
+
+APRS_IS::State APRS_IS::getState() const {
+  return _state;
+}
+
+APRS_IS::Error APRS_IS::getLastError() const {
+  return _lastError;
+}
+
+bool APRS_IS::connected() const {
+  return _state == Connected;
+}
+
+const char *APRS_IS::getServer() const {
+  return _serverCount > 0 ? _servers[_currentServer].host : "";
+}
+
+uint16_t APRS_IS::getPort() const {
+  return _serverCount > 0 ? _servers[_currentServer].port : 0;
 }
 
-bool APRS_IS::connected() {
-  return _client.connected();
+uint32_t APRS_IS::getBackoffDelay() const {
+  return _backoffDelay;
 }
 
-bool APRS_IS::sendMessage(const String &message) {
+uint32_t APRS_IS::getConnectAttempts() const {
+  return _connectAttempts;
+}
+
+bool APRS_IS::canSend() const {
+  return connected() && TX_BUFFER_SIZE - _txLength >= MAX_LINE_LENGTH;
+}
+
+bool APRS_IS::sendMessage(const std::shared_ptr<AprsPacket> packet) {
   if (!connected()) {
     return false;
   }
-  _client.println(message);
+  // packets heard on RF get the q construct of this gateway
+  const char  *gateway = packet->getOrigin() == OriginRf ? _user : 0;
+  const size_t room    = TX_BUFFER_SIZE - _txLength;
+  const size_t length  = room > 2 ? packet->encode(_txBuffer + _txLength, room - 2, gateway) : 0;
+  if (length == 0) {
+    _sendDropped++;
+    return false;
+  }
+  _txBuffer[_txLength + length]     = '\r';
+  _txBuffer[_txLength + length + 1] = '\n';
+  if (_txPackets == 0) {
+    _txQueuedAt = _now;
+  }
+  _txLength += length + 2;
+  _txPackets++;
   return true;
 }
 
-bool APRS_IS::sendMessage(const std::shared_ptr<APRSMessage> message) {
+bool APRS_IS::hasPendingWrite() const {
+  return _txLength > 0;
+}
+
+uint32_t APRS_IS::getFlushDeadline() const {
+  if (_txPackets == 0) {
+    return 0;
+  }
+  if (_txFlushing || _txLength >= FLUSH_SIZE) {
+    return _txQueuedAt;
+  }
+  return _txQueuedAt + FLUSH_LATENCY;
+}
+
+const Histogram &APRS_IS::getFlushBytes() const {
+  return _flushBytes;
+}
+
+const Histogram &APRS_IS::getFlushPackets() const {
+  return _flushPackets;
+}
+
+uint32_t APRS_IS::getSendDropped() const {
+  return _sendDropped;
+}
+
+std::shared_ptr<AprsPacket> APRS_IS::getAprsPacket() {
   if (!connected()) {
-    return false;
+    return 0;
+  }
+  // lines already buffered first, the socket is only read once they are used up
+  PacketView line;
+  for (bool received = false;; received = true) {
+    while (nextLine(line)) {
+      // server comments and keepalives
+      if (line.empty() || line.data[0] == '#') {
+        continue;
+      }
+      std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+      if (packet->decode(line.data, line.length)) {
+        packet->setOrigin(OriginAprsIs);
+        return packet;
+      }
+    }
+    if (received) {
+      return 0;
+    }
+    if (!receive(_now)) {
+      fail(ErrorClosed, _now);
+      return 0;
+    }
   }
-  _client.println(message->encode() + "\n");
-  return true;
 }
 
-int APRS_IS::available() {
-  return _client.available();
+bool APRS_IS::hasReceivedLine() const {
+  return connected() && memchr(_rxBuffer + _rxStart, '\n', _rxLength - _rxStart) != 0;
 }
 
-String APRS_IS::getMessage() {
-  String line;
-  if (_client.available() > 0) {
-    line = _client.readStringUntil('\n');
+const char *APRS_IS::toString(State state) {
+  switch (state) {
+  case Idle:
+    return "idle";
+  case Resolving:
+    return "resolving";
+  case Connecting:
+    return "connecting";
+  case LoggingIn:
+    return "logging in";
+  case Connected:
+    return "connected";
+  case Backoff:
+    return "waiting";
   }
-  return line;
+  return "";
 }
 
-std::shared_ptr<APRSMessage> APRS_IS::getAPRSMessage() {
-  String line;
-  if (_client.available() > 0) {
-    line = _client.readStringUntil('\n');
+const char *APRS_IS::toString(Error error) {
+  switch (error) {
+  case ErrorNone:
+    return "no error";
+  case ErrorDns:
+    return "host not found";
+  case ErrorDnsTimeout:
+    return "DNS timeout";
+  case ErrorConnect:
+    return "connection failed";
+  case ErrorConnectTimeout:
+    return "connect timeout";
+  case ErrorLoginTimeout:
+    return "login timeout";
+  case ErrorPasscode:
+    return "user can not be verified with passcode";
+  case ErrorClosed:
+    return "connection closed";
+  case ErrorIdleTimeout:
+    return "nothing received for too long";
   }
-  if (line.startsWith("#")) {
-    return 0;
+  return "";
+}
+
+void APRS_IS::enter(State state, uint32_t now) {
+  _state      = state;
+  _stateStart = now;
+}
+
+void APRS_IS::fail(Error error, uint32_t now) {
+  closeSocket();
+  _lastError = error;
+  _failures++;
+  _currentServer = (_currentServer + 1) % _serverCount;
+
+  // exponential backoff with equal jitter: half of the delay is random
+  uint32_t delay = BACKOFF_MAX;
+  if (_failures <= 16 && (BACKOFF_MIN << (_failures - 1)) < BACKOFF_MAX) {
+    delay = BACKOFF_MIN << (_failures - 1);
   }
-  if (line.length() == 0) {
-    return 0;
+  _backoffDelay = delay / 2 + nextRandom() % (delay / 2 + 1);
+  enter(Backoff, now);
+}
+
+void APRS_IS::closeSocket() {
+  if (_socket >= 0) {
+    close(_socket);
+    _socket = -1;
+  }
+  _sendDropped += _txPackets;
+  _rxStart      = 0;
+  _rxLength     = 0;
+  _rxSkipLine   = false;
+  _txLength     = 0;
+  _txPackets    = 0;
+  _txBatchBytes = 0;
+  _txFlushing   = false;
+}
+
+void APRS_IS::startResolve(uint32_t now) {
+  _connectAttempts++;
+  const Server  &server = _servers[_currentServer];
+  struct in_addr address;
+  if (inet_pton(AF_INET, server.host, &address) == 1) {
+    _address = address.s_addr;
+    startConnect(now);
+    return;
+  }
+
+  enter(Resolving, now);
+  strcpy(_dns.host, server.host);
+  _dns.done  = false;
+  _dns.found = false;
+#ifdef ESP_PLATFORM
+  ip_addr_t result;
+  LOCK_TCPIP_CORE();
+  err_t err = dns_gethostbyname(_dns.host, &result, dnsFound, &_dns);
+  UNLOCK_TCPIP_CORE();
+  if (err == ERR_OK) {
+    _address = ip_2_ip4(&result)->addr;
+    startConnect(now);
+  } else if (err != ERR_INPROGRESS) {
+    fail(ErrorDns, now);
+  }
+#else
+  // hosts without lwIP: resolve right away, only used for tests
+  struct addrinfo  hints;
+  struct addrinfo *info = 0;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(_dns.host, 0, &hints, &info) != 0 || info == 0) {
+    fail(ErrorDns, now);
+    return;
+  }
+  _address = ((struct sockaddr_in *)info->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(info);
+  startConnect(now);
+#endif
+}
+
+void APRS_IS::pollResolve(uint32_t now) {
+  if (_dns.done) {
+    if (_dns.found) {
+      _address = _dns.address;
+      startConnect(now);
+    } else {
+      fail(ErrorDns, now);
+    }
+  } else if (now - _stateStart >= DNS_TIMEOUT) {
+    fail(ErrorDnsTimeout, now);
   }
-  std::shared_ptr<APRSMessage> msg = std::shared_ptr<APRSMessage>(new APRSMessage());
-  msg->decode(line);
-  return msg;
+}
+
+void APRS_IS::startConnect(uint32_t now) {
+  _socket = socket(AF_INET, SOCK_STREAM, 0);
+  if (_socket < 0) {
+    fail(ErrorConnect, now);
+    return;
+  }
+  fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(_servers[_currentServer].port);
+  address.sin_addr.s_addr = _address;
+  if (connect(_socket, (struct sockaddr *)&address, sizeof(address)) != 0 && errno != EINPROGRESS) {
+    fail(ErrorConnect, now);
+    return;
+  }
+  enter(Connecting, now);
+  pollConnect(now);
+}
+
+void APRS_IS::pollConnect(uint32_t now) {
+  fd_set writeSet;
+  FD_ZERO(&writeSet);
+  FD_SET(_socket, &writeSet);
+  struct timeval timeout = {0, 0};
+  const int      ready   = select(_socket + 1, 0, &writeSet, 0, &timeout);
+  if (ready < 0) {
+    fail(ErrorConnect, now);
+    return;
+  }
+  if (ready == 0) {
+    if (now - _stateStart >= CONNECT_TIMEOUT) {
+      fail(ErrorConnectTimeout, now);
+    }
+    return;
+  }
+  int       error  = 0;
+  socklen_t length = sizeof(error);
+  if (getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+    fail(ErrorConnect, now);
+    return;
+  }
+
+  _rxStart      = 0;
+  _rxLength     = 0;
+  _txLength     = 0;
+  _lastReceived = now;
+  write(_login, strlen(_login));
+  enter(LoggingIn, now);
+  pollLogin(now);
+}
+
+void APRS_IS::pollLogin(uint32_t now) {
+  if (!flush() || !receive(now)) {
+    fail(ErrorClosed, now);
+    return;
+  }
+  PacketView line;
+  while (nextLine(line)) {
+    if (line.contains("logresp")) {
+      if (line.contains("unverified")) {
+        fail(ErrorPasscode, now);
+      } else {
+        _failures     = 0;
+        _backoffDelay = 0;
+        _lastError    = ErrorNone;
+        enter(Connected, now);
+      }
+      return;
+    }
+  }
+  if (now - _stateStart >= LOGIN_TIMEOUT) {
+    fail(ErrorLoginTimeout, now);
+  }
+}
+
+// reads whatever the socket has, false if the connection is gone
+bool APRS_IS::receive(uint32_t now) {
+  // only the start of an incomplete line is left, move it to the front
+  if (_rxStart > 0) {
+    memmove(_rxBuffer, _rxBuffer + _rxStart, _rxLength - _rxStart);
+    _rxLength -= _rxStart;
+    _rxStart = 0;
+  }
+  if (_rxLength == RX_BUFFER_SIZE) {
+    // a line longer than the whole buffer, throw it away up to its end
+    _rxLength   = 0;
+    _rxSkipLine = true;
+  }
+  const ssize_t received = recv(_socket, _rxBuffer + _rxLength, RX_BUFFER_SIZE - _rxLength, MSG_DONTWAIT);
+  if (received > 0) {
+    _rxLength += received;
+    _lastReceived = now;
+    return true;
+  }
+  if (received == 0) {
+    return false;
+  }
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+// the next complete line in the receive buffer without its line end, valid until the next receive()
+bool APRS_IS::nextLine(PacketView &line) {
+  while (true) {
+    const char *begin = _rxBuffer + _rxStart;
+    const char *end   = (const char *)memchr(begin, '\n', _rxLength - _rxStart);
+    if (end == 0) {
+      return false;
+    }
+    _rxStart = end - _rxBuffer + 1;
+    if (_rxSkipLine) {
+      _rxSkipLine = false;
+      continue;
+    }
+    size_t length = end - begin;
+    if (length > 0 && begin[length - 1] == '\r') {
+      length--;
+    }
+    line = PacketView(begin, length);
+    return true;
+  }
+}
+
+bool APRS_IS::write(const char *data, size_t length) {
+  if (_txLength + length > TX_BUFFER_SIZE) {
+    return false;
+  }
+  memcpy(_txBuffer + _txLength, data, length);
+  _txLength += length;
+  return true;
+}
+
+// sends as much of the transmit buffer as the socket takes, false if the connection is gone
+bool APRS_IS::flush() {
+  while (_txLength > 0) {
+    const ssize_t sent = send(_socket, _txBuffer, _txLength, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    memmove(_txBuffer, _txBuffer + sent, _txLength - sent);
+    _txLength -= sent;
+    _txBatchBytes += sent;
+  }
+  // the login line is no batch of packets
+  if (_txPackets > 0) {
+    _flushBytes.add(_txBatchBytes);
+    _flushPackets.add(_txPackets);
+  }
+  _txPackets    = 0;
+  _txBatchBytes = 0;
+  _txFlushing   = false;
+  return true;
+}
+
+uint32_t APRS_IS::nextRandom() {
+  // xorshift32
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return _random;
 }
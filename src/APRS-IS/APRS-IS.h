@@ -1,40 +1,176 @@
-
 #ifndef APRS_IS_Lib_h_
 #define APRS_IS_Lib_h_
 
-#include <APRS-Decoder.h>
-#include <WiFi.h>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Packet/AprsPacket.h"
+#include "System/Histogram.h"
+
+#define APRS_IS_HOST_LENGTH 64
+
+// filled in by the asynchronous DNS lookup
+class AprsIsDnsRequest {
+public:
+  char              host[APRS_IS_HOST_LENGTH];
+  volatile bool     done;
+  volatile bool     found;
+  volatile uint32_t address;
+};
 
+// APRS-IS client on a non-blocking socket. loop() moves the connection
+// through its states and never waits:
+//
+//   Idle -> Resolving -> Connecting -> LoggingIn -> Connected
+//
+// Every step has a timeout. On any failure the socket is closed, the next
+// server of the list is picked and the client waits in Backoff for an
+// exponentially growing, jittered delay before it starts over.
+//
+// Outgoing packets are encoded straight into the transmit buffer and sent
+// in batches, once FLUSH_SIZE bytes are pending or the oldest of them
+// waited FLUSH_LATENCY ms, so a burst leaves in a few TCP segments.
 class APRS_IS {
 public:
-  void setup(const String &user, const String &passcode, const String &tool_name, const String &version);
+  enum State {
+    Idle,
+    Resolving,
+    Connecting,
+    LoggingIn,
+    Connected,
+    Backoff,
+  };
 
-  enum ConnectionStatus {
-    SUCCESS,
-    ERROR_CONNECTION,
-    ERROR_PASSCODE,
+  enum Error {
+    ErrorNone,
+    ErrorDns,
+    ErrorDnsTimeout,
+    ErrorConnect,
+    ErrorConnectTimeout,
+    ErrorLoginTimeout,
+    ErrorPasscode,
+    ErrorClosed,
+    ErrorIdleTimeout,
   };
 
-  ConnectionStatus connect(const String &server, const int port);
-  ConnectionStatus connect(const String &server, const int port, const String &filter);
-  bool             connected();
+  static const size_t MAX_SERVERS    = 4;
+  static const size_t RX_BUFFER_SIZE = 512;
+  static const size_t TX_BUFFER_SIZE = 1024;
+  static const size_t FLUSH_SIZE     = 512;
+  static const size_t LOGIN_LENGTH   = 256;
+  static const size_t USER_LENGTH    = 16;
+  // longest line sendMessage() may add: packet, q construct and CRLF
+  static const size_t MAX_LINE_LENGTH = AprsPacket::MAX_LENGTH + 5 + USER_LENGTH + 2;
+
+  static const uint32_t DNS_TIMEOUT     = 10000;
+  static const uint32_t CONNECT_TIMEOUT = 10000;
+  static const uint32_t LOGIN_TIMEOUT   = 15000;
+  // servers send a keepalive comment every 20 s
+  static const uint32_t IDLE_TIMEOUT  = 120000;
+  static const uint32_t BACKOFF_MIN   = 1000;
+  static const uint32_t BACKOFF_MAX   = 5 * 60 * 1000;
+  static const uint32_t FLUSH_LATENCY = 50;
+
+  APRS_IS();
+  ~APRS_IS();
+
+  void setup(const char *user, const char *passcode, const char *tool_name, const char *version, const char *filter = "");
+  bool addServer(const char *host, uint16_t port);
+  void setRandomSeed(uint32_t seed);
+
+  // advances the connection state machine, never blocks
+  State loop(uint32_t now);
+  void  disconnect();
+
+  State       getState() const;
+  Error       getLastError() const;
+  bool        connected() const;
+  const char *getServer() const;
+  uint16_t    getPort() const;
+  uint32_t    getBackoffDelay() const;
+  uint32_t    getConnectAttempts() const;
 
-  bool sendMessage(const String &message);
-  bool sendMessage(const std::shared_ptr<APRSMessage> message);
+  // true if sendMessage() has room for another packet
+  bool     canSend() const;
+  // queues the packet for the next flush, false if it does not fit
+  bool     sendMessage(const std::shared_ptr<AprsPacket> packet);
+  bool     hasPendingWrite() const;
+  // millis() timestamp of the next latency flush, 0 if nothing is waiting
+  uint32_t getFlushDeadline() const;
 
-  int available();
+  const Histogram &getFlushBytes() const;
+  const Histogram &getFlushPackets() const;
+  uint32_t         getSendDropped() const;
 
-  String                       getMessage();
-  std::shared_ptr<APRSMessage> getAPRSMessage();
+  // the next packet received, empty if there is none (yet). Lines are
+  // decoded straight from the receive buffer, comments are skipped.
+  std::shared_ptr<AprsPacket> getAprsPacket();
+  // true if complete lines are still waiting in the receive buffer
+  bool hasReceivedLine() const;
+
+  static const char *toString(State state);
+  static const char *toString(Error error);
 
 private:
-  String     _user;
-  String     _passcode;
-  String     _tool_name;
-  String     _version;
-  WiFiClient _client;
+  class Server {
+  public:
+    char     host[APRS_IS_HOST_LENGTH];
+    uint16_t port;
+  };
+
+  Server _servers[MAX_SERVERS];
+  size_t _serverCount;
+  size_t _currentServer;
+
+  char _user[USER_LENGTH];
+  char _login[LOGIN_LENGTH];
+
+  State    _state;
+  Error    _lastError;
+  uint32_t _stateStart;
+  uint32_t _lastReceived;
+  uint32_t _now;
+  uint32_t _backoffDelay;
+  uint32_t _failures;
+  uint32_t _connectAttempts;
+  uint32_t _random;
+  int      _socket;
+  uint32_t _address;
+
+  AprsIsDnsRequest _dns;
+
+  char   _rxBuffer[RX_BUFFER_SIZE];
+  size_t _rxStart; // lines before it are consumed
+  size_t _rxLength;
+  bool   _rxSkipLine;
+
+  char     _txBuffer[TX_BUFFER_SIZE];
+  size_t   _txLength;
+  size_t   _txPackets; // packets in the buffer, counted to the batch once sent
+  size_t   _txBatchBytes;
+  uint32_t _txQueuedAt;
+  bool     _txFlushing;
+
+  Histogram _flushBytes;
+  Histogram _flushPackets;
+  uint32_t  _sendDropped;
+
+  void enter(State state, uint32_t now);
+  void fail(Error error, uint32_t now);
+  void closeSocket();
+
+  void startResolve(uint32_t now);
+  void pollResolve(uint32_t now);
+  void startConnect(uint32_t now);
+  void pollConnect(uint32_t now);
+  void pollLogin(uint32_t now);
 
-  ConnectionStatus _connect(const String &server, const int port, const String &login_line);
+  bool     receive(uint32_t now);
+  bool     nextLine(PacketView &line);
+  bool     write(const char *data, size_t length);
+  bool     flush();
+  uint32_t nextRandom();
 };
 
 #endif
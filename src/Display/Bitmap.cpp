@@ -11,9 +11,7 @@ Bitmap::Bitmap(OLEDDisplay *display) : _width(display->getWidth()), _height(disp
 }
 
 Bitmap::~Bitmap() {
-  if (_buffer != 0) {
-    delete _buffer;
-  }
+  delete[] _buffer;
 }
 
 uint Bitmap::getWidth() const {
@@ -227,36 +225,60 @@ int Bitmap::drawChar(int x, int y, char c) {
     cu = '?';
   }
 
-  int firstPixelBitPos = 0;
-  for (int i = 0; i < (cu - font->firstChar); i++) {
-    firstPixelBitPos = firstPixelBitPos + font->pData[i];
-  }
-  firstPixelBitPos = firstPixelBitPos * font->heightInPixel;
-
   unsigned char const *pDataStart   = &(font->pData[font->lastChar - font->firstChar + 1]);
-  const int            top          = y;
+  const uint           height       = font->heightInPixel;
   const int            widthInPixel = font->pData[cu - font->firstChar];
-  for (int i = 0; i < widthInPixel * font->heightInPixel; i++) {
-    int bytePos = firstPixelBitPos / 8;
-    int bitPos  = firstPixelBitPos % 8;
-
-    if (pDataStart[bytePos] & (1 << bitPos)) {
-      setPixel(x, y);
-    } else {
-      clearPixel(x, y);
+  uint32_t             bitPos       = font->pOffsets[cu - font->firstChar] * height;
+  for (int i = 0; i < widthInPixel; i++, x++, bitPos += height) {
+    if (x < 0 || x >= (int)_width) {
+      continue;
     }
-
-    firstPixelBitPos++;
-    y++;
-    if (y == top + font->heightInPixel) {
-      y = top;
-      x++;
+    // fonts of 8 pixel height keep every column in one byte, on a page boundary it is stored as is
+    if (height == 8 && y >= 0 && y % 8 == 0 && y < (int)_height) {
+      _buffer[x + (y / 8) * _width] = pDataStart[bitPos / 8];
+    } else {
+      drawColumn(x, y, readBits(pDataStart, bitPos, height), height);
     }
   }
 
   return x + FONT_CHAR_SPACING;
 }
 
+// the glyph bits of the font are packed LSB first, a column is the next height bits
+uint32_t Bitmap::readBits(unsigned char const *data, uint32_t bitPos, uint count) {
+  const uint     shift = bitPos % 8;
+  uint64_t       bits  = 0;
+  uint8_t const *byte  = data + bitPos / 8;
+  for (uint read = 0; read < shift + count; read += 8) {
+    bits |= (uint64_t)*byte++ << read;
+  }
+  return (uint32_t)(bits >> shift) & (uint32_t)(((uint64_t)1 << count) - 1);
+}
+
+// sets and clears the pixels of one column, a page (8 rows) at a time
+void Bitmap::drawColumn(int x, int y, uint32_t bits, uint height) {
+  uint64_t mask  = ((uint64_t)1 << height) - 1;
+  uint64_t value = bits & mask;
+  if (y < 0) {
+    if (-y >= (int)height) {
+      return;
+    }
+    mask >>= -y;
+    value >>= -y;
+    y = 0;
+  } else {
+    mask <<= y % 8;
+    value <<= y % 8;
+  }
+  for (uint page = y / 8; page < _height / 8 && mask != 0; page++) {
+    uint8_t      &target = _buffer[x + page * _width];
+    const uint8_t m      = mask & 0xff;
+    target               = (target & ~m) | (value & m);
+    mask >>= 8;
+    value >>= 8;
+  }
+}
+
 int Bitmap::drawString(int x, int y, String text) {
   int next_x = x;
   for (int i = 0; i < text.length(); i++) {
@@ -265,6 +287,24 @@ int Bitmap::drawString(int x, int y, String text) {
   return next_x;
 }
 
+// as far as drawString() would advance, without drawing
+int Bitmap::getStringWidth(String text) const {
+  fontDesc_t const *font  = getSystemFont();
+  int               width = 0;
+  for (int i = 0; i < text.length(); i++) {
+    unsigned char cu = (unsigned char)text[i];
+    if (cu == ' ') {
+      width += font->widthInPixel * 4 / 10;
+      continue;
+    }
+    if (cu < font->firstChar || cu > font->lastChar) {
+      cu = '?';
+    }
+    width += font->pData[cu - font->firstChar] + FONT_CHAR_SPACING;
+  }
+  return width;
+}
+
 void Bitmap::drawStringf(int x, int y, char *buffer, String format, ...) {
   va_list myargs;
   va_start(myargs, format);
@@ -37,6 +37,7 @@ public:
   int  drawString(int x, int y, String text);
   void drawStringf(int x, int y, char *buffer, String format, ...);
   int  drawStringLF(int x, int y, String text);
+  int  getStringWidth(String text) const;
   void drawStringLFf(int x, int y, char *buffer, String format, ...);
 
   // void drawBitmap(int x, int y, const Bitmap & bitmap);
@@ -48,6 +49,9 @@ private:
   uint8_t *_buffer;
 
   void allocateBuffer();
+  void drawColumn(int x, int y, uint32_t bits, uint height);
+
+  static uint32_t readBits(unsigned char const *data, uint32_t bitPos, uint count);
 
   friend class SSD1306;
 };
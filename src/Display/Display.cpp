@@ -2,7 +2,9 @@
 #include "System/TaskManager.h"
 #include <logger.h>
 
-Display::Display() : _disp(0), _statusFrame(0), _displaySaveMode(false) {
+static MemoryPool textFramePool("TextFrame", sizeof(TextFrame) + MemoryPool::SHARED_OVERHEAD);
+
+Display::Display() : _disp(0), _bitmap(0), _statusFrame(0), _displaySaveMode(false), _dirty(true) {
 }
 
 Display::~Display() {
@@ -18,10 +20,14 @@ void Display::setup(BoardConfig const *const boardConfig) {
     digitalWrite(boardConfig->Oled.Reset, HIGH);
   }
   Wire.begin(boardConfig->Oled.Sda, boardConfig->Oled.Scl);
-  _disp = new SSD1306(&Wire, boardConfig->Oled.Addr);
-
-  Bitmap bitmap(_disp->getWidth(), _disp->getHeight());
-  _disp->display(&bitmap);
+  // the SSD1306 and the AXP192 sharing the bus on some boards both do fast mode
+  Wire.setClock(I2C_CLOCK);
+  SSD1306 *ssd1306 = new SSD1306(&Wire, boardConfig->Oled.Addr);
+  // without the task every transfer stays on the caller, as before
+  ssd1306->startFlushTask();
+  _disp   = ssd1306;
+  _bitmap = new Bitmap(_disp);
+  _disp->display(_bitmap);
 
   _displayFrameRate.setTimeout(500);
   _displayFrameRate.start();
@@ -43,68 +49,183 @@ void Display::setDisplaySaveTimeout(uint32_t timeout) {
 }
 
 void Display::activateDistplay() {
-  _disp->displayOn();
+  if (_disp->isDisplayOff()) {
+    _disp->displayOn();
+    _dirty = true;
+  }
 }
 
 void Display::update() {
-  if (_displayFrameRate.check()) {
+  if (!_displayFrameRate.check()) {
+    return;
+  }
 
-    if (_frames.size() > 0) {
-      std::shared_ptr<DisplayFrame> frame = *_frames.begin();
-      Bitmap                        bitmap(_disp);
-      frame->drawStatusPage(bitmap);
-      _disp->display(&bitmap);
+  if (!_frames.empty() && _frameTimeout.isActive() && _frameTimeout.check()) {
+    _frames.pop();
+    _frameTimeout.reset();
+    _dirty = true;
+  }
+
+  if (!_frames.empty()) {
+    if (!_frameTimeout.isActive()) {
+      _frameTimeout.start();
+      _displaySaveModeTimer.reset();
+      _dirty = true;
+    }
+    if (_dirty) {
+      render(_frames.front(), _frames.getOverflow());
+    }
+  } else if (_disp->isDisplayOn()) {
+    if (_dirty || _statusFrame->hasChanged()) {
+      render(*_statusFrame);
+    }
 
-      if (!_frameTimeout.isActive()) {
-        _frameTimeout.start();
+    if (_displaySaveMode) {
+      if (_displaySaveModeTimer.isActive() && _displaySaveModeTimer.check()) {
+        _disp->displayOff();
         _displaySaveModeTimer.reset();
-      } else if (_frameTimeout.check()) {
-        _frames.pop_front();
-        _frameTimeout.reset();
-      }
-    } else {
-      if (_disp->isDisplayOn()) {
-        Bitmap bitmap(_disp);
-        _statusFrame->drawStatusPage(bitmap);
-        _disp->display(&bitmap);
-
-        if (_displaySaveMode) {
-          if (_displaySaveModeTimer.isActive() && _displaySaveModeTimer.check()) {
-            _disp->displayOff();
-            _displaySaveModeTimer.reset();
-          } else if (!_displaySaveModeTimer.isActive()) {
-            _displaySaveModeTimer.start();
-          }
-        }
+      } else if (!_displaySaveModeTimer.isActive()) {
+        _displaySaveModeTimer.start();
       }
     }
-
-    _displayFrameRate.start();
   }
 }
 
+// the shown frame may have been replaced or the overflow count grew
 void Display::addFrame(std::shared_ptr<DisplayFrame> frame) {
-  _frames.push_back(frame);
+  _frames.push(frame);
+  _dirty = true;
+}
+
+void Display::setFrameLimit(size_t limit) {
+  _frames.setLimit(limit);
+}
+
+void Display::markDirty() {
+  _dirty = true;
+}
+
+// a change to draw or a timer that expired, regardless of the frame rate
+bool Display::wantsUpdate() const {
+  if (!_frames.empty()) {
+    return _dirty || !_frameTimeout.isActive() || _frameTimeout.check();
+  }
+  if (!_disp->isDisplayOn()) {
+    return false;
+  }
+  if (_dirty || _statusFrame->hasChanged()) {
+    return true;
+  }
+  return _displaySaveMode && (!_displaySaveModeTimer.isActive() || _displaySaveModeTimer.check());
+}
+
+bool Display::hasPendingUpdate() const {
+  return _disp != 0 && _displayFrameRate.check() && wantsUpdate();
+}
+
+// millis() when update() has something to do next, 0 if that depends on a change
+uint32_t Display::getNextUpdate() const {
+  if (_disp == 0) {
+    return 0;
+  }
+  // Timer::check() only passes once the trigger time is over
+  if (wantsUpdate()) {
+    return _displayFrameRate.getTriggerTime() + 1;
+  }
+  if (!_frames.empty() && _frameTimeout.isActive()) {
+    return _frameTimeout.getTriggerTime() + 1;
+  }
+  if (_frames.empty() && _disp->isDisplayOn() && _displaySaveMode && _displaySaveModeTimer.isActive()) {
+    return _displaySaveModeTimer.getTriggerTime() + 1;
+  }
+  return 0;
+}
+
+// the frame rate only limits how often a change is drawn
+void Display::render(DisplayFrame &frame, uint32_t more) {
+  const uint32_t start = micros();
+  _bitmap->clear();
+  frame.drawStatusPage(*_bitmap);
+  if (more > 0) {
+    // frames dropped from the queue, top right next to the header
+    char summary[16];
+    snprintf(summary, sizeof(summary), "+%u more", more);
+    _bitmap->drawString(_bitmap->getWidth() - _bitmap->getStringWidth(summary), 0, summary);
+  }
+  _renderTime.add(micros() - start);
+  _disp->display(_bitmap);
+  _dirty = false;
+  _displayFrameRate.start();
+}
+
+const Histogram &Display::getRenderTime() const {
+  return _renderTime;
+}
+
+uint32_t Display::getBytesSent() const {
+  return _disp->getBytesSent();
+}
+
+uint32_t Display::getFramesSent() const {
+  return _disp->getFramesSent();
+}
+
+uint32_t Display::getFramesUnchanged() const {
+  return _disp->getFramesUnchanged();
+}
+
+uint32_t Display::getFramesReplaced() const {
+  return _frames.getReplaced();
+}
+
+uint32_t Display::getFramesDropped() const {
+  return _frames.getDropped();
 }
 
 void Display::setStatusFrame(std::shared_ptr<StatusFrame> frame) {
   _statusFrame = frame;
+  _dirty       = true;
 }
 
 void Display::showSpashScreen(String firmwareTitle, String version) {
-  Bitmap bitmap(_disp);
-  bitmap.drawString(0, 10, firmwareTitle);
-  bitmap.drawString(0, 20, version);
-  bitmap.drawString(0, 35, "by Peter Buchegger");
-  bitmap.drawString(30, 45, "OE5BPA");
-  _disp->display(&bitmap);
+  _bitmap->clear();
+  _bitmap->drawString(0, 10, firmwareTitle);
+  _bitmap->drawString(0, 20, version);
+  _bitmap->drawString(0, 35, "by Peter Buchegger");
+  _bitmap->drawString(30, 45, "OE5BPA");
+  _disp->display(_bitmap);
+  _dirty = true;
 }
 
 void Display::showStatusScreen(String header, String text) {
-  Bitmap bitmap(_disp);
-  bitmap.drawString(0, 0, header);
-  bitmap.drawStringLF(0, 10, text);
-  _disp->display(&bitmap);
+  _bitmap->clear();
+  _bitmap->drawString(0, 0, header);
+  _bitmap->drawStringLF(0, 10, text);
+  _disp->display(_bitmap);
+  _dirty = true;
+}
+
+TextFrame::TextFrame(const char *header, const char *text) {
+  strlcpy(_header, header, sizeof(_header));
+  strlcpy(_text, text, sizeof(_text));
+  // packets start with the callsign of the source, anything else is never replaced
+  const char *end = strchr(_text, '>');
+  _source[0]      = 0;
+  if (end != 0 && end > _text && end - _text < (int)CALLSIGN_LENGTH) {
+    snprintf(_source, sizeof(_source), "%s:%.*s", _header, (int)(end - _text), _text);
+  }
+}
+
+std::shared_ptr<TextFrame> TextFrame::create(const char *header, const char *text) {
+  return std::allocate_shared<TextFrame>(PoolAllocator<TextFrame>(textFramePool), header, text);
+}
+
+MemoryPool &TextFrame::getPool() {
+  return textFramePool;
+}
+
+const char *TextFrame::getSource() const {
+  return _source[0] != 0 ? _source : 0;
 }
 
 void TextFrame::drawStatusPage(Bitmap &bitmap) {
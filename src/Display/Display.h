@@ -2,26 +2,20 @@
 #define DISPLAY_H_
 
 #include "BoardFinder/BoardFinder.h"
+#include "Display/DisplayFrame.h"
+#include "Display/FrameQueue.h"
 #include "Display/SSD1306.h"
+#include "System/Histogram.h"
+#include "System/MemoryPool.h"
 #include "System/Timer.h"
 #include <Arduino.h>
 #include <Wire.h>
-#include <list>
 #include <map>
 #include <memory>
 
 class Timer;
 class StatusFrame;
 
-class DisplayFrame {
-public:
-  DisplayFrame() {
-  }
-  virtual ~DisplayFrame() {
-  }
-  virtual void drawStatusPage(Bitmap &bitmap) = 0;
-};
-
 class Display {
 public:
   Display();
@@ -39,34 +33,67 @@ public:
 
   void activateDistplay();
 
-  // functions for update loop
-  void update();
-  void addFrame(std::shared_ptr<DisplayFrame> frame);
+  // functions for update loop, the display is only drawn when something changed
+  void     update();
+  void     addFrame(std::shared_ptr<DisplayFrame> frame);
+  // how many frames may wait, more than the frame pool holds would go to the heap
+  void     setFrameLimit(size_t limit);
+  void     markDirty();
+  bool     hasPendingUpdate() const;
+  uint32_t getNextUpdate() const;
+
+  const Histogram &getRenderTime() const;
+  uint32_t         getBytesSent() const;
+  uint32_t         getFramesSent() const;
+  uint32_t         getFramesUnchanged() const;
+  uint32_t         getFramesReplaced() const;
+  uint32_t         getFramesDropped() const;
 
 private:
+  static const uint32_t I2C_CLOCK = 400000;
+
   OLEDDisplay *_disp;
+  // drawn into on every update, the display only gets what changed
+  Bitmap      *_bitmap;
+  Histogram    _renderTime;
 
   Timer                        _displayFrameRate;
   std::shared_ptr<StatusFrame> _statusFrame;
 
-  std::list<std::shared_ptr<DisplayFrame>> _frames;
-  Timer                                    _frameTimeout;
+  FrameQueue _frames;
+  Timer      _frameTimeout;
 
   bool  _displaySaveMode;
   Timer _displaySaveModeTimer;
+
+  bool _dirty;
+
+  bool wantsUpdate() const;
+  void render(DisplayFrame &frame, uint32_t more = 0);
 };
 
 class TextFrame : public DisplayFrame {
 public:
-  TextFrame(String header, String text) : _header(header), _text(text) {
-  }
+  static const size_t HEADER_LENGTH = 16;
+  static const size_t TEXT_LENGTH   = 256;
+  // with SSID, as in OE5BPA-10
+  static const size_t CALLSIGN_LENGTH = 10;
+
+  TextFrame(const char *header, const char *text);
   virtual ~TextFrame() {
   }
-  void drawStatusPage(Bitmap &bitmap) override;
+  void        drawStatusPage(Bitmap &bitmap) override;
+  // header and callsign, a new packet of a station replaces the old one
+  const char *getSource() const override;
+
+  // frames are taken from a pool, text is truncated to the fixed buffers
+  static std::shared_ptr<TextFrame> create(const char *header, const char *text);
+  static MemoryPool                &getPool();
 
 private:
-  String _header;
-  String _text;
+  char _header[HEADER_LENGTH];
+  char _text[TEXT_LENGTH];
+  char _source[HEADER_LENGTH + CALLSIGN_LENGTH];
 };
 
 #endif
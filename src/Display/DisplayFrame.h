@@ -0,0 +1,23 @@
+#ifndef DISPLAY_FRAME_H_
+#define DISPLAY_FRAME_H_
+
+class Bitmap;
+
+class DisplayFrame {
+public:
+  DisplayFrame() {
+  }
+  virtual ~DisplayFrame() {
+  }
+  virtual void drawStatusPage(Bitmap &bitmap) = 0;
+  // true if drawing again would give another picture
+  virtual bool hasChanged() const {
+    return false;
+  }
+  // a newer frame with the same source replaces a queued one, 0 if it never should
+  virtual const char *getSource() const {
+    return 0;
+  }
+};
+
+#endif
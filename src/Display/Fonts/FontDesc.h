@@ -2,6 +2,7 @@
 #define FONT_DESC_H
 
 #include <inttypes.h>
+#include <stddef.h>
 
 struct fontDesc_t {
   uint16_t totalSize;
@@ -12,6 +13,23 @@ struct fontDesc_t {
   uint8_t  lastChar;
 
   unsigned char const *const pData;
+  // first column of every glyph in the bit field, counted in columns of heightInPixel bits
+  uint16_t const *const pOffsets;
 };
 
+template <size_t N> struct GlyphOffsets {
+  uint16_t offsets[N];
+};
+
+// sums up the glyph widths at compile time, drawChar does not have to per character
+template <size_t N> constexpr GlyphOffsets<N> makeGlyphOffsets(unsigned char const *widths) {
+  GlyphOffsets<N> table{};
+  uint16_t        column = 0;
+  for (size_t i = 0; i < N; i++) {
+    table.offsets[i] = column;
+    column += widths[i];
+  }
+  return table;
+}
+
 #endif
@@ -0,0 +1,93 @@
+#include <string.h>
+
+#include "FrameQueue.h"
+
+FrameQueue::FrameQueue() : _head(0), _count(0), _limit(MAX_FRAMES), _overflow(0), _replaced(0), _dropped(0) {
+}
+
+void FrameQueue::setLimit(size_t limit) {
+  _limit = limit < 1 ? 1 : limit > MAX_FRAMES ? MAX_FRAMES : limit;
+  while (_count > _limit) {
+    remove(_count > 1 ? 1 : 0);
+    _overflow++;
+    _dropped++;
+  }
+}
+
+size_t FrameQueue::getLimit() const {
+  return _limit;
+}
+
+void FrameQueue::push(std::shared_ptr<DisplayFrame> frame) {
+  const char *source = frame->getSource();
+  if (source != 0) {
+    for (size_t i = 0; i < _count; i++) {
+      const char *queued = at(i)->getSource();
+      if (queued != 0 && strcmp(queued, source) == 0) {
+        at(i) = frame;
+        _replaced++;
+        return;
+      }
+    }
+  }
+  if (_count == _limit) {
+    // the shown frame keeps its time on the display, unless it is the only one
+    remove(_count > 1 ? 1 : 0);
+    _overflow++;
+    _dropped++;
+  }
+  at(_count) = frame;
+  _count++;
+}
+
+void FrameQueue::pop() {
+  if (_count == 0) {
+    return;
+  }
+  remove(0);
+  if (_count == 0) {
+    _overflow = 0;
+  }
+}
+
+bool FrameQueue::empty() const {
+  return _count == 0;
+}
+
+size_t FrameQueue::size() const {
+  return _count;
+}
+
+DisplayFrame &FrameQueue::front() const {
+  return *_frames[_head];
+}
+
+uint32_t FrameQueue::getOverflow() const {
+  return _overflow;
+}
+
+uint32_t FrameQueue::getReplaced() const {
+  return _replaced;
+}
+
+uint32_t FrameQueue::getDropped() const {
+  return _dropped;
+}
+
+std::shared_ptr<DisplayFrame> &FrameQueue::at(size_t index) {
+  return _frames[(_head + index) % MAX_FRAMES];
+}
+
+// the frame goes back to its pool right away, the ones behind move up
+void FrameQueue::remove(size_t index) {
+  if (index == 0) {
+    _frames[_head].reset();
+    _head = (_head + 1) % MAX_FRAMES;
+  } else {
+    for (size_t i = index; i + 1 < _count; i++) {
+      at(i) = std::move(at(i + 1));
+    }
+    at(_count - 1).reset();
+  }
+  _count--;
+}
@@ -0,0 +1,51 @@
+#ifndef FRAME_QUEUE_H_
+#define FRAME_QUEUE_H_
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Display/DisplayFrame.h"
+
+// Frames waiting for the display, in a ring of fixed size. The front frame
+// is the one shown. A new frame replaces a queued one of the same source,
+// so a busy station only keeps its latest packet on the list. If the queue
+// is full, the oldest frame still waiting is dropped and counted as
+// overflow, which the display summarises until the queue runs empty again.
+// However many packets arrive, at most the limit of frames is held.
+class FrameQueue {
+public:
+  static const size_t MAX_FRAMES = 8;
+
+  FrameQueue();
+
+  // clamped to 1..MAX_FRAMES, frames over the new limit are dropped
+  void   setLimit(size_t limit);
+  size_t getLimit() const;
+
+  void          push(std::shared_ptr<DisplayFrame> frame);
+  void          pop();
+  bool          empty() const;
+  size_t        size() const;
+  DisplayFrame &front() const;
+
+  // frames dropped since the queue was empty the last time
+  uint32_t getOverflow() const;
+  uint32_t getReplaced() const;
+  uint32_t getDropped() const;
+
+private:
+  std::shared_ptr<DisplayFrame> _frames[MAX_FRAMES];
+  size_t                        _head;
+  size_t                        _count;
+  size_t                        _limit;
+
+  uint32_t _overflow;
+  uint32_t _replaced;
+  uint32_t _dropped;
+
+  std::shared_ptr<DisplayFrame> &at(size_t index);
+  void                           remove(size_t index);
+};
+
+#endif
@@ -31,7 +31,7 @@
 
 #include "OLEDDisplay.h"
 
-OLEDDisplay::OLEDDisplay(OLEDDISPLAY_GEOMETRY g) : _geometry(g), _displayIsOn(false) {
+OLEDDisplay::OLEDDisplay(OLEDDISPLAY_GEOMETRY g) : _bytesSent(0), _framesSent(0), _framesUnchanged(0), _geometry(g), _displayIsOn(false) {
 }
 
 OLEDDisplay::~OLEDDisplay() {
@@ -90,19 +90,23 @@ void OLEDDisplay::setBrightness(uint8_t brightness) {
   setContrast(contrast, precharge, comdetect);
 }
 
+// the segment remap only applies to data written afterwards, so the whole frame is sent again
 void OLEDDisplay::resetOrientation() {
   sendCommand(SEGREMAP);
   sendCommand(COMSCANINC);
+  invalidate();
 }
 
 void OLEDDisplay::flipScreenVertically() {
   sendCommand(SEGREMAP | 0x01);
   sendCommand(COMSCANDEC);
+  invalidate();
 }
 
 void OLEDDisplay::mirrorScreen() {
   sendCommand(SEGREMAP);
   sendCommand(COMSCANDEC);
+  invalidate();
 }
 
 void OLEDDisplay::display(Bitmap *bitmap) {
@@ -140,6 +144,18 @@ uint OLEDDisplay::getHeight() {
   return 0;
 }
 
+uint32_t OLEDDisplay::getBytesSent() const {
+  return _bytesSent;
+}
+
+uint32_t OLEDDisplay::getFramesSent() const {
+  return _framesSent;
+}
+
+uint32_t OLEDDisplay::getFramesUnchanged() const {
+  return _framesUnchanged;
+}
+
 void OLEDDisplay::sendInitCommands() {
   sendCommand(DISPLAYOFF);
   sendCommand(SETDISPLAYCLOCKDIV);
@@ -34,6 +34,7 @@
 
 #include "Bitmap.h"
 #include <Arduino.h>
+#include <atomic>
 
 // Display commands
 #define CHARGEPUMP          0x8D
@@ -120,10 +121,24 @@ public:
   uint getWidth();
   uint getHeight();
 
+  // Transfer statistics, bytes are counted as written to the bus
+  uint32_t getBytesSent() const;
+  uint32_t getFramesSent() const;
+  uint32_t getFramesUnchanged() const;
+
 protected:
+  // written by the flush task, read by the display report
+  std::atomic<uint32_t> _bytesSent;
+  std::atomic<uint32_t> _framesSent;
+  std::atomic<uint32_t> _framesUnchanged;
+
   // Send all the init commands
   void sendInitCommands();
 
+  // Forget what the display RAM holds, the next frame is sent in full
+  virtual void invalidate() {
+  }
+
 private:
   OLEDDISPLAY_GEOMETRY _geometry;
 
@@ -1,35 +1,217 @@
+#include <new>
+#include <utility>
+
 #include "SSD1306.h"
 
-SSD1306::SSD1306(TwoWire *wire, uint8_t address, OLEDDISPLAY_GEOMETRY g) : OLEDDisplay(g), _wire(wire), _address(address) {
+#define FLUSH_TASK_STACK_SIZE 2048
+#define FLUSH_TASK_PRIORITY   1
+
+SSD1306::SSD1306(TwoWire *wire, uint8_t address, OLEDDISPLAY_GEOMETRY g) : OLEDDisplay(g), _wire(wire), _address(address), _sent(0), _sentValid(false), _flushTask(0), _frameLock(0), _commands(0), _next(0), _nextReady(false), _nextLast(false), _frame(0) {
   sendInitCommands();
+  _sent = new (std::nothrow) uint8_t[getWidth() * getHeight() / 8];
 }
 
 SSD1306::~SSD1306() {
+  if (_flushTask != 0) {
+    vTaskDelete(_flushTask);
+    vQueueDelete(_commands);
+    vSemaphoreDelete(_frameLock);
+  }
+  delete[] _sent;
+  delete[] _next;
+  delete[] _frame;
+}
+
+// not pinned to a core: the display keeps up even while the loop is busy, and never holds it up
+bool SSD1306::startFlushTask() {
+  if (_flushTask != 0) {
+    return true;
+  }
+  const size_t size = getWidth() * getHeight() / 8;
+  _next             = new (std::nothrow) uint8_t[size];
+  _frame            = new (std::nothrow) uint8_t[size];
+  _frameLock        = xSemaphoreCreateMutex();
+  _commands         = xQueueCreate(COMMAND_QUEUE, sizeof(uint16_t));
+  if (_next == 0 || _frame == 0 || _frameLock == 0 || _commands == 0 || xTaskCreate(flushTask, "DisplayFlush", FLUSH_TASK_STACK_SIZE, this, FLUSH_TASK_PRIORITY, &_flushTask) != pdPASS) {
+    if (_commands != 0) {
+      vQueueDelete(_commands);
+    }
+    if (_frameLock != 0) {
+      vSemaphoreDelete(_frameLock);
+    }
+    delete[] _next;
+    delete[] _frame;
+    _next      = 0;
+    _frame     = 0;
+    _frameLock = 0;
+    _commands  = 0;
+    _flushTask = 0;
+    return false;
+  }
+  return true;
 }
 
 void SSD1306::internDisplay(Bitmap *bitmap) {
-  sendCommand(PAGEADDR);
-  sendCommand(0x0);
-  sendCommand(0xFF);
+  if (_flushTask == 0) {
+    flush(bitmap->_buffer);
+    return;
+  }
+  // the lock is only held for the copy here and the pointer swap in the task, never during a transfer
+  while (true) {
+    xSemaphoreTake(_frameLock, portMAX_DELAY);
+    if (!_nextReady) {
+      if (queue(FRAME_ENTRY)) {
+        break;
+      }
+    } else if (_nextLast) {
+      break;
+    }
+    // a command follows the pending frame, it has to go out first
+    xSemaphoreGive(_frameLock);
+    xTaskNotifyGive(_flushTask);
+    vTaskDelay(1);
+  }
+  memcpy(_next, bitmap->_buffer, getWidth() * getHeight() / 8);
+  _nextReady = true;
+  _nextLast  = true;
+  xSemaphoreGive(_frameLock);
+  xTaskNotifyGive(_flushTask);
+}
+
+// in order with the commands: frames queued before still go against what the display RAM held then
+void SSD1306::invalidate() {
+  if (_flushTask == 0) {
+    _sentValid = false;
+    return;
+  }
+  enqueue(INVALIDATE_ENTRY);
+}
 
-  sendCommand(COLUMNADDR);
-  sendCommand(0x0);
-  sendCommand(getWidth() - 1);
+void SSD1306::sendCommand(uint8_t command) {
+  if (_flushTask == 0) {
+    writeCommand(command);
+    return;
+  }
+  enqueue(command);
+}
 
-  for (int i = 0; i < getWidth() * getHeight() / 8;) {
-    Wire.beginTransmission(_address);
-    Wire.write(0x40);
-    for (uint8_t x = 0; x < 16; x++) {
-      Wire.write(bitmap->_buffer[i]);
-      i++;
+// commands are rare, a full queue means the task is behind: let it catch up instead of losing one
+void SSD1306::enqueue(uint16_t entry) {
+  while (true) {
+    xSemaphoreTake(_frameLock, portMAX_DELAY);
+    const bool queued = queue(entry);
+    if (queued) {
+      _nextLast = false;
+    }
+    xSemaphoreGive(_frameLock);
+    xTaskNotifyGive(_flushTask);
+    if (queued) {
+      return;
     }
-    Wire.endTransmission();
+    vTaskDelay(1);
   }
 }
 
-void SSD1306::sendCommand(uint8_t command) {
+// with _frameLock held, the task needs it to take a frame: never wait for room here
+bool SSD1306::queue(uint16_t entry) {
+  return xQueueSend(_commands, &entry, 0) == pdTRUE;
+}
+
+void SSD1306::flushTask(void *parameter) {
+  SSD1306 *display = static_cast<SSD1306 *>(parameter);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint16_t entry;
+    while (xQueueReceive(display->_commands, &entry, 0) == pdTRUE) {
+      if (entry == INVALIDATE_ENTRY) {
+        display->_sentValid = false;
+        continue;
+      }
+      if (entry != FRAME_ENTRY) {
+        display->writeCommand(entry);
+        continue;
+      }
+      xSemaphoreTake(display->_frameLock, portMAX_DELAY);
+      std::swap(display->_next, display->_frame);
+      display->_nextReady = false;
+      display->_nextLast  = false;
+      xSemaphoreGive(display->_frameLock);
+      display->flush(display->_frame);
+    }
+  }
+}
+
+void SSD1306::flush(const uint8_t *frame) {
+  const uint width = getWidth();
+  const uint pages = getHeight() / 8;
+
+  if (!_sentValid || _sent == 0) {
+    const uint8_t window[] = {PAGEADDR, 0, (uint8_t)(pages - 1), COLUMNADDR, 0, (uint8_t)(width - 1)};
+    writeCommands(window, sizeof(window));
+    writeData(frame, width * pages);
+    if (_sent != 0) {
+      memcpy(_sent, frame, width * pages);
+      _sentValid = true;
+    }
+    _framesSent++;
+    return;
+  }
+
+  bool changed = false;
+  for (uint page = 0; page < pages; page++) {
+    const uint8_t *row  = frame + page * width;
+    uint8_t       *sent = _sent + page * width;
+
+    uint first = 0;
+    while (first < width && row[first] == sent[first]) {
+      first++;
+    }
+    if (first == width) {
+      continue;
+    }
+    uint last = width - 1;
+    while (row[last] == sent[last]) {
+      last--;
+    }
+
+    const uint8_t window[] = {PAGEADDR, (uint8_t)page, (uint8_t)page, COLUMNADDR, (uint8_t)first, (uint8_t)last};
+    writeCommands(window, sizeof(window));
+    writeData(row + first, last - first + 1);
+    memcpy(sent + first, row + first, last - first + 1);
+    changed = true;
+  }
+  if (changed) {
+    _framesSent++;
+  } else {
+    _framesUnchanged++;
+  }
+}
+
+void SSD1306::writeCommand(uint8_t command) {
   _wire->beginTransmission(_address);
   _wire->write(0x80);
   _wire->write(command);
   _wire->endTransmission();
+  _bytesSent += 2;
+}
+
+// control byte 0x00: everything that follows is a command
+void SSD1306::writeCommands(const uint8_t *commands, size_t count) {
+  _wire->beginTransmission(_address);
+  _wire->write(0x00);
+  _wire->write(commands, count);
+  _wire->endTransmission();
+  _bytesSent += 1 + count;
+}
+
+void SSD1306::writeData(const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i += DATA_CHUNK) {
+    const size_t chunk = length - i < DATA_CHUNK ? length - i : DATA_CHUNK;
+    _wire->beginTransmission(_address);
+    _wire->write(0x40);
+    _wire->write(data + i, chunk);
+    _wire->endTransmission();
+    _bytesSent += 1 + chunk;
+  }
 }
@@ -34,19 +34,59 @@
 #include "OLEDDisplay.h"
 #include <Wire.h>
 
+// Keeps a copy of what was last written to the display RAM. Per page only
+// the column range that differs is sent, an unchanged frame sends nothing.
+//
+// Once startFlushTask() succeeded all I2C transfers run in a task of their
+// own: display() copies the frame and returns. Commands and frames go
+// through one queue, so they reach the display in the order they were
+// issued. A frame that is replaced before the task got to it is never
+// sent, unless a command was queued after it.
 class SSD1306 : public OLEDDisplay {
 public:
   SSD1306(TwoWire *wire, uint8_t address, OLEDDISPLAY_GEOMETRY g = GEOMETRY_128_64);
   virtual ~SSD1306();
 
+  bool startFlushTask();
+
   virtual void internDisplay(Bitmap *bitmap) override;
 
+protected:
+  virtual void invalidate() override;
+
 private:
+  // data bytes per I2C transaction, the control byte comes on top
+  static const uint DATA_CHUNK    = 16;
+  static const uint COMMAND_QUEUE = 32;
+  // queue entries besides the command bytes: the pending frame, and forgetting what the display RAM holds
+  static const uint16_t FRAME_ENTRY      = 0x100;
+  static const uint16_t INVALIDATE_ENTRY = 0x101;
+
   TwoWire *_wire = NULL;
   uint8_t  _address;
   bool     _doI2cAutoInit = false;
 
+  // owned by whoever does the transfers, the flush task once it runs
+  uint8_t *_sent;
+  bool     _sentValid;
+
+  TaskHandle_t      _flushTask;
+  SemaphoreHandle_t _frameLock;
+  QueueHandle_t     _commands;
+  uint8_t          *_next; // guarded by _frameLock
+  bool              _nextReady;
+  bool              _nextLast; // nothing was queued after the pending frame, it may still be replaced
+  uint8_t          *_frame;
+
   virtual void sendCommand(uint8_t command) override;
+  void         writeCommand(uint8_t command);
+  void         writeCommands(const uint8_t *commands, size_t count);
+  void         writeData(const uint8_t *data, size_t length);
+  void         flush(const uint8_t *frame);
+  bool         queue(uint16_t entry);
+  void         enqueue(uint16_t entry);
+
+  static void flushTask(void *parameter);
 };
 
 #endif
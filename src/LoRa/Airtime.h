@@ -0,0 +1,62 @@
+#ifndef LORA_AIRTIME_H_
+#define LORA_AIRTIME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// LoRa modem settings that decide the time on air of a packet.
+class LoRaModulation {
+public:
+  constexpr LoRaModulation(uint8_t spreadingFactor = 12, uint32_t bandwidth = 125000, uint8_t codingRate4 = 5, uint16_t preambleLength = 8, bool crc = true, bool explicitHeader = true) : spreadingFactor(spreadingFactor), bandwidth(bandwidth), codingRate4(codingRate4), preambleLength(preambleLength), crc(crc), explicitHeader(explicitHeader) {
+  }
+
+  uint8_t  spreadingFactor;
+  uint32_t bandwidth;   // Hz
+  uint8_t  codingRate4; // 5..8 for 4/5..4/8
+  uint16_t preambleLength;
+  bool     crc;
+  bool     explicitHeader;
+};
+
+// Time on air as given in the Semtech SX1276 datasheet (section 4.1.1.7).
+// Everything is constexpr, settings known at compile time cost nothing at
+// run time. Low data rate optimization is on for symbols longer than 16 ms,
+// as RadioLib configures the modem.
+class LoRaAirtime {
+public:
+  static constexpr uint32_t symbolMicros(const LoRaModulation &modulation) {
+    return (uint32_t)(((uint64_t)1000000 << modulation.spreadingFactor) / modulation.bandwidth);
+  }
+
+  static constexpr bool lowDataRate(const LoRaModulation &modulation) {
+    return symbolMicros(modulation) > 16000;
+  }
+
+  // preamble plus the 4.25 symbols of sync word
+  static constexpr uint32_t preambleMicros(const LoRaModulation &modulation) {
+    return (uint32_t)(((uint64_t)modulation.preambleLength * 4 + 17) * symbolMicros(modulation) / 4);
+  }
+
+  static constexpr uint32_t payloadSymbols(const LoRaModulation &modulation, size_t length) {
+    const int32_t numerator   = 8 * (int32_t)length - 4 * modulation.spreadingFactor + 28 + (modulation.crc ? 16 : 0) - (modulation.explicitHeader ? 0 : 20);
+    const int32_t denominator = 4 * (modulation.spreadingFactor - (lowDataRate(modulation) ? 2 : 0));
+    const int32_t blocks      = numerator > 0 ? (numerator + denominator - 1) / denominator : 0;
+    return 8 + blocks * modulation.codingRate4;
+  }
+
+  static constexpr uint32_t packetMicros(const LoRaModulation &modulation, size_t length) {
+    return preambleMicros(modulation) + payloadSymbols(modulation, length) * symbolMicros(modulation);
+  }
+
+  // rounded up, budgets must not be underestimated
+  static constexpr uint32_t packetMillis(const LoRaModulation &modulation, size_t length) {
+    return (packetMicros(modulation, length) + 999) / 1000;
+  }
+};
+
+// the usual LoRa APRS settings, checked against the datasheet calculator
+static_assert(LoRaAirtime::packetMicros(LoRaModulation(12, 125000, 5, 8), 20) == 1318912, "SF12 airtime");
+static_assert(LoRaAirtime::packetMicros(LoRaModulation(7, 125000, 5, 8), 20) == 56576, "SF7 airtime");
+static_assert(LoRaAirtime::packetMillis(LoRaModulation(12, 125000, 5, 8), 50) == 2302, "SF12 airtime");
+
+#endif
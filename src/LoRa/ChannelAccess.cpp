@@ -0,0 +1,101 @@
+#include "ChannelAccess.h"
+
+ChannelAccess::ChannelAccess() : _persistence(100), _slotMs(0), _maxWaitMs(DEFAULT_MAX_WAIT), _random(1) {
+  reset();
+}
+
+void ChannelAccess::setPersistence(uint8_t percent) {
+  _persistence = percent > 100 ? 100 : percent;
+}
+
+uint8_t ChannelAccess::getPersistence() const {
+  return _persistence;
+}
+
+void ChannelAccess::setSlotTime(uint32_t slotMs) {
+  _slotMs = slotMs;
+}
+
+uint32_t ChannelAccess::getSlotTime() const {
+  return _slotMs;
+}
+
+void ChannelAccess::setMaxWait(uint32_t maxWaitMs) {
+  _maxWaitMs = maxWaitMs;
+}
+
+void ChannelAccess::setRandomSeed(uint32_t seed) {
+  // xorshift must not start at 0
+  _random = seed != 0 ? seed : 1;
+}
+
+void ChannelAccess::start(uint32_t now) {
+  _started   = true;
+  _start     = now;
+  _notBefore = now;
+  _busy      = 0;
+  _deferred  = 0;
+  _forced    = false;
+}
+
+void ChannelAccess::reset() {
+  _started   = false;
+  _start     = 0;
+  _notBefore = 0;
+  _busy      = 0;
+  _deferred  = 0;
+  _forced    = false;
+}
+
+bool ChannelAccess::isStarted() const {
+  return _started;
+}
+
+bool ChannelAccess::scanned(bool busy, uint32_t now) {
+  if (busy) {
+    _busy++;
+  }
+  if (_maxWaitMs != 0 && now - _start >= _maxWaitMs) {
+    _forced = busy;
+    return true;
+  }
+
+  if (busy) {
+    const uint8_t exponent = _busy < MAX_BACKOFF_EXPONENT ? _busy : MAX_BACKOFF_EXPONENT;
+    _notBefore             = now + (1 + nextRandom() % (1u << exponent)) * _slotMs;
+    return false;
+  }
+  if (nextRandom() % 100 < _persistence) {
+    return true;
+  }
+  _deferred++;
+  _notBefore = now + _slotMs;
+  return false;
+}
+
+uint32_t ChannelAccess::getNotBefore() const {
+  return _notBefore;
+}
+
+uint32_t ChannelAccess::getWait(uint32_t now) const {
+  return _started ? now - _start : 0;
+}
+
+uint16_t ChannelAccess::getBusy() const {
+  return _busy;
+}
+
+uint16_t ChannelAccess::getDeferred() const {
+  return _deferred;
+}
+
+bool ChannelAccess::isForced() const {
+  return _forced;
+}
+
+uint32_t ChannelAccess::nextRandom() {
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return _random;
+}
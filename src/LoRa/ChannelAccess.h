@@ -0,0 +1,63 @@
+#ifndef LORA_CHANNEL_ACCESS_H_
+#define LORA_CHANNEL_ACCESS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// p-persistent slotted CSMA on top of channel activity detection (CAD).
+//
+// Before a packet goes out the channel is scanned. If it is free the packet
+// is sent with the configured persistence, otherwise the next scan happens
+// one slot later. If the scan sees a preamble the station backs off for a
+// random number of slots, the window doubling with every busy scan up to
+// 2^MAX_BACKOFF_EXPONENT slots. After the max wait the packet is sent no
+// matter what, so a noisy channel can not block the transmitter forever.
+class ChannelAccess {
+public:
+  static const uint8_t  MAX_BACKOFF_EXPONENT = 4;
+  static const uint32_t DEFAULT_MAX_WAIT     = 10 * 1000;
+
+  ChannelAccess();
+
+  // chance in percent to send on a free channel, 100 sends right away
+  void     setPersistence(uint8_t percent);
+  uint8_t  getPersistence() const;
+  void     setSlotTime(uint32_t slotMs);
+  uint32_t getSlotTime() const;
+  // 0 to wait as long as it takes
+  void     setMaxWait(uint32_t maxWaitMs);
+  void     setRandomSeed(uint32_t seed);
+
+  // a packet wants the channel
+  void start(uint32_t now);
+  // the packet is gone (or dropped)
+  void reset();
+  bool isStarted() const;
+
+  // result of a scan, true if the packet may go now, otherwise scan again at getNotBefore()
+  bool     scanned(bool busy, uint32_t now);
+  uint32_t getNotBefore() const;
+
+  // statistics of the current packet
+  uint32_t getWait(uint32_t now) const;
+  uint16_t getBusy() const;
+  uint16_t getDeferred() const;
+  bool     isForced() const;
+
+private:
+  uint8_t  _persistence;
+  uint32_t _slotMs;
+  uint32_t _maxWaitMs;
+  uint32_t _random;
+
+  bool     _started;
+  uint32_t _start;
+  uint32_t _notBefore;
+  uint16_t _busy;
+  uint16_t _deferred;
+  bool     _forced;
+
+  uint32_t nextRandom();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "DutyCycle.h"
+
+DutyCycle::DutyCycle(uint16_t permille, uint32_t windowMs) {
+  setLimit(permille, windowMs, 0);
+}
+
+void DutyCycle::setLimit(uint16_t permille, uint32_t windowMs, uint32_t now) {
+  _permille   = permille;
+  _windowMs   = windowMs;
+  _sliceMs    = windowMs / BUCKETS > 0 ? windowMs / BUCKETS : 1;
+  _sliceStart = now;
+  _current    = 0;
+  memset(_buckets, 0, sizeof(_buckets));
+}
+
+uint16_t DutyCycle::getLimit() const {
+  return _permille;
+}
+
+uint32_t DutyCycle::getWindow() const {
+  return _windowMs;
+}
+
+uint32_t DutyCycle::getBudget() const {
+  return (uint64_t)_windowMs * _permille / 1000;
+}
+
+uint32_t DutyCycle::getDelay(uint32_t airtimeMs, uint32_t now) {
+  if (_permille == 0) {
+    return 0;
+  }
+  const uint32_t budget = getBudget();
+  if (airtimeMs > budget) {
+    return NEVER;
+  }
+  uint32_t used = getUsed(now);
+  if (used + airtimeMs <= budget) {
+    return 0;
+  }
+  // oldest slice first, each one leaves the window at the end of a slice
+  for (size_t i = 1; i <= BUCKETS; i++) {
+    used -= _buckets[(_current + i) % BUCKETS];
+    if (used + airtimeMs <= budget) {
+      return _sliceStart + i * _sliceMs - now;
+    }
+  }
+  return NEVER;
+}
+
+void DutyCycle::record(uint32_t airtimeMs, uint32_t now) {
+  advance(now);
+  _buckets[_current] += airtimeMs;
+}
+
+uint32_t DutyCycle::getUsed(uint32_t now) {
+  advance(now);
+  uint32_t used = 0;
+  for (size_t i = 0; i < BUCKETS; i++) {
+    used += _buckets[i];
+  }
+  return used;
+}
+
+uint16_t DutyCycle::getUtilisation(uint32_t now) {
+  return (uint64_t)getUsed(now) * 1000 / _windowMs;
+}
+
+void DutyCycle::advance(uint32_t now) {
+  for (size_t i = 0; i < BUCKETS && now - _sliceStart >= _sliceMs; i++) {
+    _current           = (_current + 1) % BUCKETS;
+    _buckets[_current] = 0;
+    _sliceStart += _sliceMs;
+  }
+  // idle for longer than the window, everything is cleared already
+  if (now - _sliceStart >= _sliceMs) {
+    _sliceStart = now - (now - _sliceStart) % _sliceMs;
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef LORA_DUTY_CYCLE_H_
+#define LORA_DUTY_CYCLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sliding window duty cycle limit, e.g. the 10% or 1% per hour of the EU
+// sub-bands. The window is split into BUCKETS slices; airtime is booked in
+// the slice the transmission starts in and leaves the window together with
+// that slice. The limit is therefore kept over any window, at the price of
+// freeing airtime up to one slice later than strictly needed.
+class DutyCycle {
+public:
+  static const size_t   BUCKETS = 60;
+  static const uint32_t NEVER   = UINT32_MAX;
+
+  // permille of the window, 0 for no limit
+  explicit DutyCycle(uint16_t permille = 0, uint32_t windowMs = 60 * 60 * 1000);
+
+  void     setLimit(uint16_t permille, uint32_t windowMs, uint32_t now);
+  uint16_t getLimit() const;
+  uint32_t getWindow() const;
+  // airtime allowed per window
+  uint32_t getBudget() const;
+
+  // ms until a transmission of airtimeMs may start: 0 for right now, NEVER if it is longer than the whole budget
+  uint32_t getDelay(uint32_t airtimeMs, uint32_t now);
+  void     record(uint32_t airtimeMs, uint32_t now);
+
+  uint32_t getUsed(uint32_t now);
+  // permille of the window spent on the air
+  uint16_t getUtilisation(uint32_t now);
+
+private:
+  uint16_t _permille;
+  uint32_t _windowMs;
+  uint32_t _sliceMs;
+  uint32_t _sliceStart;
+  size_t   _current;
+  uint32_t _buckets[BUCKETS];
+
+  void advance(uint32_t now);
+};
+
+#endif
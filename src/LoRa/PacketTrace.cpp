@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "PacketTrace.h"
+
+static const uint8_t LORA_APRS_HEADER[AprsPacket::HEADER_LENGTH] = {'<', 0xff, 0x01};
+
+// next whitespace separated token of the line, false at the end of it
+static bool nextToken(const char *&pos, const char *end, const char *&token, size_t &length) {
+  while (pos < end && (*pos == ' ' || *pos == '\t')) {
+    pos++;
+  }
+  token = pos;
+  while (pos < end && *pos != ' ' && *pos != '\t') {
+    pos++;
+  }
+  length = pos - token;
+  return length > 0;
+}
+
+static bool parseNumber(const char *token, size_t length, float &value) {
+  char number[16];
+  if (length >= sizeof(number)) {
+    return false;
+  }
+  memcpy(number, token, length);
+  number[length] = 0;
+  char *end;
+  value = strtof(number, &end);
+  return end == number + length;
+}
+
+PacketTrace::PacketTrace() : _text(0), _length(0), _position(0), _lineNumber(0), _errors(0), _available(false) {
+}
+
+void PacketTrace::begin(const char *text, size_t length) {
+  _text   = text;
+  _length = length;
+  rewind();
+}
+
+void PacketTrace::rewind() {
+  _position   = 0;
+  _lineNumber = 0;
+  _errors     = 0;
+  _next.time  = 0;
+  advance();
+}
+
+bool PacketTrace::available() const {
+  return _available;
+}
+
+uint32_t PacketTrace::getNextTime() const {
+  return _next.time;
+}
+
+size_t PacketTrace::getNextLength() const {
+  return AprsPacket::HEADER_LENGTH + _next.length;
+}
+
+size_t PacketTrace::read(uint8_t *data, size_t size, RxMetadata &rx) {
+  if (!_available) {
+    return 0;
+  }
+  const size_t length = getNextLength();
+  if (length > size) {
+    skip();
+    return 0;
+  }
+  memcpy(data, LORA_APRS_HEADER, AprsPacket::HEADER_LENGTH);
+  memcpy(data + AprsPacket::HEADER_LENGTH, _next.line, _next.length);
+  rx = _next.rx;
+  advance();
+  return length;
+}
+
+void PacketTrace::skip() {
+  if (_available) {
+    advance();
+  }
+}
+
+uint32_t PacketTrace::getLineNumber() const {
+  return _lineNumber;
+}
+
+uint32_t PacketTrace::getErrors() const {
+  return _errors;
+}
+
+void PacketTrace::advance() {
+  const uint32_t last = _next.time;
+  _available          = false;
+  while (_position < _length) {
+    const char *line = _text + _position;
+    const char *end  = (const char *)memchr(line, '\n', _length - _position);
+    size_t      length;
+    if (end) {
+      length = end - line;
+      _position += length + 1;
+    } else {
+      length    = _length - _position;
+      _position = _length;
+    }
+    _lineNumber++;
+    if (length > 0 && line[length - 1] == '\r') {
+      length--;
+    }
+    if (length == 0 || line[0] == '#') {
+      continue;
+    }
+    Record record;
+    if (!parse(line, length, record) || record.time < last) {
+      _errors++;
+      continue;
+    }
+    _next      = record;
+    _available = true;
+    return;
+  }
+}
+
+bool PacketTrace::parse(const char *line, size_t length, Record &record) const {
+  const char *pos = line;
+  const char *end = line + length;
+  const char *token;
+  size_t      tokenLength;
+  float       time;
+
+  if (!nextToken(pos, end, token, tokenLength) || !parseNumber(token, tokenLength, time) || time < 0) {
+    return false;
+  }
+  if (!nextToken(pos, end, token, tokenLength) || !parseNumber(token, tokenLength, record.rx.rssi)) {
+    return false;
+  }
+  if (!nextToken(pos, end, token, tokenLength) || !parseNumber(token, tokenLength, record.rx.snr)) {
+    return false;
+  }
+  if (!nextToken(pos, end, token, tokenLength)) {
+    return false;
+  }
+  if (tokenLength == 2 && memcmp(token, "ok", 2) == 0) {
+    record.rx.status = RxOkay;
+  } else if (tokenLength == 3 && memcmp(token, "crc", 3) == 0) {
+    record.rx.status = RxCrcError;
+  } else if (tokenLength == 6 && memcmp(token, "header", 6) == 0) {
+    record.rx.status = RxHeaderError;
+  } else {
+    return false;
+  }
+
+  // the rest of the line is the packet, spaces included
+  while (pos < end && (*pos == ' ' || *pos == '\t')) {
+    pos++;
+  }
+  if (pos == end || (size_t)(end - pos) > AprsPacket::MAX_LENGTH) {
+    return false;
+  }
+  record.time              = (uint32_t)time;
+  record.rx.frequencyError = 0;
+  record.rx.timestamp      = record.time * 1000;
+  record.line              = pos;
+  record.length            = end - pos;
+  return true;
+}
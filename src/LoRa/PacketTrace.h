@@ -0,0 +1,59 @@
+#ifndef LORA_PACKET_TRACE_H_
+#define LORA_PACKET_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Packet/AprsPacket.h"
+
+// A recorded (or made up) sequence of packets as the modem would see them,
+// one per line:
+//
+//   <ms> <rssi> <snr> <ok|crc|header> <TNC2>
+//   1500 -97.5 6.25 ok OE5BPA-7>APLRT1,WIDE1-1:!4812.34N/01410.12E>
+//
+// ms is the end of the reception since the start of the trace and must not
+// go backwards. Lines starting with '#' and empty lines are skipped, so are
+// lines that do not parse (counted in getErrors()). The text is parsed as
+// it is read and has to outlive the trace.
+class PacketTrace {
+public:
+  PacketTrace();
+
+  void begin(const char *text, size_t length);
+  void rewind();
+
+  bool available() const;
+  // time and length with LoRa header of the next record, only valid if available()
+  uint32_t getNextTime() const;
+  size_t   getNextLength() const;
+  // copy the next record with LoRa header into data, returns its length (0 if it does not fit)
+  size_t read(uint8_t *data, size_t size, RxMetadata &rx);
+  // drop the next record without reading it
+  void skip();
+
+  uint32_t getLineNumber() const;
+  uint32_t getErrors() const;
+
+private:
+  class Record {
+  public:
+    uint32_t    time;
+    RxMetadata  rx;
+    const char *line;
+    size_t      length;
+  };
+
+  const char *_text;
+  size_t      _length;
+  size_t      _position;
+  uint32_t    _lineNumber;
+  uint32_t    _errors;
+  bool        _available;
+  Record      _next;
+
+  void advance();
+  bool parse(const char *line, size_t length, Record &record) const;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "SimulatedRadio.h"
+
+SimulatedRadio::SimulatedRadio() : _state(SimulatedIdle), _start(0), _listenSince(0), _done(0), _busy(false), _received(0), _missed(0), _transmitted(0), _airtime(0) {
+}
+
+void SimulatedRadio::begin(const char *trace, size_t length, const LoRaModulation &modulation, uint32_t now) {
+  _trace.begin(trace, length);
+  _modulation  = modulation;
+  _state       = SimulatedIdle;
+  _start       = now;
+  _listenSince = now;
+  _busy        = false;
+  _received    = 0;
+  _missed      = 0;
+  _transmitted = 0;
+  _airtime     = 0;
+}
+
+PacketTrace &SimulatedRadio::getTrace() {
+  return _trace;
+}
+
+const PacketTrace &SimulatedRadio::getTrace() const {
+  return _trace;
+}
+
+SimulatedState SimulatedRadio::getState() const {
+  return _state;
+}
+
+LoRaModulation SimulatedRadio::getModulation() const {
+  return _modulation;
+}
+
+void SimulatedRadio::startReceive(uint32_t now) {
+  _state       = SimulatedReceiving;
+  _listenSince = now;
+  dropMissed();
+}
+
+void SimulatedRadio::startTransmit(size_t length, uint32_t now) {
+  const uint32_t airtime = LoRaAirtime::packetMillis(_modulation, length);
+  _state                 = SimulatedTransmitting;
+  _done                  = now + airtime;
+  _transmitted++;
+  _airtime += airtime;
+}
+
+void SimulatedRadio::startChannelScan(uint32_t now) {
+  // CAD takes about two symbols, whatever ended before is lost
+  const uint32_t duration = 2 * LoRaAirtime::symbolMicros(_modulation) / 1000;
+  _state                  = SimulatedScanning;
+  _done                   = now + (duration > 0 ? duration : 1);
+  _listenSince            = now;
+  dropMissed();
+  _busy = _trace.available() && (int32_t)(nextStart() - _done) < 0;
+}
+
+void SimulatedRadio::standby() {
+  _state = SimulatedIdle;
+}
+
+bool SimulatedRadio::getNextInterrupt(uint32_t &time) const {
+  switch (_state) {
+  case SimulatedReceiving:
+    if (!_trace.available()) {
+      return false;
+    }
+    time = nextEnd();
+    return true;
+  case SimulatedTransmitting:
+  case SimulatedScanning:
+    time = _done;
+    return true;
+  case SimulatedIdle:
+    break;
+  }
+  return false;
+}
+
+bool SimulatedRadio::isSignalDetected(uint32_t now) const {
+  return _state == SimulatedReceiving && _trace.available() && (int32_t)(now - nextStart()) >= 0 && (int32_t)(now - nextEnd()) < 0;
+}
+
+size_t SimulatedRadio::getPacketLength() const {
+  if (_state != SimulatedReceiving || !_trace.available()) {
+    return 0;
+  }
+  return _trace.getNextLength();
+}
+
+size_t SimulatedRadio::readData(uint8_t *data, size_t size, RxMetadata &rx) {
+  if (_state != SimulatedReceiving || !_trace.available()) {
+    return 0;
+  }
+  const uint32_t end    = nextEnd();
+  const size_t   length = _trace.read(data, size, rx);
+  if (length > 0) {
+    _received++;
+  }
+  // the receiver was busy with this packet, everything that started meanwhile collided with it
+  _listenSince = end;
+  dropMissed();
+  return length;
+}
+
+bool SimulatedRadio::isChannelBusy() const {
+  return _busy;
+}
+
+uint32_t SimulatedRadio::getReceived() const {
+  return _received;
+}
+
+uint32_t SimulatedRadio::getMissed() const {
+  return _missed;
+}
+
+uint32_t SimulatedRadio::getTransmitted() const {
+  return _transmitted;
+}
+
+uint32_t SimulatedRadio::getTransmittedAirtime() const {
+  return _airtime;
+}
+
+uint32_t SimulatedRadio::nextEnd() const {
+  return _start + _trace.getNextTime();
+}
+
+uint32_t SimulatedRadio::nextStart() const {
+  return nextEnd() - LoRaAirtime::packetMillis(_modulation, _trace.getNextLength());
+}
+
+void SimulatedRadio::dropMissed() {
+  // records sent before we started listening, ordered by their end
+  while (_trace.available() && (int32_t)(nextStart() - _listenSince) < 0) {
+    _trace.skip();
+    _missed++;
+  }
+}
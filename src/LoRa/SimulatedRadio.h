@@ -0,0 +1,75 @@
+#ifndef LORA_SIMULATED_RADIO_H_
+#define LORA_SIMULATED_RADIO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Airtime.h"
+#include "PacketTrace.h"
+
+enum SimulatedState {
+  SimulatedIdle,
+  SimulatedReceiving,
+  SimulatedTransmitting,
+  SimulatedScanning,
+};
+
+// A LoRa transceiver fed by a PacketTrace instead of an antenna. Every
+// record is on the air for its airtime up to the trace time, offset by the
+// time begin() was called. It is only received if the radio listened for all
+// of it, anything sent while transmitting, scanning or idle is missed.
+// Channel activity detection sees the records on the air during the scan.
+//
+// Nothing runs by itself: the owner asks for the time of the next interrupt
+// and delivers it (from a timer on the device, by advancing a virtual clock
+// on the host), then reads the packet or scan result like from a real modem.
+class SimulatedRadio {
+public:
+  SimulatedRadio();
+
+  void               begin(const char *trace, size_t length, const LoRaModulation &modulation, uint32_t now);
+  PacketTrace       &getTrace();
+  const PacketTrace &getTrace() const;
+  SimulatedState     getState() const;
+  LoRaModulation     getModulation() const;
+
+  void startReceive(uint32_t now);
+  void startTransmit(size_t length, uint32_t now);
+  void startChannelScan(uint32_t now);
+  void standby();
+
+  // time of the next RX done, TX done or CAD done, false if none is coming
+  bool getNextInterrupt(uint32_t &time) const;
+  // a record is on the air right now, like the modem status "signal detected"
+  bool isSignalDetected(uint32_t now) const;
+
+  // the packet of the last RX done
+  size_t getPacketLength() const;
+  size_t readData(uint8_t *data, size_t size, RxMetadata &rx);
+  // result of the last scan
+  bool isChannelBusy() const;
+
+  uint32_t getReceived() const;
+  uint32_t getMissed() const;
+  uint32_t getTransmitted() const;
+  uint32_t getTransmittedAirtime() const;
+
+private:
+  PacketTrace    _trace;
+  LoRaModulation _modulation;
+  SimulatedState _state;
+  uint32_t       _start;
+  uint32_t       _listenSince;
+  uint32_t       _done;
+  bool           _busy;
+  uint32_t       _received;
+  uint32_t       _missed;
+  uint32_t       _transmitted;
+  uint32_t       _airtime;
+
+  uint32_t nextEnd() const;
+  uint32_t nextStart() const;
+  void     dropMissed();
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "TxQueue.h"
+
+TxQueue::TxQueue() : _digiSlots(0), _slotMs(0), _random(1) {
+  setWeight(TxClassMessage, 8);
+  setWeight(TxClassDigi, 4);
+  setWeight(TxClassBeacon, 2);
+  setWeight(TxClassIsToRf, 1);
+  // a digipeat is useless once the other digis and iGates are done with it
+  setMaxAge(TxClassMessage, 60 * 1000);
+  setMaxAge(TxClassDigi, 30 * 1000);
+  setMaxAge(TxClassBeacon, 2 * 60 * 1000);
+  setMaxAge(TxClassIsToRf, 60 * 1000);
+}
+
+void TxQueue::setWeight(TxClass txClass, uint8_t weight) {
+  _classes[txClass].weight  = weight > 0 ? weight : 1;
+  _classes[txClass].credits = _classes[txClass].weight;
+}
+
+uint8_t TxQueue::getWeight(TxClass txClass) const {
+  return _classes[txClass].weight;
+}
+
+void TxQueue::setMaxAge(TxClass txClass, uint32_t maxAgeMs) {
+  _classes[txClass].maxAge = maxAgeMs;
+}
+
+uint32_t TxQueue::getMaxAge(TxClass txClass) const {
+  return _classes[txClass].maxAge;
+}
+
+void TxQueue::setDigiSlots(uint8_t slots, uint32_t slotMs) {
+  _digiSlots = slots;
+  _slotMs    = slotMs;
+}
+
+void TxQueue::setRandomSeed(uint32_t seed) {
+  // xorshift must not start at 0
+  _random = seed != 0 ? seed : 1;
+}
+
+void TxQueue::push(std::shared_ptr<AprsPacket> packet, TxClass txClass, uint32_t now) {
+  Entry entry;
+  entry.packet    = packet;
+  entry.txClass   = txClass;
+  entry.queuedAt  = now;
+  entry.notBefore = now;
+  if (txClass == TxClassDigi && _digiSlots > 0) {
+    entry.notBefore += (nextRandom() % (_digiSlots + 1)) * _slotMs;
+  }
+  _classes[txClass].queue.addElement(entry);
+}
+
+uint32_t TxQueue::getDropped(TxClass txClass) const {
+  return _classes[txClass].queue.getDroppedCount();
+}
+
+TxQueueResult TxQueue::pop(Entry &entry, uint32_t now) {
+  bool waiting = false;
+  // the second pass only runs if every ready class used up its share of the round
+  for (int pass = 0; pass < 2; pass++) {
+    bool exhausted = false;
+    for (size_t i = 0; i < TxClassCount; i++) {
+      Class &c = _classes[i];
+      if (!load(c)) {
+        continue;
+      }
+      if (expired(c, now)) {
+        entry = c.head;
+        c.head.packet.reset();
+        return TxQueueExpired;
+      }
+      if ((int32_t)(now - c.head.notBefore) < 0) {
+        waiting = true;
+        continue;
+      }
+      if (c.credits == 0) {
+        exhausted = true;
+        continue;
+      }
+      c.credits--;
+      entry = c.head;
+      c.head.packet.reset();
+      if (empty()) {
+        // the burst is over, the next one starts with a fresh round
+        startRound();
+      }
+      return TxQueueReady;
+    }
+    if (!exhausted) {
+      break;
+    }
+    startRound();
+  }
+
+  return waiting ? TxQueueWaiting : TxQueueEmpty;
+}
+
+void TxQueue::clear() {
+  for (size_t i = 0; i < TxClassCount; i++) {
+    Class &c = _classes[i];
+    c.head.packet.reset();
+    while (!c.queue.empty()) {
+      c.queue.getElement();
+    }
+  }
+  startRound();
+}
+
+bool TxQueue::empty() const {
+  for (size_t i = 0; i < TxClassCount; i++) {
+    if (_classes[i].head.packet || !_classes[i].queue.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TxQueue::isDue(uint32_t now) const {
+  for (size_t i = 0; i < TxClassCount; i++) {
+    const Class &c = _classes[i];
+    if (c.head.packet ? expired(c, now) || (int32_t)(now - c.head.notBefore) >= 0 : !c.queue.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t TxQueue::getNextDue(uint32_t now) const {
+  uint32_t next  = 0;
+  bool     found = false;
+  for (size_t i = 0; i < TxClassCount; i++) {
+    const Class &c = _classes[i];
+    uint32_t     due;
+    if (c.head.packet) {
+      // an expired head is due as well, it has to be taken out
+      due = expired(c, now) ? now : c.head.notBefore;
+    } else if (!c.queue.empty()) {
+      due = now;
+    } else {
+      continue;
+    }
+    if (!found || (int32_t)(due - next) < 0) {
+      next  = due;
+      found = true;
+    }
+  }
+  return next;
+}
+
+const char *TxQueue::toString(TxClass txClass) {
+  switch (txClass) {
+  case TxClassMessage:
+    return "message";
+  case TxClassDigi:
+    return "digi";
+  case TxClassBeacon:
+    return "beacon";
+  case TxClassIsToRf:
+    return "IS to RF";
+  case TxClassCount:
+    break;
+  }
+  return "";
+}
+
+bool TxQueue::load(Class &c) {
+  if (!c.head.packet && !c.queue.empty()) {
+    c.head = c.queue.getElement();
+  }
+  return (bool)c.head.packet;
+}
+
+bool TxQueue::expired(const Class &c, uint32_t now) const {
+  return c.maxAge != 0 && now - c.head.queuedAt > c.maxAge;
+}
+
+void TxQueue::startRound() {
+  for (size_t i = 0; i < TxClassCount; i++) {
+    _classes[i].credits = _classes[i].weight;
+  }
+}
+
+uint32_t TxQueue::nextRandom() {
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return _random;
+}
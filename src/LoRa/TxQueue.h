@@ -0,0 +1,109 @@
+#ifndef LORA_TX_QUEUE_H_
+#define LORA_TX_QUEUE_H_
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Packet/AprsPacket.h"
+#include "System/TaskQueue.h"
+
+// in order of priority
+enum TxClass {
+  TxClassMessage, // messages and acks being digipeated
+  TxClassDigi,
+  TxClassBeacon,
+  TxClassIsToRf,
+  TxClassCount,
+};
+
+enum TxQueueResult {
+  TxQueueEmpty,
+  TxQueueWaiting, // packets are queued, but none may go yet
+  TxQueueReady,
+  TxQueueExpired, // the entry waited longer than the max age of its class, drop it
+};
+
+// Packets waiting for the transmitter, one queue per class. pop() works in
+// rounds: every class may send up to its weight in packets per round, and
+// within a round the most important class with a packet ready goes first.
+// A message or digipeat therefore overtakes a burst of IS to RF traffic,
+// while the burst still gets its share once the others used up theirs.
+//
+// Packets older than the max age of their class are handed out as expired
+// instead of being sent. Digipeats can be held back for 0 to N random slots,
+// so digis hearing the same packet do not all key up at once.
+//
+// push() may be called by the main loop while the radio task calls pop()
+// and the other consumer methods. The setters are meant for setup, before
+// either side runs.
+class TxQueue {
+public:
+  static const size_t CAPACITY = 8; // per class
+
+  class Entry {
+  public:
+    Entry() : txClass(TxClassDigi), queuedAt(0), notBefore(0) {
+    }
+
+    std::shared_ptr<AprsPacket> packet;
+    TxClass                     txClass;
+    uint32_t                    queuedAt;
+    uint32_t                    notBefore;
+  };
+
+  TxQueue();
+
+  TxQueue(const TxQueue &)            = delete;
+  TxQueue &operator=(const TxQueue &) = delete;
+
+  void     setWeight(TxClass txClass, uint8_t weight);
+  uint8_t  getWeight(TxClass txClass) const;
+  // 0 for no limit
+  void     setMaxAge(TxClass txClass, uint32_t maxAgeMs);
+  uint32_t getMaxAge(TxClass txClass) const;
+  // 0 slots to send digipeats right away
+  void     setDigiSlots(uint8_t slots, uint32_t slotMs);
+  void     setRandomSeed(uint32_t seed);
+
+  // producer side, the oldest packet of the class is dropped if it is full
+  void     push(std::shared_ptr<AprsPacket> packet, TxClass txClass, uint32_t now);
+  uint32_t getDropped(TxClass txClass) const;
+
+  // consumer side
+  TxQueueResult pop(Entry &entry, uint32_t now);
+  void          clear();
+  bool          empty() const;
+  // Packets pop() has not looked at yet count as due, their slot delay is
+  // only known once they were taken from the class queue.
+  bool          isDue(uint32_t now) const;
+  // millis() timestamp the next packet may go, 0 if the queue is empty
+  uint32_t      getNextDue(uint32_t now) const;
+
+  static const char *toString(TxClass txClass);
+
+private:
+  class Class {
+  public:
+    Class() : queue(TaskQueueOverflow::DropOldest), weight(1), credits(1), maxAge(0) {
+    }
+
+    TaskQueue<Entry, CAPACITY> queue;
+    Entry                      head; // taken from the queue, but not sent yet
+    uint8_t                    weight;
+    uint8_t                    credits; // left in this round
+    uint32_t                   maxAge;
+  };
+
+  Class    _classes[TxClassCount];
+  uint8_t  _digiSlots;
+  uint32_t _slotMs;
+  uint32_t _random;
+
+  bool     load(Class &c);
+  bool     expired(const Class &c, uint32_t now) const;
+  void     startRound();
+  uint32_t nextRandom();
+};
+
+#endif
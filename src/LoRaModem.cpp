@@ -1,3 +1,6 @@
+#include <SPIFFS.h>
+#include <new>
+
 #include "LoRaModem.h"
 
 // SX1278
@@ -30,8 +33,12 @@ int16_t Modem_SX1278::begin(const LoraPins &lora_pins, const Configuration::LoRa
   return RADIOLIB_ERR_NONE;
 }
 
-int16_t Modem_SX1278::readData(String &str) {
-  return _radio->readData(str);
+size_t Modem_SX1278::getPacketLength() {
+  return _radio->getPacketLength();
+}
+
+int16_t Modem_SX1278::readData(uint8_t *data, size_t len) {
+  return _radio->readData(data, len);
 }
 
 int16_t Modem_SX1278::setFrequency(float freq) {
@@ -42,8 +49,20 @@ int16_t Modem_SX1278::startReceive() {
   return _radio->startReceive();
 }
 
-int16_t Modem_SX1278::startTransmit(String &str) {
-  return _radio->startTransmit(str);
+int16_t Modem_SX1278::startTransmit(uint8_t *data, size_t len) {
+  return _radio->startTransmit(data, len);
+}
+
+int16_t Modem_SX1278::startChannelScan() {
+  return _radio->startChannelScan();
+}
+
+int16_t Modem_SX1278::getChannelScanResult() {
+  // DIO0 signals CAD done, whether a preamble was seen is only in the IRQ flags
+  if (_radio->getIRQFlags() & RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED) {
+    return RADIOLIB_PREAMBLE_DETECTED;
+  }
+  return RADIOLIB_CHANNEL_FREE;
 }
 
 int16_t Modem_SX1278::receive(String &str) {
@@ -96,8 +115,12 @@ int16_t Modem_SX1268::begin(const LoraPins &lora_pins, const Configuration::LoRa
   return RADIOLIB_ERR_NONE;
 }
 
-int16_t Modem_SX1268::readData(String &str) {
-  return _radio->readData(str);
+size_t Modem_SX1268::getPacketLength() {
+  return _radio->getPacketLength();
+}
+
+int16_t Modem_SX1268::readData(uint8_t *data, size_t len) {
+  return _radio->readData(data, len);
 }
 
 int16_t Modem_SX1268::setFrequency(float freq) {
@@ -108,8 +131,18 @@ int16_t Modem_SX1268::startReceive() {
   return _radio->startReceive();
 }
 
-int16_t Modem_SX1268::startTransmit(String &str) {
-  return _radio->startTransmit(str);
+int16_t Modem_SX1268::startTransmit(uint8_t *data, size_t len) {
+  return _radio->startTransmit(data, len);
+}
+
+int16_t Modem_SX1268::startChannelScan() {
+  return _radio->startChannelScan();
+}
+
+// the SX126x reports activity as RADIOLIB_LORA_DETECTED
+int16_t Modem_SX1268::getChannelScanResult() {
+  const int16_t result = _radio->getChannelScanResult();
+  return result == RADIOLIB_LORA_DETECTED ? RADIOLIB_PREAMBLE_DETECTED : result;
 }
 
 int16_t Modem_SX1268::receive(String &str) {
@@ -131,3 +164,108 @@ float Modem_SX1268::getFrequencyError() {
 uint8_t Modem_SX1268::getModemStatus() {
   return 0;
 }
+
+// simulated
+Modem_Simulated::Modem_Simulated() : _trace(0), _setFlag(0) {
+}
+
+Modem_Simulated::~Modem_Simulated() {
+  _interrupt.detach();
+  delete[] _trace;
+}
+
+int16_t Modem_Simulated::begin(const LoraPins &lora_pins, const Configuration::LoRa &lora_config, const uint16_t preambleLength, void (*setFlag)()) {
+  File file = SPIFFS.open(lora_config.trace);
+  if (!file) {
+    return RADIOLIB_ERR_UNKNOWN;
+  }
+  const size_t size = file.size();
+  _trace            = new (std::nothrow) char[size];
+  if (_trace == 0) {
+    file.close();
+    return RADIOLIB_ERR_UNKNOWN;
+  }
+  const size_t read = file.readBytes(_trace, size);
+  file.close();
+
+  _setFlag                  = setFlag;
+  LoRaModulation modulation = getModulation(lora_config);
+  modulation.preambleLength = preambleLength;
+  _radio.begin(_trace, read, modulation, millis());
+  return RADIOLIB_ERR_NONE;
+}
+
+size_t Modem_Simulated::getPacketLength() {
+  return _radio.getPacketLength();
+}
+
+int16_t Modem_Simulated::readData(uint8_t *data, size_t len) {
+  _rx = RxMetadata();
+  _radio.readData(data, len, _rx);
+  arm();
+  switch (_rx.status) {
+  case RxCrcError:
+    return RADIOLIB_ERR_CRC_MISMATCH;
+  case RxHeaderError:
+    return RADIOLIB_ERR_LORA_HEADER_DAMAGED;
+  default:
+    return RADIOLIB_ERR_NONE;
+  }
+}
+
+int16_t Modem_Simulated::setFrequency(float freq) {
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t Modem_Simulated::startReceive() {
+  _radio.startReceive(millis());
+  arm();
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t Modem_Simulated::startTransmit(uint8_t *data, size_t len) {
+  _radio.startTransmit(len, millis());
+  arm();
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t Modem_Simulated::startChannelScan() {
+  _radio.startChannelScan(millis());
+  arm();
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t Modem_Simulated::getChannelScanResult() {
+  return _radio.isChannelBusy() ? RADIOLIB_PREAMBLE_DETECTED : RADIOLIB_CHANNEL_FREE;
+}
+
+int16_t Modem_Simulated::receive(String &str) {
+  return RADIOLIB_ERR_UNSUPPORTED;
+}
+
+float Modem_Simulated::getRSSI() {
+  return _rx.rssi;
+}
+
+float Modem_Simulated::getSNR() {
+  return _rx.snr;
+}
+
+float Modem_Simulated::getFrequencyError() {
+  return _rx.frequencyError;
+}
+
+uint8_t Modem_Simulated::getModemStatus() {
+  // bit 0 is "signal detected" like on the SX1278
+  return _radio.isSignalDetected(millis()) ? 0x01 : 0x00;
+}
+
+void Modem_Simulated::arm() {
+  _interrupt.detach();
+  uint32_t time;
+  if (!_radio.getNextInterrupt(time)) {
+    return;
+  }
+  const int32_t wait = (int32_t)(time - millis());
+  _interrupt.once_ms(wait > 0 ? wait : 1, _setFlag);
+}
@@ -2,12 +2,17 @@
 #define LORA_MODEM_H_
 
 #include <RadioLib.h>
+#include <Ticker.h>
 
 #include "BoardFinder/BoardFinder.h"
+#include "LoRa/Airtime.h"
+#include "LoRa/SimulatedRadio.h"
 #include "project_configuration.h"
 
 class LoRaModem {
 public:
+  static const uint16_t PREAMBLE_LENGTH = 8;
+
   LoRaModem() : _module(0) {
   }
 
@@ -16,11 +21,17 @@ public:
 
   virtual int16_t begin(const LoraPins &lora_pins, const Configuration::LoRa &lora_config, const uint16_t preambleLength, void (*setFlag)()) = 0;
 
-  virtual int16_t readData(String &str) = 0;
+  virtual size_t  getPacketLength()                   = 0;
+  virtual int16_t readData(uint8_t *data, size_t len) = 0;
+
+  virtual int16_t setFrequency(float freq)                 = 0;
+  virtual int16_t startReceive()                           = 0;
+  virtual int16_t startTransmit(uint8_t *data, size_t len) = 0;
 
-  virtual int16_t setFrequency(float freq)   = 0;
-  virtual int16_t startReceive()             = 0;
-  virtual int16_t startTransmit(String &str) = 0;
+  // channel activity detection, the end of the scan is signaled like RX/TX done
+  virtual int16_t startChannelScan() = 0;
+  // RADIOLIB_CHANNEL_FREE or RADIOLIB_PREAMBLE_DETECTED on every modem, the modem specific codes are mapped to these
+  virtual int16_t getChannelScanResult() = 0;
 
   virtual int16_t receive(String &str) = 0;
 
@@ -29,6 +40,10 @@ public:
   virtual float   getFrequencyError() = 0;
   virtual uint8_t getModemStatus()    = 0;
 
+  static LoRaModulation getModulation(const Configuration::LoRa &lora_config) {
+    return LoRaModulation(lora_config.spreadingFactor, lora_config.signalBandwidth, lora_config.codingRate4, PREAMBLE_LENGTH);
+  }
+
 protected:
   Module *_module;
 };
@@ -39,11 +54,15 @@ public:
 
   int16_t begin(const LoraPins &lora_pins, const Configuration::LoRa &lora_config, const uint16_t preambleLength, void (*setFlag)()) override;
 
-  int16_t readData(String &str) override;
+  size_t  getPacketLength() override;
+  int16_t readData(uint8_t *data, size_t len) override;
 
   int16_t setFrequency(float freq) override;
   int16_t startReceive() override;
-  int16_t startTransmit(String &str) override;
+  int16_t startTransmit(uint8_t *data, size_t len) override;
+
+  int16_t startChannelScan() override;
+  int16_t getChannelScanResult() override;
 
   int16_t receive(String &str) override;
 
@@ -62,11 +81,15 @@ public:
 
   int16_t begin(const LoraPins &lora_pins, const Configuration::LoRa &lora_config, const uint16_t preambleLength, void (*setFlag)()) override;
 
-  int16_t readData(String &str) override;
+  size_t  getPacketLength() override;
+  int16_t readData(uint8_t *data, size_t len) override;
 
   int16_t setFrequency(float freq) override;
   int16_t startReceive() override;
-  int16_t startTransmit(String &str) override;
+  int16_t startTransmit(uint8_t *data, size_t len) override;
+
+  int16_t startChannelScan() override;
+  int16_t getChannelScanResult() override;
 
   int16_t receive(String &str) override;
 
@@ -79,4 +102,42 @@ private:
   SX1262 *_radio;
 };
 
+// Replays a packet trace from SPIFFS (lora.trace) instead of talking to a
+// modem, for testing the whole iGate without RF. The interrupts of the
+// simulated radio are delivered by a timer, so they come at trace speed.
+// The timer runs in task context, setFlag must not be an ISR-only path.
+class Modem_Simulated : public LoRaModem {
+public:
+  Modem_Simulated();
+  ~Modem_Simulated();
+
+  int16_t begin(const LoraPins &lora_pins, const Configuration::LoRa &lora_config, const uint16_t preambleLength, void (*setFlag)()) override;
+
+  size_t  getPacketLength() override;
+  int16_t readData(uint8_t *data, size_t len) override;
+
+  int16_t setFrequency(float freq) override;
+  int16_t startReceive() override;
+  int16_t startTransmit(uint8_t *data, size_t len) override;
+
+  int16_t startChannelScan() override;
+  int16_t getChannelScanResult() override;
+
+  int16_t receive(String &str) override;
+
+  float   getRSSI() override;
+  float   getSNR() override;
+  float   getFrequencyError() override;
+  uint8_t getModemStatus() override;
+
+private:
+  SimulatedRadio _radio;
+  char          *_trace;
+  RxMetadata     _rx;
+  Ticker         _interrupt;
+  void (*_setFlag)();
+
+  void arm();
+};
+
 #endif
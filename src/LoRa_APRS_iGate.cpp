@@ -28,10 +28,11 @@
 String create_lat_aprs(double lat);
 String create_long_aprs(double lng);
 
-TaskQueue<std::shared_ptr<APRSMessage>> toAprsIs;
-TaskQueue<std::shared_ptr<APRSMessage>> fromModem;
-TaskQueue<std::shared_ptr<APRSMessage>> toModem;
-TaskQueue<std::shared_ptr<APRSMessage>> toMQTT;
+TaskQueue<std::shared_ptr<AprsPacket>> toAprsIs(TaskQueueOverflow::DropOldest);
+TaskQueue<std::shared_ptr<AprsPacket>> fromAprsIs(TaskQueueOverflow::DropOldest);
+TaskQueue<std::shared_ptr<AprsPacket>> fromModem(TaskQueueOverflow::DropOldest);
+TxQueue                                toModem;
+TaskQueue<std::shared_ptr<AprsPacket>> toMQTT(TaskQueueOverflow::DropOldest);
 
 System        LoRaSystem;
 Configuration userConfig;
@@ -45,8 +46,8 @@ OTATask      otaTask;
 NTPTask      ntpTask;
 FTPTask      ftpTask;
 MQTTTask     mqttTask(toMQTT);
-AprsIsTask   aprsIsTask(toAprsIs, toModem);
-RouterTask   routerTask(fromModem, toModem, toAprsIs, toMQTT);
+AprsIsTask   aprsIsTask(toAprsIs, fromAprsIs);
+RouterTask   routerTask(fromModem, fromAprsIs, toModem, toAprsIs, toMQTT);
 BeaconTask   beaconTask(toModem, toAprsIs);
 
 void setup() {
@@ -74,6 +75,11 @@ void setup() {
   ProjectConfigurationManagement confmg(LoRaSystem.getLogger());
   confmg.readConfiguration(LoRaSystem.getLogger(), userConfig);
 
+  // reserve the pools early, before the heap gets fragmented
+  if (!AprsPacket::getPool().begin(userConfig.memory.packetPool) || !TextFrame::getPool().begin(userConfig.memory.framePool)) {
+    LoRaSystem.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, MODULE_NAME, "Memory pools could not be allocated, using the heap!");
+  }
+
   BoardFinder        finder(boardConfigs);
   BoardConfig const *boardConfig = finder.getBoardConfig(userConfig.board);
   if (!boardConfig) {
@@ -181,9 +187,38 @@ void setup() {
 
 volatile bool syslogSet = false;
 
+// minimal serial console: "profile" dumps the task profiler, "profile reset" clears it, "memory" shows heap and pools
+char   serialCommand[32];
+size_t serialCommandLength = 0;
+
+void handleSerialCommand() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c != '\r' && c != '\n') {
+      if (serialCommandLength < sizeof(serialCommand) - 1) {
+        serialCommand[serialCommandLength++] = c;
+      }
+      continue;
+    }
+    serialCommand[serialCommandLength] = 0;
+    if (strcmp(serialCommand, "profile") == 0) {
+      LoRaSystem.getTaskManager().logProfile(LoRaSystem, logging::LoggerLevel::LOGGER_LEVEL_INFO);
+    } else if (strcmp(serialCommand, "profile reset") == 0) {
+      LoRaSystem.getTaskManager().resetProfile();
+      LoRaSystem.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, MODULE_NAME, "profiler reset");
+    } else if (strcmp(serialCommand, "memory") == 0) {
+      LoRaSystem.getTaskManager().logMemory(LoRaSystem, logging::LoggerLevel::LOGGER_LEVEL_INFO);
+    } else if (serialCommandLength > 0) {
+      LoRaSystem.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, MODULE_NAME, "unknown command '%s', try 'profile', 'profile reset' or 'memory'", serialCommand);
+    }
+    serialCommandLength = 0;
+  }
+}
+
 void loop() {
   esp_task_wdt_reset();
   LoRaSystem.getTaskManager().loop(LoRaSystem);
+  handleSerialCommand();
   if (LoRaSystem.isWifiOrEthConnected() && LoRaSystem.getUserConfig()->syslog.active && !syslogSet) {
     LoRaSystem.getLogger().setSyslogServer(LoRaSystem.getUserConfig()->syslog.server, LoRaSystem.getUserConfig()->syslog.port, LoRaSystem.getUserConfig()->callsign);
     LoRaSystem.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, MODULE_NAME, "System connected after a restart to the network, syslog server set");
@@ -0,0 +1,20 @@
+#ifndef NATIVE_ARDUINO_H_
+#define NATIVE_ARDUINO_H_
+
+// Just enough of Arduino.h to build the display code on the host.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/types.h>
+
+class String : public std::string {
+public:
+  String(const char *str = "") : std::string(str) {
+  }
+};
+
+#endif
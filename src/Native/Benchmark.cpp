@@ -0,0 +1,421 @@
+// Packet throughput and latency of the iGate pipeline on the host: modem ->
+// router -> APRS-IS, MQTT and TX queue, with the network clients and the
+// transmitter stubbed out. Every scheduler turn runs the tasks in the order
+// TaskManager does (radio, router, APRS-IS, MQTT) and each one does the
+// work its firmware task does per loop(). Results are JSON lines on stdout,
+// one per traffic mix, so they can be compared across versions. The
+// task_queue run compares the TaskQueue ring with the std::list it replaced
+// when two threads pass elements through it.
+//
+//   pio run -e native_benchmark
+//   .pio/build/native_benchmark/program [-n PACKETS] [-l LABEL] [MIX...]
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+#include "LoRa/TxQueue.h"
+#include "Packet/MqttPayload.h"
+#include "Packet/Router.h"
+#include "System/Histogram.h"
+#include "System/TaskQueue.h"
+
+// every heap allocation counts, a packet should not need any
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size);
+  if (p == 0) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+static uint32_t micros() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char *CALLSIGN = "OE5GW-10";
+
+// One kind of traffic: the n-th packet as heard on RF, how many of them
+// arrive per scheduler turn and optionally the n-th packet from APRS-IS.
+class Mix {
+public:
+  const char *name;
+  const char *description;
+  size_t      burst;
+  bool        digi;
+  void (*rf)(char *line, size_t size, uint32_t n);
+  bool (*aprsIs)(char *line, size_t size, uint32_t n);
+};
+
+static void position(char *line, size_t size, uint32_t n, const char *path) {
+  snprintf(line, size, "OE%u%c%c%c-%u>APLRT1%s:!48%02u.%02uN/014%02u.%02uE>%u", n % 10, 'A' + n / 10 % 26, 'A' + n / 260 % 26, 'A' + n / 6760 % 26, n % 16, path, n % 60, n % 100, n / 7 % 60, n / 3 % 100, n);
+}
+
+static void rfPositions(char *line, size_t size, uint32_t n) {
+  position(line, size, n, "");
+}
+
+static void rfDigi(char *line, size_t size, uint32_t n) {
+  position(line, size, n, ",WIDE1-1");
+}
+
+// every packet heard direct and through two other digis
+static void rfDuplicates(char *line, size_t size, uint32_t n) {
+  static const char *paths[] = {",WIDE1-1", ",OE5DIG-10*,WIDE1*", ",OE5DIG-11*,WIDE1*"};
+  position(line, size, n / 3, paths[n % 3]);
+}
+
+static void rfMessages(char *line, size_t size, uint32_t n) {
+  if (n % 2 == 0) {
+    position(line, size, n, ",WIDE1-1");
+  } else {
+    snprintf(line, size, "OE%u%c%c%c-%u>APLRT1,WIDE1-1::DL1ABC   :hello %u{%u", n % 10, 'A' + n / 10 % 26, 'A' + n / 260 % 26, 'A' + n / 6760 % 26, n % 16, n, n % 100);
+  }
+}
+
+// a message for a station heard a moment ago
+static bool aprsIsMessages(char *line, size_t size, uint32_t n) {
+  if (n % 2 != 0) {
+    return false;
+  }
+  char station[16];
+  snprintf(station, sizeof(station), "OE%u%c%c%c-%u", n % 10, 'A' + n / 10 % 26, 'A' + n / 260 % 26, 'A' + n / 6760 % 26, n % 16);
+  snprintf(line, size, "DL1ABC>APRS,TCPIP*,qAC,T2TEST::%-9s:reply %u{%u", station, n, n % 100);
+  return true;
+}
+
+static const Mix MIXES[] = {
+    {"uplink", "positions to APRS-IS and MQTT", 1, false, rfPositions, 0},
+    {"digi", "WIDE1-1 positions, uplink and digipeat", 1, true, rfDigi, 0},
+    {"duplicates", "every packet heard three times", 1, true, rfDuplicates, 0},
+    {"messages", "messages both ways, IS to RF gating", 1, true, rfMessages, aprsIsMessages},
+    {"burst", "four packets per scheduler turn", 4, true, rfDigi, 0},
+};
+
+class Result {
+public:
+  Result() : packets(0), routed(0), seconds(0), uplinked(0), uplinkBytes(0), published(0), publishedBytes(0), transmitted(0), gated(0), droppedRx(0), droppedTx(0), allocations(0), peakFromModem(0), peakToAprsIs(0), peakToMQTT(0), peakPool(0), poolFallbacks(0) {
+  }
+
+  uint32_t  packets; // offered by the radio
+  uint32_t  routed;  // taken by the router, the rest was dropped from the full modem queue
+  double    seconds;
+  Histogram aprsIsLatency; // us from RX done to the APRS-IS write
+  Histogram mqttLatency;   // us from RX done to the MQTT publish
+  uint32_t  uplinked;
+  uint64_t  uplinkBytes;
+  uint32_t  published;
+  uint64_t  publishedBytes;
+  uint32_t  transmitted;
+  uint32_t  gated;
+  uint32_t  droppedRx; // RX queues full, packet lost before the router or an uplink
+  uint32_t  droppedTx; // TX queue full or expired
+  size_t    allocations;
+  size_t    peakFromModem;
+  size_t    peakToAprsIs;
+  size_t    peakToMQTT;
+  size_t    peakPool;
+  size_t    poolFallbacks;
+};
+
+class Pipeline {
+public:
+  Pipeline(const Mix &mix) : _mix(mix), _router(_toModem, _toAprsIs, _toMQTT), _txLength(0), _txPackets(0) {
+    _router.setCallsign(CALLSIGN);
+    _router.setUplink(true);
+    _router.setDigi(mix.digi);
+    _router.setMQTT(true);
+    _router.getIsGate().setBudget(UINT32_MAX, 0);
+  }
+
+  Result run(uint32_t packets) {
+    Result         result;
+    uint32_t       next      = 0;
+    const uint32_t start     = micros();
+    const size_t   before    = allocations;
+    const uint32_t fallbacks = AprsPacket::getPool().getFallbacks();
+    result.packets           = packets;
+    while (next < packets || !idle()) {
+      const uint32_t now = micros() / 1000;
+      for (size_t i = 0; i < _mix.burst && next < packets; i++, next++) {
+        radio(next, result);
+      }
+      if (AprsPacket::getPool().getUsed() > result.peakPool) {
+        result.peakPool = AprsPacket::getPool().getUsed();
+      }
+      router(now);
+      aprsIs(result);
+      mqtt(result);
+      transmit(now, result);
+    }
+    result.seconds       = (micros() - start) / 1e6;
+    result.allocations   = allocations - before;
+    result.routed        = packets - _fromModem.getDroppedCount();
+    result.gated         = _router.getIsGate().getCount(IsGateOkay);
+    result.peakFromModem = _fromModem.getHighWatermark();
+    result.peakToAprsIs  = _toAprsIs.getHighWatermark();
+    result.peakToMQTT    = _toMQTT.getHighWatermark();
+    result.poolFallbacks = AprsPacket::getPool().getFallbacks() - fallbacks;
+    result.droppedRx += _fromModem.getDroppedCount() + _toAprsIs.getDroppedCount() + _toMQTT.getDroppedCount();
+    for (int i = 0; i < TxClassCount; i++) {
+      result.droppedTx += _toModem.getDropped((TxClass)i);
+    }
+    return result;
+  }
+
+private:
+  static const size_t TX_BUFFER_SIZE = 1024;
+  static const size_t FLUSH_SIZE     = 512;
+
+  const Mix                             &_mix;
+  TaskQueue<std::shared_ptr<AprsPacket>> _fromModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> _fromAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> _toAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> _toMQTT;
+  TxQueue                                _toModem;
+  Router                                 _router;
+
+  // stub of the APRS-IS client: lines are encoded into the transmit buffer and "sent" in batches
+  char     _txBuffer[TX_BUFFER_SIZE];
+  size_t   _txLength;
+  uint32_t _txTimestamps[TX_BUFFER_SIZE / 16];
+  size_t   _txPackets;
+  // stub of the MQTT client: the payload is serialized and counted
+  char _mqttPayload[1024];
+
+  bool idle() const {
+    return _fromModem.empty() && _fromAprsIs.empty() && _toAprsIs.empty() && _toMQTT.empty() && _toModem.empty() && _txLength == 0 && _router.getDeadline() == 0;
+  }
+
+  // RadiolibTask: read the packet into a pooled frame right after RX done
+  void radio(uint32_t n, Result &result) {
+    std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+    uint8_t                    *raw    = packet->getRawBuffer();
+    raw[0]                             = '<';
+    raw[1]                             = 0xff;
+    raw[2]                             = 0x01;
+    _mix.rf((char *)raw + AprsPacket::HEADER_LENGTH, AprsPacket::getRawCapacity() - AprsPacket::HEADER_LENGTH, n);
+    if (!packet->decodeRaw(AprsPacket::HEADER_LENGTH + strlen((const char *)raw + AprsPacket::HEADER_LENGTH))) {
+      result.droppedRx++;
+      return;
+    }
+    RxMetadata rx;
+    rx.rssi      = -100;
+    rx.snr       = 5;
+    rx.timestamp = micros();
+    packet->setOrigin(OriginRf);
+    packet->setRxMetadata(rx);
+    _fromModem.addElement(packet);
+
+    char line[AprsPacket::MAX_LENGTH];
+    if (_mix.aprsIs && _mix.aprsIs(line, sizeof(line), n)) {
+      std::shared_ptr<AprsPacket> message = AprsPacket::create();
+      if (message->decode(line)) {
+        _fromAprsIs.addElement(message);
+      }
+    }
+  }
+
+  // RouterTask::loop: one packet from the modem, everything from APRS-IS
+  void router(uint32_t now) {
+    if (!_fromModem.empty()) {
+      _router.fromRf(_fromModem.getElement(), now);
+    }
+    while (!_fromAprsIs.empty()) {
+      std::shared_ptr<AprsPacket> rfPacket;
+      _router.fromAprsIs(_fromAprsIs.getElement(), now, rfPacket);
+    }
+    _router.release(now);
+  }
+
+  // AprsIsTask::loop: queue what fits, flush once enough is pending or nothing more is coming
+  void aprsIs(Result &result) {
+    while (!_toAprsIs.empty() && TX_BUFFER_SIZE - _txLength >= AprsPacket::MAX_LENGTH + 32 && _txPackets < sizeof(_txTimestamps) / sizeof(_txTimestamps[0])) {
+      std::shared_ptr<AprsPacket> packet = _toAprsIs.getElement();
+      size_t                      length = packet->encode(_txBuffer + _txLength, TX_BUFFER_SIZE - _txLength - 2, CALLSIGN);
+      _txBuffer[_txLength + length++]    = '\r';
+      _txBuffer[_txLength + length++]    = '\n';
+      _txTimestamps[_txPackets++]        = packet->getRxMetadata().timestamp;
+      _txLength += length;
+    }
+    if (_txLength >= FLUSH_SIZE || (_txLength > 0 && _toAprsIs.empty())) {
+      const uint32_t now = micros();
+      for (size_t i = 0; i < _txPackets; i++) {
+        result.aprsIsLatency.add(now - _txTimestamps[i]);
+      }
+      result.uplinked += _txPackets;
+      result.uplinkBytes += _txLength;
+      _txLength  = 0;
+      _txPackets = 0;
+    }
+  }
+
+  // MQTTTask::loop: up to eight packets per turn, serialized into the reusable payload buffer
+  void mqtt(Result &result) {
+    for (size_t i = 0; i < 8 && !_toMQTT.empty(); i++) {
+      std::shared_ptr<AprsPacket> packet = _toMQTT.getElement();
+      result.publishedBytes += MqttPayload::encodeJson(*packet, "Position Without Timestamp", _mqttPayload, sizeof(_mqttPayload));
+      result.mqttLatency.add(micros() - packet->getRxMetadata().timestamp);
+      result.published++;
+    }
+  }
+
+  // RadiolibTask TX side, the transmitter takes no time
+  void transmit(uint32_t now, Result &result) {
+    TxQueue::Entry entry;
+    TxQueueResult  state;
+    while ((state = _toModem.pop(entry, now)) == TxQueueExpired) {
+      result.droppedTx++;
+    }
+    if (state == TxQueueReady) {
+      result.transmitted++;
+    }
+  }
+};
+
+static void print(const char *label, const Mix &mix, const Result &r) {
+  printf("{\"label\":\"%s\",\"mix\":\"%s\",\"packets\":%u,\"routed\":%u,\"seconds\":%.6f,\"packets_per_second\":%.0f,", label, mix.name, r.packets, r.routed, r.seconds, r.seconds > 0 ? r.routed / r.seconds : 0);
+  printf("\"aprs_is\":{\"packets\":%u,\"bytes\":%llu,\"latency_p50_us\":%u,\"latency_p99_us\":%u,\"latency_max_us\":%u},", r.uplinked, (unsigned long long)r.uplinkBytes, r.aprsIsLatency.getPercentile(50), r.aprsIsLatency.getPercentile(99), r.aprsIsLatency.getMax());
+  printf("\"mqtt\":{\"packets\":%u,\"bytes\":%llu,\"latency_p50_us\":%u,\"latency_p99_us\":%u,\"latency_max_us\":%u},", r.published, (unsigned long long)r.publishedBytes, r.mqttLatency.getPercentile(50), r.mqttLatency.getPercentile(99), r.mqttLatency.getMax());
+  printf("\"rf\":{\"transmitted\":%u,\"gated\":%u},", r.transmitted, r.gated);
+  printf("\"queue_peak\":{\"from_modem\":%u,\"to_aprs_is\":%u,\"to_mqtt\":%u,\"packet_pool\":%u},", (unsigned)r.peakFromModem, (unsigned)r.peakToAprsIs, (unsigned)r.peakToMQTT, (unsigned)r.peakPool);
+  printf("\"dropped\":{\"rx\":%u,\"tx\":%u},\"pool_fallbacks\":%u,\"allocations_per_packet\":%.3f}\n", r.droppedRx, r.droppedTx, (unsigned)r.poolFallbacks, r.packets > 0 ? (double)r.allocations / r.packets : 0);
+}
+
+// reference: the former std::list based queue, guarded by a mutex to be thread safe
+template <typename T> class ListQueue {
+public:
+  void addElement(T elem) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _elements.push_back(elem);
+  }
+  T getElement() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    T                           elem = _elements.front();
+    _elements.pop_front();
+    return elem;
+  }
+  bool empty() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _elements.empty();
+  }
+
+private:
+  std::mutex   _mutex;
+  std::list<T> _elements;
+};
+
+// the ring rejects when full, the producer retries until it is accepted
+class RetryingRing {
+public:
+  void addElement(std::shared_ptr<uint32_t> elem) {
+    while (!_queue.addElement(elem)) {
+      std::this_thread::yield();
+    }
+  }
+  std::shared_ptr<uint32_t> getElement() {
+    return _queue.getElement();
+  }
+  bool empty() const {
+    return _queue.empty();
+  }
+
+private:
+  TaskQueue<std::shared_ptr<uint32_t>, 64> _queue{TaskQueueOverflow::Reject};
+};
+
+// elements per second from a producer thread to the consumer
+template <typename Q> static double measureThroughput(Q &queue, uint32_t count) {
+  auto        start = std::chrono::steady_clock::now();
+  std::thread producer([&queue, count]() {
+    for (uint32_t i = 0; i < count; i++) {
+      queue.addElement(std::make_shared<uint32_t>(i));
+    }
+  });
+  for (uint32_t i = 0; i < count;) {
+    if (!queue.empty()) {
+      queue.getElement();
+      i++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return count / elapsed.count();
+}
+
+static void taskQueue(const char *label, uint32_t count) {
+  RetryingRing                         ring;
+  ListQueue<std::shared_ptr<uint32_t>> list;
+  const double                         ringRate = measureThroughput(ring, count);
+  const double                         listRate = measureThroughput(list, count);
+  printf("{\"label\":\"%s\",\"mix\":\"task_queue\",\"elements\":%u,\"ring_elements_per_second\":%.0f,\"list_elements_per_second\":%.0f}\n", label, count, ringRate, listRate);
+}
+
+static bool isSelected(int argc, char **argv, const char *name) {
+  bool selected = optind >= argc;
+  for (int i = optind; i < argc; i++) {
+    selected |= strcmp(argv[i], name) == 0;
+  }
+  return selected;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [-n PACKETS] [-l LABEL] [MIX...]\n", name);
+  for (const Mix &mix : MIXES) {
+    fprintf(stderr, "  %-12s %s\n", mix.name, mix.description);
+  }
+  fprintf(stderr, "  %-12s %s\n", "task_queue", "TaskQueue ring against std::list and a mutex, PACKETS * 10 elements");
+}
+
+int main(int argc, char **argv) {
+  uint32_t    packets = 20000;
+  const char *label   = "";
+  int         option;
+  while ((option = getopt(argc, argv, "n:l:")) != -1) {
+    switch (option) {
+    case 'n':
+      packets = strtoul(optarg, 0, 10);
+      break;
+    case 'l':
+      label = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  // the firmware default of memory.packet_pool
+  AprsPacket::getPool().begin(32);
+  for (const Mix &mix : MIXES) {
+    if (!isSelected(argc, argv, mix.name)) {
+      continue;
+    }
+    Pipeline pipeline(mix);
+    print(label, mix, pipeline.run(packets));
+  }
+  if (isSelected(argc, argv, "task_queue")) {
+    taskQueue(label, packets * 10);
+  }
+  return 0;
+}
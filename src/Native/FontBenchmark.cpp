@@ -0,0 +1,177 @@
+// Text rendering of Bitmap on the host: drawString and drawStringLF with the
+// glyph offset table and column blit, against the previous renderer that
+// summed up the glyph widths and plotted every pixel. Both draw the same
+// screens, the output is checked to be identical. Results are JSON lines
+// on stdout, one per function.
+//
+//   pio run -e native_font_benchmark
+//   .pio/build/native_font_benchmark/program [-n SCREENS] [-l LABEL]
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "Display/Bitmap.h"
+#include "Display/FontConfig.h"
+
+static const int WIDTH  = 128;
+static const int HEIGHT = 64;
+
+static uint64_t nowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bitmap::drawChar before the offset table
+static int drawCharLinear(Bitmap &bitmap, int x, int y, char c) {
+  fontDesc_t const *font = getSystemFont();
+
+  if (c == ' ') {
+    return x + font->widthInPixel * 4 / 10;
+  }
+
+  unsigned char cu = (unsigned char)c;
+  if (cu < font->firstChar || cu > font->lastChar) {
+    cu = '?';
+  }
+
+  int firstPixelBitPos = 0;
+  for (int i = 0; i < (cu - font->firstChar); i++) {
+    firstPixelBitPos = firstPixelBitPos + font->pData[i];
+  }
+  firstPixelBitPos = firstPixelBitPos * font->heightInPixel;
+
+  unsigned char const *pDataStart   = &(font->pData[font->lastChar - font->firstChar + 1]);
+  const int            top          = y;
+  const int            widthInPixel = font->pData[cu - font->firstChar];
+  for (int i = 0; i < widthInPixel * font->heightInPixel; i++) {
+    int bytePos = firstPixelBitPos / 8;
+    int bitPos  = firstPixelBitPos % 8;
+
+    if (pDataStart[bytePos] & (1 << bitPos)) {
+      bitmap.setPixel(x, y);
+    } else {
+      bitmap.clearPixel(x, y);
+    }
+
+    firstPixelBitPos++;
+    y++;
+    if (y == top + font->heightInPixel) {
+      y = top;
+      x++;
+    }
+  }
+
+  return x + FONT_CHAR_SPACING;
+}
+
+static int drawStringLinear(Bitmap &bitmap, int x, int y, const String &text) {
+  int next_x = x;
+  for (size_t i = 0; i < text.length(); i++) {
+    next_x = drawCharLinear(bitmap, next_x, y, text[i]);
+  }
+  return next_x;
+}
+
+static int drawStringLFLinear(Bitmap &bitmap, int x, int y, const String &text) {
+  fontDesc_t const *font   = getSystemFont();
+  int               next_x = x;
+  for (size_t i = 0; i < text.length(); i++) {
+    if (next_x + font->widthInPixel > WIDTH) {
+      next_x = 0;
+      y += font->heightInPixel;
+    }
+    next_x = drawCharLinear(bitmap, next_x, y, text[i]);
+  }
+  return next_x;
+}
+
+// the status page: one line per task
+static const char *const STATUS_LINES[] = {
+    "Radiolib: rx 433.775 MHz", "Router: 12 digi / 48 is", "AprsIs: connected", "MQTT: 3 spooled", "Beacon: in 12 min", "Wifi: -67 dBm", "NTP: 12:34:56", "Display: OE5BPA-10",
+};
+
+// a packet frame: header and the wrapped packet, off the page grid on purpose
+static const char *const PACKET = "OE5BPA-7>APLRT1,WIDE1-1,qAO,OE5BPA-10:!4812.34N/01410.12E>Mobile station, QTH Linz, 145.500 MHz {123";
+
+class Result {
+public:
+  Result() : nanos(0), checksum(0) {
+  }
+
+  uint64_t nanos;
+  uint32_t checksum;
+};
+
+static uint32_t checksum(const Bitmap &bitmap) {
+  uint32_t sum = 2166136261u;
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      sum = (sum ^ (bitmap.getPixel(x, y) ? 1 : 0)) * 16777619u;
+    }
+  }
+  return sum;
+}
+
+static Result runStatus(unsigned screens, bool linear) {
+  Bitmap bitmap(WIDTH, HEIGHT);
+  Result result;
+  for (unsigned n = 0; n < screens; n++) {
+    bitmap.clear();
+    const uint64_t start = nowNanos();
+    int            y     = 0;
+    for (const char *line : STATUS_LINES) {
+      linear ? drawStringLinear(bitmap, 0, y, line) : bitmap.drawString(0, y, line);
+      y += getSystemFont()->heightInPixel;
+    }
+    result.nanos += nowNanos() - start;
+  }
+  result.checksum = checksum(bitmap);
+  return result;
+}
+
+static Result runPacket(unsigned screens, bool linear) {
+  Bitmap bitmap(WIDTH, HEIGHT);
+  Result result;
+  for (unsigned n = 0; n < screens; n++) {
+    bitmap.clear();
+    const uint64_t start = nowNanos();
+    linear ? drawStringLinear(bitmap, 0, 0, "LoRa") : bitmap.drawString(0, 0, "LoRa");
+    linear ? drawStringLFLinear(bitmap, 0, 10, PACKET) : bitmap.drawStringLF(0, 10, PACKET);
+    result.nanos += nowNanos() - start;
+  }
+  result.checksum = checksum(bitmap);
+  return result;
+}
+
+static bool print(const char *label, const char *function, unsigned screens, const Result &before, const Result &after) {
+  const bool same = before.checksum == after.checksum;
+  printf("{\"label\":\"%s\",\"function\":\"%s\",\"screens\":%u,\"linear_us_per_screen\":%.2f,\"table_us_per_screen\":%.2f,\"speedup\":%.2f,\"identical\":%s}\n", label, function, screens, before.nanos / 1000.0 / screens, after.nanos / 1000.0 / screens, after.nanos > 0 ? (double)before.nanos / after.nanos : 0, same ? "true" : "false");
+  return same;
+}
+
+int main(int argc, char **argv) {
+  unsigned    screens = 20000;
+  const char *label   = "";
+  int         option;
+  while ((option = getopt(argc, argv, "n:l:")) != -1) {
+    switch (option) {
+    case 'n':
+      screens = strtoul(optarg, 0, 10);
+      break;
+    case 'l':
+      label = optarg;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-n SCREENS] [-l LABEL]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (screens == 0) {
+    screens = 1;
+  }
+
+  bool ok = print(label, "drawString", screens, runStatus(screens, true), runStatus(screens, false));
+  ok      = print(label, "drawStringLF", screens, runPacket(screens, true), runPacket(screens, false)) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+// Runs the packet path of the iGate on the host against a packet trace (see
+// LoRa/PacketTrace.h): simulated radio -> router -> TX queue with duty cycle
+// and channel access -> simulated radio. Time is virtual and jumps from one
+// event to the next, so an hour of trace takes milliseconds. Packets for
+// APRS-IS are written to stdout, statistics to stderr.
+//
+//   pio run -e native_replay
+//   .pio/build/native_replay/program [-c CALL] [-d] [-v] trace.txt
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "LoRa/ChannelAccess.h"
+#include "LoRa/DutyCycle.h"
+#include "LoRa/SimulatedRadio.h"
+#include "LoRa/TxQueue.h"
+#include "Packet/Router.h"
+#include "Packet/RxStats.h"
+
+class Replay {
+public:
+  Replay() : _router(_toModem, _toAprsIs, _toMQTT), _verbose(false), _now(0), _notBefore(0), _transmitting(false), _uplinked(0), _expired(0), _delayed(0) {
+  }
+
+  bool load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+      return false;
+    }
+    char   buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      _text.insert(_text.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return true;
+  }
+
+  void setup(const char *callsign, bool digi, bool verbose) {
+    _verbose = verbose;
+    _router.setCallsign(callsign);
+    _router.setUplink(true);
+    _router.setDigi(digi);
+    _router.getIsGate().setModulation(_modulation);
+    _dutyCycle.setLimit(100, 60 * 60 * 1000, _now);
+    const uint32_t slotTime = LoRaAirtime::preambleMicros(_modulation) / 1000;
+    _channelAccess.setSlotTime(slotTime);
+    _channelAccess.setPersistence(50);
+    _toModem.setDigiSlots(0, slotTime);
+    _radio.begin(_text.data(), _text.size(), _modulation, _now);
+    _radio.startReceive(_now);
+  }
+
+  // one event, false once the trace is done and nothing is left to send
+  bool step() {
+    uint32_t next;
+    if (!nextEvent(next)) {
+      return false;
+    }
+    if ((int32_t)(next - _now) > 0) {
+      _now = next;
+    }
+
+    uint32_t interrupt;
+    if (_radio.getNextInterrupt(interrupt) && (int32_t)(_now - interrupt) >= 0) {
+      handleInterrupt();
+    }
+    while (!_toAprsIs.empty()) {
+      std::shared_ptr<AprsPacket> packet = _toAprsIs.getElement();
+      char                        line[AprsPacket::MAX_LENGTH + 32];
+      packet->encode(line, sizeof(line), _router.getDigipeater().getCallsign());
+      printf("%u %s\n", _now, line);
+      _uplinked++;
+    }
+    while (!_fromAprsIs.empty()) {
+      std::shared_ptr<AprsPacket> rfPacket;
+      _router.fromAprsIs(_fromAprsIs.getElement(), _now, rfPacket);
+    }
+    _router.release(_now);
+    handleTx();
+    return true;
+  }
+
+  void report(double wallSeconds) const {
+    fprintf(stderr, "virtual time:  %.1f s in %.3f s (%.0fx real time)\n", _now / 1000.0, wallSeconds, wallSeconds > 0 ? _now / 1000.0 / wallSeconds : 0);
+    fprintf(stderr, "received:      %u okay, %u CRC errors, %u header errors, %u missed\n", _rxStats.getCount(RxOkay), _rxStats.getCount(RxCrcError), _rxStats.getCount(RxHeaderError), _radio.getMissed());
+    fprintf(stderr, "link:          RSSI %.1f/%.1f/%.1f dBm, SNR %.1f/%.1f/%.1f dB (min/avg/max)\n", _rxStats.getRssiMin(), _rxStats.getRssiAverage(), _rxStats.getRssiMax(), _rxStats.getSnrMin(), _rxStats.getSnrAverage(), _rxStats.getSnrMax());
+    fprintf(stderr, "uplink:        %u forwarded, %u duplicates\n", _uplinked, _router.getDedupeCache().getHits(DedupeIGate));
+    fprintf(stderr, "transmitted:   %u packets, %u ms airtime, %u expired, %u delayed by duty cycle\n", _radio.getTransmitted(), _radio.getTransmittedAirtime(), _expired, _delayed);
+    fprintf(stderr, "trace:         %u lines, %u malformed\n", _radio.getTrace().getLineNumber(), _radio.getTrace().getErrors());
+  }
+
+private:
+  std::vector<char>                      _text;
+  LoRaModulation                         _modulation;
+  SimulatedRadio                         _radio;
+  TxQueue                                _toModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> _toAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> _fromAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> _toMQTT;
+  Router                                 _router;
+  DutyCycle                              _dutyCycle;
+  ChannelAccess                          _channelAccess;
+  RxStats                                _rxStats;
+  TxQueue::Entry                         _pending;
+  bool                                   _verbose;
+  uint32_t                               _now;
+  uint32_t                               _notBefore;
+  bool                                   _transmitting;
+  uint32_t                               _uplinked;
+  uint32_t                               _expired;
+  uint32_t                               _delayed;
+
+  bool nextEvent(uint32_t &next) const {
+    bool     found = false;
+    uint32_t time;
+    if (_radio.getNextInterrupt(time)) {
+      next  = time;
+      found = true;
+    }
+    if (_router.getDeadline() != 0) {
+      time = _router.getDeadline();
+      if (!found || (int32_t)(time - next) < 0) {
+        next  = time;
+        found = true;
+      }
+    }
+    if (_radio.getState() == SimulatedReceiving && (_pending.packet || !_toModem.empty())) {
+      time = _pending.packet ? _notBefore : _toModem.getNextDue(_now);
+      if (!found || (int32_t)(time - next) < 0) {
+        next  = time;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  void handleInterrupt() {
+    switch (_radio.getState()) {
+    case SimulatedTransmitting:
+      _transmitting = false;
+      _radio.startReceive(_now);
+      break;
+    case SimulatedScanning:
+      if (_channelAccess.scanned(_radio.isChannelBusy(), _now)) {
+        transmit();
+      } else {
+        _notBefore = _channelAccess.getNotBefore();
+        _radio.startReceive(_now);
+      }
+      break;
+    case SimulatedReceiving: {
+      std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+      RxMetadata                  rx;
+      const size_t                length = _radio.readData(packet->getRawBuffer(), AprsPacket::getRawCapacity(), rx);
+      rx.timestamp                       = _now * 1000;
+      _rxStats.add(rx);
+      if (rx.status != RxOkay || !packet->decodeRaw(length)) {
+        break;
+      }
+      packet->setOrigin(OriginRf);
+      packet->setRxMetadata(rx);
+      const RfRoute route = _router.fromRf(packet, _now);
+      if (_verbose) {
+        fprintf(stderr, "%u RX %s (uplink %d, digi %d)\n", _now, packet->c_str(), route.uplink, route.digi);
+      }
+      break;
+    }
+    case SimulatedIdle:
+      break;
+    }
+  }
+
+  void handleTx() {
+    if (_radio.getState() != SimulatedReceiving || _radio.isSignalDetected(_now)) {
+      return;
+    }
+    if (!_pending.packet) {
+      TxQueueResult result;
+      while ((result = _toModem.pop(_pending, _now)) == TxQueueExpired) {
+        _expired++;
+      }
+      if (result != TxQueueReady) {
+        _pending.packet.reset();
+        return;
+      }
+      _notBefore = _now;
+      _channelAccess.start(_now);
+    }
+    if ((int32_t)(_now - _notBefore) < 0) {
+      return;
+    }
+    const uint32_t airtime = LoRaAirtime::packetMillis(_modulation, _pending.packet->getRawLength());
+    const uint32_t delay   = _dutyCycle.getDelay(airtime, _now);
+    if (delay == DutyCycle::NEVER) {
+      _pending.packet.reset();
+      _channelAccess.reset();
+      return;
+    }
+    if (delay > 0) {
+      _delayed++;
+      _notBefore = _now + delay;
+      return;
+    }
+    _radio.startChannelScan(_now);
+  }
+
+  void transmit() {
+    const size_t length = _pending.packet->getRawLength();
+    if (_verbose) {
+      fprintf(stderr, "%u TX %s (%s, waited %u ms)\n", _now, _pending.packet->c_str(), TxQueue::toString(_pending.txClass), _now - _pending.queuedAt);
+    }
+    _dutyCycle.record(LoRaAirtime::packetMillis(_modulation, length), _now);
+    _radio.startTransmit(length, _now);
+    _transmitting = true;
+    _pending.packet.reset();
+    _channelAccess.reset();
+  }
+};
+
+int main(int argc, char **argv) {
+  const char *callsign = "NOCALL-10";
+  bool        digi     = false;
+  bool        verbose  = false;
+  int         option;
+  while ((option = getopt(argc, argv, "c:dv")) != -1) {
+    switch (option) {
+    case 'c':
+      callsign = optarg;
+      break;
+    case 'd':
+      digi = true;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-c CALL] [-d] [-v] trace.txt\n", argv[0]);
+      return 2;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-c CALL] [-d] [-v] trace.txt\n", argv[0]);
+    return 2;
+  }
+
+  AprsPacket::getPool().begin(64);
+  static Replay replay;
+  if (!replay.load(argv[optind])) {
+    fprintf(stderr, "can not read %s\n", argv[optind]);
+    return 1;
+  }
+  replay.setup(callsign, digi, verbose);
+
+  const auto start = std::chrono::steady_clock::now();
+  while (replay.step()) {
+  }
+  const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+  replay.report(wall.count());
+  return 0;
+}
@@ -0,0 +1,230 @@
+#include <string.h>
+
+#include "AprsPacket.h"
+
+static const uint8_t LORA_APRS_HEADER[AprsPacket::HEADER_LENGTH] = {'<', 0xff, 0x01};
+
+static MemoryPool packetPool("AprsPacket", sizeof(AprsPacket) + MemoryPool::SHARED_OVERHEAD);
+
+bool PacketView::empty() const {
+  return length == 0;
+}
+
+bool PacketView::equals(const char *str) const {
+  return equals(str, strlen(str));
+}
+
+bool PacketView::equals(const char *str, size_t strLength) const {
+  return length == strLength && memcmp(data, str, length) == 0;
+}
+
+int PacketView::indexOf(const char *str) const {
+  const size_t strLength = strlen(str);
+  if (strLength == 0) {
+    return 0;
+  }
+  for (size_t i = 0; i + strLength <= length; i++) {
+    if (data[i] == str[0] && memcmp(data + i, str, strLength) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool PacketView::contains(const char *str) const {
+  return indexOf(str) != -1;
+}
+
+size_t PacketView::copyTo(char *out, size_t size) const {
+  if (size == 0) {
+    return 0;
+  }
+  const size_t n = length < size - 1 ? length : size - 1;
+  memcpy(out, data, n);
+  out[n] = 0;
+  return n;
+}
+
+AprsPacket::AprsPacket() : _length(0), _sourceLength(0), _destinationLength(0), _pathOffset(0), _pathLength(0), _bodyOffset(0), _origin(OriginLocal) {
+  memcpy(_raw, LORA_APRS_HEADER, HEADER_LENGTH);
+  _raw[HEADER_LENGTH] = 0;
+}
+
+std::shared_ptr<AprsPacket> AprsPacket::create() {
+  return std::allocate_shared<AprsPacket>(PoolAllocator<AprsPacket>(packetPool));
+}
+
+std::shared_ptr<AprsPacket> AprsPacket::create(const AprsPacket &other) {
+  return std::allocate_shared<AprsPacket>(PoolAllocator<AprsPacket>(packetPool), other);
+}
+
+MemoryPool &AprsPacket::getPool() {
+  return packetPool;
+}
+
+uint8_t *AprsPacket::getRawBuffer() {
+  return _raw;
+}
+
+size_t AprsPacket::getRawCapacity() {
+  return HEADER_LENGTH + MAX_LENGTH;
+}
+
+bool AprsPacket::decodeRaw(size_t rawLength) {
+  if (rawLength < HEADER_LENGTH || rawLength > getRawCapacity() || memcmp(_raw, LORA_APRS_HEADER, HEADER_LENGTH) != 0) {
+    _length = 0;
+    return false;
+  }
+  _length         = rawLength - HEADER_LENGTH;
+  text()[_length] = 0;
+  return parse();
+}
+
+bool AprsPacket::decode(const char *line, size_t length) {
+  while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == '\n')) {
+    length--;
+  }
+  if (length > MAX_LENGTH) {
+    _length = 0;
+    return false;
+  }
+  memcpy(_raw, LORA_APRS_HEADER, HEADER_LENGTH);
+  memcpy(text(), line, length);
+  _length         = length;
+  text()[_length] = 0;
+  return parse();
+}
+
+bool AprsPacket::decode(const char *line) {
+  return decode(line, strlen(line));
+}
+
+const uint8_t *AprsPacket::getRawData() const {
+  return _raw;
+}
+
+size_t AprsPacket::getRawLength() const {
+  return HEADER_LENGTH + _length;
+}
+
+const char *AprsPacket::c_str() const {
+  return text();
+}
+
+size_t AprsPacket::length() const {
+  return _length;
+}
+
+PacketView AprsPacket::getSource() const {
+  return PacketView(text(), _sourceLength);
+}
+
+PacketView AprsPacket::getDestination() const {
+  return PacketView(text() + _sourceLength + 1, _destinationLength);
+}
+
+PacketView AprsPacket::getPath() const {
+  return PacketView(text() + _pathOffset, _pathLength);
+}
+
+PacketView AprsPacket::getBody() const {
+  return PacketView(text() + _bodyOffset, _length - _bodyOffset);
+}
+
+bool AprsPacket::setPath(const char *path, size_t length) {
+  // path goes between destination and ':', with a leading ',' if not empty
+  const size_t headerEnd    = _sourceLength + 1 + _destinationLength;
+  const size_t newPathField = length == 0 ? 0 : length + 1;
+  const size_t bodyLength   = _length - _bodyOffset;
+  const size_t newLength    = headerEnd + newPathField + 1 + bodyLength;
+  if (newLength > MAX_LENGTH) {
+    return false;
+  }
+  const size_t newBodyOffset = headerEnd + newPathField + 1;
+  memmove(text() + newBodyOffset, text() + _bodyOffset, bodyLength);
+  if (length != 0) {
+    text()[headerEnd] = ',';
+    memmove(text() + headerEnd + 1, path, length);
+  }
+  text()[newBodyOffset - 1] = ':';
+  _length                   = newLength;
+  text()[_length]           = 0;
+  _pathOffset               = length == 0 ? headerEnd : headerEnd + 1;
+  _pathLength               = length;
+  _bodyOffset               = newBodyOffset;
+  return true;
+}
+
+size_t AprsPacket::encode(char *out, size_t size, const char *gateway) const {
+  const size_t headerEnd = _sourceLength + 1 + _destinationLength + (_pathLength == 0 ? 0 : _pathLength + 1);
+  const size_t bodyStart = _bodyOffset - 1;
+  size_t       n         = 0;
+  if (gateway == 0) {
+    if ((size_t)_length + 1 > size) {
+      return 0;
+    }
+    memcpy(out, text(), _length);
+    n = _length;
+  } else {
+    const size_t gatewayLength = strlen(gateway);
+    if ((size_t)_length + 5 + gatewayLength + 1 > size) {
+      return 0;
+    }
+    memcpy(out, text(), headerEnd);
+    n = headerEnd;
+    memcpy(out + n, ",qAO,", 5);
+    n += 5;
+    memcpy(out + n, gateway, gatewayLength);
+    n += gatewayLength;
+    memcpy(out + n, text() + bodyStart, _length - bodyStart);
+    n += _length - bodyStart;
+  }
+  out[n] = 0;
+  return n;
+}
+
+PacketOrigin AprsPacket::getOrigin() const {
+  return _origin;
+}
+
+void AprsPacket::setOrigin(PacketOrigin origin) {
+  _origin = origin;
+}
+
+const RxMetadata &AprsPacket::getRxMetadata() const {
+  return _rx;
+}
+
+void AprsPacket::setRxMetadata(const RxMetadata &rx) {
+  _rx = rx;
+}
+
+char *AprsPacket::text() {
+  return (char *)_raw + HEADER_LENGTH;
+}
+
+const char *AprsPacket::text() const {
+  return (const char *)_raw + HEADER_LENGTH;
+}
+
+bool AprsPacket::parse() {
+  const char *line  = text();
+  const char *gt    = (const char *)memchr(line, '>', _length);
+  const char *colon = gt == 0 ? 0 : (const char *)memchr(gt, ':', _length - (gt - line));
+  if (gt == 0 || colon == 0 || gt == line || gt - line > 255) {
+    _length = 0;
+    return false;
+  }
+  const char *comma  = (const char *)memchr(gt, ',', colon - gt);
+  const char *dstEnd = comma == 0 ? colon : comma;
+  if (dstEnd - gt - 1 > 255) {
+    _length = 0;
+    return false;
+  }
+  _sourceLength      = gt - line;
+  _destinationLength = dstEnd - gt - 1;
+  _pathOffset        = comma == 0 ? dstEnd - line : comma + 1 - line;
+  _pathLength        = comma == 0 ? 0 : colon - comma - 1;
+  _bodyOffset        = colon + 1 - line;
+  return true;
+}
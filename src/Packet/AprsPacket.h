@@ -0,0 +1,123 @@
+#ifndef APRS_PACKET_H_
+#define APRS_PACKET_H_
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "System/MemoryPool.h"
+
+// Non-owning view into a packet buffer, not NUL terminated.
+class PacketView {
+public:
+  PacketView() : data(0), length(0) {
+  }
+  PacketView(const char *data, size_t length) : data(data), length(length) {
+  }
+
+  bool   empty() const;
+  bool   equals(const char *str) const;
+  bool   equals(const char *str, size_t strLength) const;
+  int    indexOf(const char *str) const;
+  bool   contains(const char *str) const;
+  size_t copyTo(char *out, size_t size) const;
+
+  const char *data;
+  size_t      length;
+};
+
+enum PacketOrigin {
+  OriginLocal,
+  OriginRf,
+  OriginAprsIs,
+};
+
+enum RxStatus {
+  RxOkay,
+  RxCrcError,    // payload CRC mismatch
+  RxHeaderError, // explicit header damaged
+  RxStatusCount,
+};
+
+// Link quality of a packet received on RF, read from the modem right after
+// RX done. Only meaningful for packets with OriginRf.
+class RxMetadata {
+public:
+  RxMetadata() : rssi(0), snr(0), frequencyError(0), timestamp(0), status(RxOkay) {
+  }
+
+  float    rssi;           // dBm
+  float    snr;            // dB
+  float    frequencyError; // Hz
+  uint32_t timestamp;      // micros() of the RX done interrupt
+  RxStatus status;
+};
+
+// One APRS packet in TNC2 format ("SRC>DEST,PATH:body") in a fixed-size
+// buffer. The three byte LoRa APRS header is kept in front of the text, so
+// the modem can read into and transmit straight from this buffer. Source,
+// destination, path and body are offsets into the text; packets are passed
+// between tasks by std::shared_ptr without ever being copied into Strings.
+class AprsPacket {
+public:
+  static const size_t HEADER_LENGTH = 3;
+  static const size_t MAX_LENGTH    = 255 - HEADER_LENGTH;
+
+  AprsPacket();
+
+  // packets are taken from a pool, object and reference count in one block
+  static std::shared_ptr<AprsPacket> create();
+  static std::shared_ptr<AprsPacket> create(const AprsPacket &other);
+  static MemoryPool                 &getPool();
+
+  // fill via getRawBuffer() (header and text), then decode rawLength bytes in place
+  uint8_t      *getRawBuffer();
+  static size_t getRawCapacity();
+  bool          decodeRaw(size_t rawLength);
+
+  // copy a TNC2 line without the LoRa header, trailing CR/LF are ignored
+  bool decode(const char *line, size_t length);
+  bool decode(const char *line);
+
+  // header and text as it goes over the air
+  const uint8_t *getRawData() const;
+  size_t         getRawLength() const;
+
+  // the TNC2 text, NUL terminated
+  const char *c_str() const;
+  size_t      length() const;
+
+  PacketView getSource() const;
+  PacketView getDestination() const;
+  PacketView getPath() const;
+  PacketView getBody() const;
+
+  // rewrite the path in place, false if the packet would not fit anymore
+  bool setPath(const char *path, size_t length);
+
+  // write the TNC2 line to out (NUL terminated), with ",qAO,<gateway>" appended to the path if gateway is given
+  size_t encode(char *out, size_t size, const char *gateway = 0) const;
+
+  PacketOrigin getOrigin() const;
+  void         setOrigin(PacketOrigin origin);
+
+  const RxMetadata &getRxMetadata() const;
+  void              setRxMetadata(const RxMetadata &rx);
+
+private:
+  uint8_t      _raw[HEADER_LENGTH + MAX_LENGTH + 1];
+  uint16_t     _length;
+  uint8_t      _sourceLength;
+  uint8_t      _destinationLength;
+  uint16_t     _pathOffset;
+  uint16_t     _pathLength;
+  uint16_t     _bodyOffset;
+  PacketOrigin _origin;
+  RxMetadata   _rx;
+
+  char       *text();
+  const char *text() const;
+  bool        parse();
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include <string.h>
+
+#include "DedupeCache.h"
+
+static uint32_t fnv1a(uint32_t hash, const char *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+DedupeCache::DedupeCache(uint32_t windowMs) : _windowMs(windowMs) {
+  clear();
+}
+
+void DedupeCache::setWindow(uint32_t windowMs) {
+  _windowMs = windowMs;
+}
+
+uint32_t DedupeCache::getWindow() const {
+  return _windowMs;
+}
+
+bool DedupeCache::isDuplicate(const AprsPacket &packet, DedupePath path, uint32_t now) {
+  return isDuplicate(hashOf(packet), path, now);
+}
+
+bool DedupeCache::isDuplicate(uint32_t hash, DedupePath path, uint32_t now) {
+  const uint8_t bit    = 1 << path;
+  Entry        *unused = 0;
+  Entry        *oldest = 0;
+
+  if (hash == 0) {
+    hash = 1;
+  }
+
+  for (size_t i = 0; i < PROBE_LENGTH; i++) {
+    Entry &entry = _entries[(hash + i) & (SLOTS - 1)];
+    if (entry.hash == hash) {
+      if (isFresh(entry, path, now)) {
+        _hits[path]++;
+        return true;
+      }
+      entry.paths |= bit;
+      entry.sent[path] = now;
+      _misses[path]++;
+      return false;
+    }
+    // keep probing, the packet may still be further down
+    if (unused == 0 && (entry.hash == 0 || now - lastSent(entry) >= _windowMs)) {
+      unused = &entry;
+    }
+    if (oldest == 0 || now - lastSent(entry) > now - lastSent(*oldest)) {
+      oldest = &entry;
+    }
+  }
+
+  if (unused == 0) {
+    unused = oldest;
+    _evictions++;
+  }
+  unused->hash       = hash;
+  unused->paths      = bit;
+  unused->sent[path] = now;
+  _misses[path]++;
+  return false;
+}
+
+void DedupeCache::clear() {
+  memset(_entries, 0, sizeof(_entries));
+  memset(_hits, 0, sizeof(_hits));
+  memset(_misses, 0, sizeof(_misses));
+  _evictions = 0;
+}
+
+uint32_t DedupeCache::getHits(DedupePath path) const {
+  return _hits[path];
+}
+
+uint32_t DedupeCache::getMisses(DedupePath path) const {
+  return _misses[path];
+}
+
+uint32_t DedupeCache::getEvictions() const {
+  return _evictions;
+}
+
+uint32_t DedupeCache::hashOf(const AprsPacket &packet) {
+  const PacketView source      = packet.getSource();
+  const PacketView destination = packet.getDestination();
+  const PacketView body        = packet.getBody();
+
+  uint32_t hash = 2166136261u;
+  hash          = fnv1a(hash, source.data, source.length);
+  hash          = fnv1a(hash, ">", 1);
+  hash          = fnv1a(hash, destination.data, destination.length);
+  hash          = fnv1a(hash, ":", 1);
+  hash          = fnv1a(hash, body.data, body.length);
+  return hash == 0 ? 1 : hash;
+}
+
+bool DedupeCache::isFresh(const Entry &entry, DedupePath path, uint32_t now) const {
+  return (entry.paths & (1 << path)) && now - entry.sent[path] < _windowMs;
+}
+
+uint32_t DedupeCache::lastSent(const Entry &entry) const {
+  uint32_t last  = 0;
+  bool     found = false;
+  for (size_t path = 0; path < DedupePathCount; path++) {
+    if ((entry.paths & (1 << path)) && (!found || (int32_t)(entry.sent[path] - last) > 0)) {
+      last  = entry.sent[path];
+      found = true;
+    }
+  }
+  return last;
+}
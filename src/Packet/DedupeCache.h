@@ -0,0 +1,63 @@
+#ifndef DEDUPE_CACHE_H_
+#define DEDUPE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AprsPacket.h"
+
+// The paths a packet can be forwarded to, each one decides on its own.
+enum DedupePath {
+  DedupeIGate,
+  DedupeDigi,
+  DedupePathCount,
+};
+
+// Remembers which packets were forwarded during the last window (30 s by
+// default), keyed by a hash of source, destination and body. The path is
+// left out, so copies relayed by other digipeaters are recognised.
+//
+// Entries live in a fixed open addressing table with a bounded probe
+// length: every lookup is O(1) and nothing is allocated after construction.
+// When all probed slots are in use, the oldest of them is overwritten.
+class DedupeCache {
+public:
+  static const size_t SLOTS        = 64;
+  static const size_t PROBE_LENGTH = 8;
+
+  explicit DedupeCache(uint32_t windowMs = 30000);
+
+  void     setWindow(uint32_t windowMs);
+  uint32_t getWindow() const;
+
+  // true if the packet already went this path within the window, otherwise it is recorded as sent now
+  bool isDuplicate(const AprsPacket &packet, DedupePath path, uint32_t now);
+  bool isDuplicate(uint32_t hash, DedupePath path, uint32_t now);
+
+  void clear();
+
+  uint32_t getHits(DedupePath path) const;
+  uint32_t getMisses(DedupePath path) const;
+  uint32_t getEvictions() const;
+
+  static uint32_t hashOf(const AprsPacket &packet);
+
+private:
+  class Entry {
+  public:
+    uint32_t hash; // 0: never used
+    uint8_t  paths;
+    uint32_t sent[DedupePathCount];
+  };
+
+  Entry    _entries[SLOTS];
+  uint32_t _windowMs;
+  uint32_t _hits[DedupePathCount];
+  uint32_t _misses[DedupePathCount];
+  uint32_t _evictions;
+
+  bool     isFresh(const Entry &entry, DedupePath path, uint32_t now) const;
+  uint32_t lastSent(const Entry &entry) const;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Digipeater.h"
+
+Digipeater::Digipeater() : _aliasCount(0), _maxHops(1) {
+  _callsign[0] = 0;
+}
+
+void Digipeater::setCallsign(const char *callsign) {
+  snprintf(_callsign, sizeof(_callsign), "%s", callsign);
+}
+
+const char *Digipeater::getCallsign() const {
+  return _callsign;
+}
+
+bool Digipeater::addAlias(const char *alias) {
+  if (_aliasCount >= MAX_ALIASES || strlen(alias) == 0 || strlen(alias) > CALL_LENGTH) {
+    return false;
+  }
+  strcpy(_aliases[_aliasCount++], alias);
+  return true;
+}
+
+void Digipeater::clearAliases() {
+  _aliasCount = 0;
+}
+
+void Digipeater::setMaxHops(uint8_t maxHops) {
+  _maxHops = maxHops;
+}
+
+uint8_t Digipeater::getMaxHops() const {
+  return _maxHops;
+}
+
+DigiResult Digipeater::decide(const AprsPacket &packet, char *path, size_t size, size_t &length) const {
+  Hop    hops[MAX_HOPS];
+  size_t count = 0;
+  if (_callsign[0] == 0 || !parsePath(packet.getPath(), hops, count)) {
+    return DigiInvalidPath;
+  }
+
+  size_t next = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (hops[i].used) {
+      if (strcmp(hops[i].name, _callsign) == 0) {
+        return DigiLoop;
+      }
+      next = i + 1;
+    }
+  }
+  if (next >= count) {
+    return DigiNotForUs;
+  }
+
+  Hop       &hop = hops[next];
+  DigiResult result;
+  uint8_t    n;
+  uint8_t    remaining;
+  if (strcmp(hop.name, _callsign) == 0) {
+    hop.used = true;
+    result   = DigiDirect;
+  } else if (isAlias(hop.name)) {
+    strcpy(hop.name, _callsign);
+    hop.used = true;
+    result   = DigiAlias;
+  } else if (parseWide(hop.name, n, remaining)) {
+    if (n > _maxHops || remaining > n) {
+      return DigiHopLimit;
+    }
+    // "WIDEn-N" in place: "WIDEn-(N-1)", or the used "WIDEn" after the last hop
+    remaining--;
+    if (remaining == 0) {
+      hop.name[5] = 0;
+      hop.used    = true;
+    } else {
+      hop.name[6] = '0' + remaining;
+    }
+    // our call goes in front of it, as long as there is room for another hop
+    if (count < MAX_HOPS) {
+      memmove(&hops[next + 1], &hops[next], (count - next) * sizeof(Hop));
+      strcpy(hops[next].name, _callsign);
+      hops[next].used = true;
+      count++;
+    }
+    result = DigiWide;
+  } else {
+    return DigiNotForUs;
+  }
+
+  length = encodePath(hops, count, path, size);
+  return length == 0 ? DigiInvalidPath : result;
+}
+
+bool Digipeater::shouldRepeat(DigiResult result) {
+  return result == DigiDirect || result == DigiAlias || result == DigiWide;
+}
+
+const char *Digipeater::toString(DigiResult result) {
+  switch (result) {
+  case DigiNotForUs:
+    return "not for us";
+  case DigiLoop:
+    return "loop";
+  case DigiHopLimit:
+    return "hop limit";
+  case DigiInvalidPath:
+    return "invalid path";
+  case DigiDirect:
+    return "direct";
+  case DigiAlias:
+    return "alias";
+  case DigiWide:
+    return "WIDEn-N";
+  }
+  return "";
+}
+
+bool Digipeater::isAlias(const char *name) const {
+  for (size_t i = 0; i < _aliasCount; i++) {
+    if (strcmp(name, _aliases[i]) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Digipeater::parsePath(const PacketView &path, Hop *hops, size_t &count) {
+  count           = 0;
+  size_t lastUsed = 0;
+  bool   anyUsed  = false;
+  size_t start    = 0;
+  while (start < path.length) {
+    size_t end = start;
+    while (end < path.length && path.data[end] != ',') {
+      end++;
+    }
+    size_t nameLength = end - start;
+    bool   used       = nameLength > 0 && path.data[end - 1] == '*';
+    if (used) {
+      nameLength--;
+    }
+    if (count >= MAX_HOPS || nameLength == 0 || nameLength > CALL_LENGTH) {
+      return false;
+    }
+    memcpy(hops[count].name, path.data + start, nameLength);
+    hops[count].name[nameLength] = 0;
+    hops[count].used             = used;
+    if (used) {
+      lastUsed = count;
+      anyUsed  = true;
+    }
+    count++;
+    start = end + 1;
+  }
+  // '*' is only set on the last used hop
+  for (size_t i = 0; anyUsed && i < lastUsed; i++) {
+    hops[i].used = true;
+  }
+  return true;
+}
+
+size_t Digipeater::encodePath(const Hop *hops, size_t count, char *path, size_t size) {
+  size_t lastUsed = count;
+  for (size_t i = 0; i < count; i++) {
+    if (hops[i].used) {
+      lastUsed = i;
+    }
+  }
+  size_t length = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t nameLength = strlen(hops[i].name);
+    const size_t needed     = (i == 0 ? 0 : 1) + nameLength + (i == lastUsed ? 1 : 0);
+    if (length + needed + 1 > size) {
+      return 0;
+    }
+    if (i != 0) {
+      path[length++] = ',';
+    }
+    memcpy(path + length, hops[i].name, nameLength);
+    length += nameLength;
+    if (i == lastUsed) {
+      path[length++] = '*';
+    }
+  }
+  path[length] = 0;
+  return length;
+}
+
+bool Digipeater::parseWide(const char *name, uint8_t &n, uint8_t &remaining) {
+  if (strncmp(name, "WIDE", 4) != 0 || name[4] < '1' || name[4] > '7' || name[5] != '-' || name[6] < '1' || name[6] > '7' || name[7] != 0) {
+    return false;
+  }
+  n         = name[4] - '0';
+  remaining = name[6] - '0';
+  return true;
+}
+
+ViscousQueue::ViscousQueue() : _delayMs(0), _cancelled(0) {
+  for (size_t i = 0; i < SLOTS; i++) {
+    _entries[i].hash = 0;
+    _entries[i].due  = 0;
+  }
+}
+
+void ViscousQueue::setDelay(uint32_t delayMs) {
+  _delayMs = delayMs;
+}
+
+uint32_t ViscousQueue::getDelay() const {
+  return _delayMs;
+}
+
+bool ViscousQueue::hold(std::shared_ptr<AprsPacket> packet, uint32_t hash, uint32_t now) {
+  for (size_t i = 0; i < SLOTS; i++) {
+    if (!_entries[i].packet) {
+      _entries[i].packet = packet;
+      _entries[i].hash   = hash;
+      _entries[i].due    = now + _delayMs;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ViscousQueue::cancel(uint32_t hash) {
+  for (size_t i = 0; i < SLOTS; i++) {
+    if (_entries[i].packet && _entries[i].hash == hash) {
+      _entries[i].packet.reset();
+      _cancelled++;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::shared_ptr<AprsPacket> ViscousQueue::release(uint32_t now) {
+  for (size_t i = 0; i < SLOTS; i++) {
+    if (_entries[i].packet && (int32_t)(now - _entries[i].due) >= 0) {
+      std::shared_ptr<AprsPacket> packet = _entries[i].packet;
+      _entries[i].packet.reset();
+      return packet;
+    }
+  }
+  return std::shared_ptr<AprsPacket>();
+}
+
+uint32_t ViscousQueue::getNextDue() const {
+  bool     found = false;
+  uint32_t next  = 0;
+  for (size_t i = 0; i < SLOTS; i++) {
+    if (_entries[i].packet && (!found || (int32_t)(_entries[i].due - next) < 0)) {
+      next  = _entries[i].due;
+      found = true;
+    }
+  }
+  return found && next == 0 ? 1 : next;
+}
+
+uint32_t ViscousQueue::getCancelled() const {
+  return _cancelled;
+}
@@ -0,0 +1,105 @@
+#ifndef DIGIPEATER_H_
+#define DIGIPEATER_H_
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AprsPacket.h"
+
+enum DigiResult {
+  DigiNotForUs,    // the next unused hop is neither our call, an alias nor WIDEn-N
+  DigiLoop,        // we already repeated this packet
+  DigiHopLimit,    // WIDEn-N asks for more hops than allowed
+  DigiInvalidPath, // path does not parse or the new one would not fit
+  DigiDirect,      // next hop is our call
+  DigiAlias,       // next hop is one of our aliases, replaced by our call
+  DigiWide,        // WIDEn-N, decremented and our call inserted
+};
+
+// Path handling of an APRS digipeater (new-N paradigm). The path is parsed
+// into a small fixed array of hops; '*' marks the last used hop and
+// everything in front of it. Only the first unused hop is looked at:
+//
+//   OURCALL          -> OURCALL*
+//   alias            -> OURCALL*                 (e.g. WIDE1-1 for a fill-in digi)
+//   WIDEn-N, N > 1   -> OURCALL*,WIDEn-(N-1)
+//   WIDEn-1          -> OURCALL,WIDEn*
+//
+// WIDEn-N with n above the configured maximum hops is not repeated.
+class Digipeater {
+public:
+  static const size_t MAX_HOPS    = 8;
+  static const size_t CALL_LENGTH = 9;
+  static const size_t MAX_ALIASES = 4;
+
+  Digipeater();
+
+  void        setCallsign(const char *callsign);
+  const char *getCallsign() const;
+  bool        addAlias(const char *alias);
+  void        clearAliases();
+  void        setMaxHops(uint8_t maxHops);
+  uint8_t     getMaxHops() const;
+
+  // writes the path the repeated packet has to carry into path (NUL terminated) if the result is DigiDirect, DigiAlias or DigiWide
+  DigiResult decide(const AprsPacket &packet, char *path, size_t size, size_t &length) const;
+
+  static bool        shouldRepeat(DigiResult result);
+  static const char *toString(DigiResult result);
+
+private:
+  class Hop {
+  public:
+    char name[CALL_LENGTH + 1];
+    bool used;
+  };
+
+  char    _callsign[CALL_LENGTH + 1];
+  char    _aliases[MAX_ALIASES][CALL_LENGTH + 1];
+  size_t  _aliasCount;
+  uint8_t _maxHops;
+
+  bool isAlias(const char *name) const;
+
+  static bool   parsePath(const PacketView &path, Hop *hops, size_t &count);
+  static size_t encodePath(const Hop *hops, size_t count, char *path, size_t size);
+  static bool   parseWide(const char *name, uint8_t &n, uint8_t &remaining);
+};
+
+// Viscous delay: WIDEn-N and alias repeats are held back for a moment and
+// dropped if another digipeater is heard repeating the same packet first.
+class ViscousQueue {
+public:
+  static const size_t SLOTS = 8;
+
+  ViscousQueue();
+
+  void     setDelay(uint32_t delayMs);
+  uint32_t getDelay() const;
+
+  // false if all slots are taken, the caller should send right away then
+  bool hold(std::shared_ptr<AprsPacket> packet, uint32_t hash, uint32_t now);
+  // true if a held packet with this hash was dropped
+  bool cancel(uint32_t hash);
+  // the next packet whose delay is over, empty if there is none
+  std::shared_ptr<AprsPacket> release(uint32_t now);
+
+  // millis() when the next packet is due, 0 if nothing is held
+  uint32_t getNextDue() const;
+  uint32_t getCancelled() const;
+
+private:
+  class Entry {
+  public:
+    std::shared_ptr<AprsPacket> packet;
+    uint32_t                    hash;
+    uint32_t                    due;
+  };
+
+  Entry    _entries[SLOTS];
+  uint32_t _delayMs;
+  uint32_t _cancelled;
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "IsGate.h"
+
+HeardList::HeardList(uint32_t windowMs) : _windowMs(windowMs) {
+  clear();
+}
+
+void HeardList::setWindow(uint32_t windowMs) {
+  _windowMs = windowMs;
+}
+
+uint32_t HeardList::getWindow() const {
+  return _windowMs;
+}
+
+void HeardList::heard(const PacketView &callsign, uint32_t now) {
+  if (callsign.empty() || callsign.length >= CALLSIGN_LENGTH) {
+    return;
+  }
+  Entry *entry = (Entry *)find(callsign);
+  if (entry == 0) {
+    for (size_t i = 0; i < SLOTS; i++) {
+      Entry &candidate = _entries[i];
+      if (candidate.callsign[0] == 0) {
+        entry = &candidate;
+        break;
+      }
+      if (entry == 0 || now - candidate.heard > now - entry->heard) {
+        entry = &candidate;
+      }
+    }
+    callsign.copyTo(entry->callsign, sizeof(entry->callsign));
+  }
+  entry->heard = now;
+}
+
+bool HeardList::wasHeard(const PacketView &callsign, uint32_t now) const {
+  const Entry *entry = find(callsign);
+  return entry != 0 && now - entry->heard < _windowMs;
+}
+
+size_t HeardList::size(uint32_t now) const {
+  size_t count = 0;
+  for (size_t i = 0; i < SLOTS; i++) {
+    if (_entries[i].callsign[0] != 0 && now - _entries[i].heard < _windowMs) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void HeardList::clear() {
+  memset(_entries, 0, sizeof(_entries));
+}
+
+const HeardList::Entry *HeardList::find(const PacketView &callsign) const {
+  for (size_t i = 0; i < SLOTS; i++) {
+    if (_entries[i].callsign[0] != 0 && callsign.equals(_entries[i].callsign)) {
+      return &_entries[i];
+    }
+  }
+  return 0;
+}
+
+TokenBucket::TokenBucket(uint32_t budgetMsPerMinute) : _budget(budgetMsPerMinute), _tokens((uint64_t)budgetMsPerMinute * 60000), _lastRefill(0) {
+}
+
+void TokenBucket::setBudget(uint32_t budgetMsPerMinute, uint32_t now) {
+  _budget     = budgetMsPerMinute;
+  _tokens     = (uint64_t)budgetMsPerMinute * 60000;
+  _lastRefill = now;
+}
+
+uint32_t TokenBucket::getBudget() const {
+  return _budget;
+}
+
+bool TokenBucket::take(uint32_t costMs, uint32_t now) {
+  refill(now);
+  const uint64_t cost = (uint64_t)costMs * 60000;
+  if (cost > _tokens) {
+    return false;
+  }
+  _tokens -= cost;
+  return true;
+}
+
+uint32_t TokenBucket::getAvailable(uint32_t now) {
+  refill(now);
+  return _tokens / 60000;
+}
+
+void TokenBucket::refill(uint32_t now) {
+  const uint64_t capacity = (uint64_t)_budget * 60000;
+  _tokens += (uint64_t)(now - _lastRefill) * _budget;
+  if (_tokens > capacity) {
+    _tokens = capacity;
+  }
+  _lastRefill = now;
+}
+
+IsGate::IsGate() : _active(true) {
+  _callsign[0] = 0;
+  memset(_counts, 0, sizeof(_counts));
+}
+
+void IsGate::setCallsign(const char *callsign) {
+  snprintf(_callsign, sizeof(_callsign), "%s", callsign);
+}
+
+void IsGate::setActive(bool active) {
+  _active = active;
+}
+
+void IsGate::setBudget(uint32_t budgetMsPerMinute, uint32_t now) {
+  _budget.setBudget(budgetMsPerMinute, now);
+}
+
+void IsGate::setModulation(const LoRaModulation &modulation) {
+  _modulation = modulation;
+}
+
+void IsGate::heardOnRf(const AprsPacket &packet, uint32_t now) {
+  _heard.heard(packet.getSource(), now);
+}
+
+IsGateResult IsGate::gate(const AprsPacket &packet, AprsPacket &out, uint32_t now) {
+  if (!_active) {
+    return count(IsGateDisabled);
+  }
+  const PacketView path = packet.getPath();
+  if (path.contains("NOGATE") || path.contains("RFONLY") || path.contains("TCPXX")) {
+    return count(IsGateNoGate);
+  }
+
+  // ":ADDRESSEE:text", the addressee is padded to 9 characters
+  const PacketView body = packet.getBody();
+  if (body.length < 11 || body.data[0] != ':' || body.data[10] != ':') {
+    return count(IsGateNoMessage);
+  }
+  PacketView addressee(body.data + 1, 9);
+  while (addressee.length > 0 && addressee.data[addressee.length - 1] == ' ') {
+    addressee.length--;
+  }
+  if (!_heard.wasHeard(addressee, now)) {
+    return count(IsGateNotHeard);
+  }
+  // the addressee can hear the sender itself
+  if (_heard.wasHeard(packet.getSource(), now)) {
+    return count(IsGateSenderOnRf);
+  }
+
+  if (!encapsulate(packet, out)) {
+    return count(IsGateTooLong);
+  }
+  if (!_budget.take(airtimeOf(out.getRawLength()), now)) {
+    return count(IsGateBudget);
+  }
+  return count(IsGateOkay);
+}
+
+uint32_t IsGate::airtimeOf(size_t length) const {
+  return LoRaAirtime::packetMillis(_modulation, length);
+}
+
+HeardList &IsGate::getHeardList() {
+  return _heard;
+}
+
+const HeardList &IsGate::getHeardList() const {
+  return _heard;
+}
+
+uint32_t IsGate::getCount(IsGateResult result) const {
+  return _counts[result];
+}
+
+const char *IsGate::toString(IsGateResult result) {
+  switch (result) {
+  case IsGateOkay:
+    return "gated";
+  case IsGateDisabled:
+    return "disabled";
+  case IsGateNoMessage:
+    return "no message";
+  case IsGateNoGate:
+    return "not to be gated";
+  case IsGateNotHeard:
+    return "addressee not heard";
+  case IsGateSenderOnRf:
+    return "sender heard on RF";
+  case IsGateTooLong:
+    return "too long";
+  case IsGateBudget:
+    return "airtime budget exceeded";
+  case IsGateResultCount:
+    break;
+  }
+  return "";
+}
+
+IsGateResult IsGate::count(IsGateResult result) {
+  _counts[result]++;
+  return result;
+}
+
+// "CALL>APLG01:}SRC>DEST,TCPIP,CALL*:body"
+bool IsGate::encapsulate(const AprsPacket &packet, AprsPacket &out) const {
+  const PacketView source      = packet.getSource();
+  const PacketView destination = packet.getDestination();
+  const PacketView body        = packet.getBody();
+
+  char      line[AprsPacket::MAX_LENGTH + 1];
+  const int length = snprintf(line, sizeof(line), "%s>APLG01:}%.*s>%.*s,TCPIP,%s*:%.*s", _callsign, (int)source.length, source.data, (int)destination.length, destination.data, _callsign, (int)body.length, body.data);
+  if (length < 0 || (size_t)length >= sizeof(line)) {
+    return false;
+  }
+  out.setOrigin(OriginLocal);
+  return out.decode(line, length);
+}
@@ -0,0 +1,113 @@
+#ifndef IS_GATE_H_
+#define IS_GATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AprsPacket.h"
+#include "LoRa/Airtime.h"
+
+enum IsGateResult {
+  IsGateOkay,
+  IsGateDisabled,
+  IsGateNoMessage,
+  IsGateNoGate,
+  IsGateNotHeard,
+  IsGateSenderOnRf,
+  IsGateTooLong,
+  IsGateBudget,
+  IsGateResultCount,
+};
+
+// Stations heard on RF during the last window (30 min by default). A fixed
+// table, when it is full the station heard the longest time ago is replaced.
+class HeardList {
+public:
+  static const size_t SLOTS           = 32;
+  static const size_t CALLSIGN_LENGTH = 10;
+
+  explicit HeardList(uint32_t windowMs = 30 * 60 * 1000);
+
+  void     setWindow(uint32_t windowMs);
+  uint32_t getWindow() const;
+
+  void   heard(const PacketView &callsign, uint32_t now);
+  bool   wasHeard(const PacketView &callsign, uint32_t now) const;
+  size_t size(uint32_t now) const;
+  void   clear();
+
+private:
+  class Entry {
+  public:
+    char     callsign[CALLSIGN_LENGTH];
+    uint32_t heard; // only valid if callsign is set
+  };
+
+  Entry    _entries[SLOTS];
+  uint32_t _windowMs;
+
+  const Entry *find(const PacketView &callsign) const;
+};
+
+// Airtime budget as a token bucket: it holds at most one minute worth of
+// airtime and refills at the configured milliseconds of airtime per minute.
+// Tokens are kept scaled by a minute, so the refill is exact in integers.
+class TokenBucket {
+public:
+  explicit TokenBucket(uint32_t budgetMsPerMinute = 0);
+
+  void     setBudget(uint32_t budgetMsPerMinute, uint32_t now);
+  uint32_t getBudget() const;
+  // takes the cost from the bucket if there is enough left
+  bool     take(uint32_t costMs, uint32_t now);
+  uint32_t getAvailable(uint32_t now);
+
+private:
+  uint32_t _budget;
+  uint64_t _tokens;
+  uint32_t _lastRefill;
+
+  void refill(uint32_t now);
+};
+
+// Decides which packets from APRS-IS go out on RF, following the usual
+// IGate rules: only messages to stations heard on RF recently, whose sender
+// was not heard on RF itself, and nothing marked NOGATE, RFONLY or TCPXX.
+// Gated packets are wrapped in a third-party header and have to fit into
+// the airtime budget.
+class IsGate {
+public:
+  IsGate();
+
+  void setCallsign(const char *callsign);
+  void setActive(bool active);
+  void setBudget(uint32_t budgetMsPerMinute, uint32_t now);
+  void setModulation(const LoRaModulation &modulation);
+
+  // every packet received on RF, its source counts as heard
+  void heardOnRf(const AprsPacket &packet, uint32_t now);
+
+  // fills out with the third-party packet for RF if the result is IsGateOkay
+  IsGateResult gate(const AprsPacket &packet, AprsPacket &out, uint32_t now);
+
+  uint32_t airtimeOf(size_t length) const;
+
+  HeardList       &getHeardList();
+  const HeardList &getHeardList() const;
+  uint32_t         getCount(IsGateResult result) const;
+
+  static const char *toString(IsGateResult result);
+
+private:
+  char           _callsign[HeardList::CALLSIGN_LENGTH];
+  bool           _active;
+  HeardList      _heard;
+  TokenBucket    _budget;
+  LoRaModulation _modulation;
+  uint32_t       _counts[IsGateResultCount];
+
+  IsGateResult count(IsGateResult result);
+  bool         encapsulate(const AprsPacket &packet, AprsPacket &out) const;
+};
+
+#endif
@@ -0,0 +1,242 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "MqttPayload.h"
+
+// bounded append to the output buffer, remembers if anything did not fit
+class PayloadWriter {
+public:
+  PayloadWriter(char *out, size_t size) : _out(out), _size(size), _length(0), _overflow(false) {
+  }
+
+  void put(uint8_t c) {
+    if (_length < _size) {
+      _out[_length++] = (char)c;
+    } else {
+      _overflow = true;
+    }
+  }
+
+  void put(const char *data, size_t length) {
+    if (_size - _length < length) {
+      _overflow = true;
+      return;
+    }
+    memcpy(_out + _length, data, length);
+    _length += length;
+  }
+
+  void put(const char *str) {
+    put(str, strlen(str));
+  }
+
+  // JSON string with the escapes ArduinoJson uses
+  void putJsonString(const char *data, size_t length, bool dropNewlines = false) {
+    static const char hex[] = "0123456789abcdef";
+    put('"');
+    for (size_t i = 0; i < length; i++) {
+      const uint8_t c = (uint8_t)data[i];
+      if (c == '\n' && dropNewlines) {
+        continue;
+      }
+      switch (c) {
+      case '"':
+        put("\\\"", 2);
+        break;
+      case '\\':
+        put("\\\\", 2);
+        break;
+      case '\b':
+        put("\\b", 2);
+        break;
+      case '\f':
+        put("\\f", 2);
+        break;
+      case '\n':
+        put("\\n", 2);
+        break;
+      case '\r':
+        put("\\r", 2);
+        break;
+      case '\t':
+        put("\\t", 2);
+        break;
+      default:
+        if (c < 0x20) {
+          const char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0f]};
+          put(escaped, sizeof(escaped));
+        } else {
+          put(c);
+        }
+        break;
+      }
+    }
+    put('"');
+  }
+
+  void putJsonField(const char *key, const char *data, size_t length, bool first = false, bool dropNewlines = false) {
+    if (!first) {
+      put(',');
+    }
+    putJsonString(key, strlen(key));
+    put(':');
+    putJsonString(data, length, dropNewlines);
+  }
+
+  void putJsonField(const char *key, float value) {
+    put(',');
+    putJsonString(key, strlen(key));
+    put(':');
+    if (!isfinite(value)) {
+      put("null", 4);
+      return;
+    }
+    char number[24];
+    const int length = snprintf(number, sizeof(number), "%.7g", value);
+    put(number, length);
+  }
+
+  void putMsgPackString(const char *data, size_t length, bool dropNewlines = false) {
+    if (dropNewlines) {
+      putMsgPackStringHeader(length - countNewlines(data, length));
+      for (const char *end = data + length; data < end;) {
+        const char *newline = (const char *)memchr(data, '\n', end - data);
+        put(data, (newline != 0 ? newline : end) - data);
+        data = newline != 0 ? newline + 1 : end;
+      }
+      return;
+    }
+    putMsgPackStringHeader(length);
+    put(data, length);
+  }
+
+  void putMsgPackStringHeader(size_t length) {
+    if (length < 32) {
+      put(0xa0 | length);
+    } else if (length < 256) {
+      put(0xd9);
+      put(length);
+    } else {
+      put(0xda);
+      put(length >> 8);
+      put(length & 0xff);
+    }
+  }
+
+  void putMsgPackField(const char *key, const char *data, size_t length, bool dropNewlines = false) {
+    putMsgPackString(key, strlen(key));
+    putMsgPackString(data, length, dropNewlines);
+  }
+
+  void putMsgPackField(const char *key, float value) {
+    putMsgPackString(key, strlen(key));
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put(0xca);
+    put(bits >> 24);
+    put((bits >> 16) & 0xff);
+    put((bits >> 8) & 0xff);
+    put(bits & 0xff);
+  }
+
+  size_t finish() {
+    return _overflow ? 0 : _length;
+  }
+
+private:
+  char  *_out;
+  size_t _size;
+  size_t _length;
+  bool   _overflow;
+
+  static size_t countNewlines(const char *data, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+      count += data[i] == '\n';
+    }
+    return count;
+  }
+};
+
+size_t MqttPayload::encode(MqttFormat format, const AprsPacket &packet, const char *type, char *out, size_t size) {
+  switch (format) {
+  case MqttFormatMsgPack:
+    return encodeMsgPack(packet, type, out, size);
+  case MqttFormatJson:
+  default:
+    return encodeJson(packet, type, out, size);
+  }
+}
+
+size_t MqttPayload::encodeJson(const AprsPacket &packet, const char *type, char *out, size_t size) {
+  PayloadWriter    writer(out, size);
+  const PacketView source      = packet.getSource();
+  const PacketView destination = packet.getDestination();
+  const PacketView path        = packet.getPath();
+  const PacketView body        = packet.getBody();
+
+  writer.put('{');
+  writer.putJsonField("source", source.data, source.length, true);
+  writer.putJsonField("destination", destination.data, destination.length);
+  writer.putJsonField("path", path.data, path.length);
+  writer.putJsonField("type", type, strlen(type));
+  // line feeds in the body were always removed from the payload
+  writer.putJsonField("data", body.data, body.length, false, true);
+  if (packet.getOrigin() == OriginRf) {
+    const RxMetadata &rx = packet.getRxMetadata();
+    writer.putJsonField("rssi", rx.rssi);
+    writer.putJsonField("snr", rx.snr);
+    writer.putJsonField("frequency_error", rx.frequencyError);
+  }
+  writer.put('}');
+  const size_t length = writer.finish();
+  if (length == 0 || length == size) {
+    return 0;
+  }
+  out[length] = 0;
+  return length;
+}
+
+size_t MqttPayload::encodeMsgPack(const AprsPacket &packet, const char *type, char *out, size_t size) {
+  PayloadWriter    writer(out, size);
+  const PacketView source      = packet.getSource();
+  const PacketView destination = packet.getDestination();
+  const PacketView path        = packet.getPath();
+  const PacketView body        = packet.getBody();
+  const bool       rf          = packet.getOrigin() == OriginRf;
+
+  // fixmap
+  writer.put(0x80 | (rf ? 8 : 5));
+  writer.putMsgPackField("source", source.data, source.length);
+  writer.putMsgPackField("destination", destination.data, destination.length);
+  writer.putMsgPackField("path", path.data, path.length);
+  writer.putMsgPackField("type", type, strlen(type));
+  writer.putMsgPackField("data", body.data, body.length, true);
+  if (rf) {
+    const RxMetadata &rx = packet.getRxMetadata();
+    writer.putMsgPackField("rssi", rx.rssi);
+    writer.putMsgPackField("snr", rx.snr);
+    writer.putMsgPackField("frequency_error", rx.frequencyError);
+  }
+  return writer.finish();
+}
+
+bool MqttPayload::parseFormat(const char *name, MqttFormat &format) {
+  if (strcmp(name, "msgpack") == 0) {
+    format = MqttFormatMsgPack;
+    return true;
+  }
+  format = MqttFormatJson;
+  return strcmp(name, "json") == 0;
+}
+
+const char *MqttPayload::toString(MqttFormat format) {
+  switch (format) {
+  case MqttFormatJson:
+    return "json";
+  case MqttFormatMsgPack:
+    return "msgpack";
+  }
+  return "";
+}
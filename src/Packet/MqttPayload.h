@@ -0,0 +1,31 @@
+#ifndef MQTT_PAYLOAD_H_
+#define MQTT_PAYLOAD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AprsPacket.h"
+
+enum MqttFormat {
+  MqttFormatJson,
+  MqttFormatMsgPack, // the same map as MessagePack, for brokers on metered uplinks
+};
+
+// Writes the MQTT message of a packet straight into a caller owned buffer,
+// field by field from the views of the packet. Nothing is allocated, so the
+// same buffer serves every message. The fields are source, destination,
+// path, type and data, plus rssi, snr and frequency_error for packets
+// received on RF.
+class MqttPayload {
+public:
+  // returns the length written, 0 if it does not fit. JSON is NUL terminated.
+  static size_t encode(MqttFormat format, const AprsPacket &packet, const char *type, char *out, size_t size);
+  static size_t encodeJson(const AprsPacket &packet, const char *type, char *out, size_t size);
+  static size_t encodeMsgPack(const AprsPacket &packet, const char *type, char *out, size_t size);
+
+  // "json" or "msgpack", false (and JSON) for anything else
+  static bool        parseFormat(const char *name, MqttFormat &format);
+  static const char *toString(MqttFormat format);
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include <new>
+#include <string.h>
+
+#include "MqttSpool.h"
+
+MqttSpool::MqttSpool() : _ring(0), _capacity(0), _head(0), _used(0), _sendOffset(0), _inFlight(0), _pending(0), _peak(0), _confirmDelay(2000), _ratePerSecond(0), _burst(1), _tokens(1000), _lastRefill(0), _dropped(0), _resent(0), _confirmed(0) {
+}
+
+MqttSpool::~MqttSpool() {
+  delete[] _ring;
+}
+
+bool MqttSpool::begin(size_t bytes) {
+  if (_ring != 0) {
+    return true;
+  }
+  _ring = new (std::nothrow) uint8_t[bytes];
+  if (_ring == 0) {
+    return false;
+  }
+  _capacity = bytes;
+  return true;
+}
+
+void MqttSpool::setConfirmDelay(uint32_t delayMs) {
+  _confirmDelay = delayMs;
+}
+
+void MqttSpool::setRate(uint32_t perSecond, uint32_t burst, uint32_t now) {
+  _ratePerSecond = perSecond;
+  _burst         = burst > 0 ? burst : 1;
+  _tokens        = _burst * 1000;
+  _lastRefill    = now;
+}
+
+bool MqttSpool::push(const char *data, size_t length) {
+  const size_t record = RECORD_HEADER + length;
+  if (length == 0 || length > MAX_MESSAGE || record > _capacity) {
+    _dropped++;
+    return false;
+  }
+  while (_capacity - _used < record) {
+    dropOldest();
+  }
+  const size_t  tail      = (_head + _used) % _capacity;
+  const uint8_t header[6] = {(uint8_t)(length >> 8), (uint8_t)(length & 0xff), 0, 0, 0, 0};
+  write(tail, header, sizeof(header));
+  write((tail + RECORD_HEADER) % _capacity, (const uint8_t *)data, length);
+  _used += record;
+  _pending++;
+  if (_used > _peak) {
+    _peak = _used;
+  }
+  return true;
+}
+
+bool MqttSpool::hasRoom(size_t length) const {
+  return _capacity - _used >= RECORD_HEADER + length;
+}
+
+size_t MqttSpool::peek(char *out, size_t size) const {
+  const size_t length = peekLength();
+  if (length == 0 || length > size) {
+    return 0;
+  }
+  read((_head + _sendOffset + RECORD_HEADER) % _capacity, (uint8_t *)out, length);
+  return length;
+}
+
+size_t MqttSpool::peekLength() const {
+  if (_pending == 0) {
+    return 0;
+  }
+  return recordLength((_head + _sendOffset) % _capacity);
+}
+
+void MqttSpool::sent(uint32_t now) {
+  if (_pending == 0) {
+    return;
+  }
+  const size_t  position = (_head + _sendOffset) % _capacity;
+  const uint8_t sentAt[] = {(uint8_t)(now >> 24), (uint8_t)(now >> 16), (uint8_t)(now >> 8), (uint8_t)now};
+  write((position + 2) % _capacity, sentAt, sizeof(sentAt));
+  _sendOffset += RECORD_HEADER + recordLength(position);
+  _pending--;
+  _inFlight++;
+  if (_ratePerSecond > 0 && _tokens >= 1000) {
+    _tokens -= 1000;
+  }
+}
+
+size_t MqttSpool::confirm(uint32_t now) {
+  size_t count = 0;
+  while (_inFlight > 0 && now - recordSentAt(_head) >= _confirmDelay) {
+    const size_t record = RECORD_HEADER + recordLength(_head);
+    _head               = (_head + record) % _capacity;
+    _used -= record;
+    _sendOffset -= record;
+    _inFlight--;
+    _confirmed++;
+    count++;
+  }
+  return count;
+}
+
+void MqttSpool::resend() {
+  _resent += _inFlight;
+  _pending += _inFlight;
+  _inFlight   = 0;
+  _sendOffset = 0;
+}
+
+void MqttSpool::clear() {
+  _head       = 0;
+  _used       = 0;
+  _sendOffset = 0;
+  _inFlight   = 0;
+  _pending    = 0;
+}
+
+bool MqttSpool::canSend(uint32_t now) {
+  if (_pending == 0) {
+    return false;
+  }
+  if (_ratePerSecond == 0) {
+    return true;
+  }
+  refill(now);
+  return _tokens >= 1000;
+}
+
+uint32_t MqttSpool::getNextSend(uint32_t now) const {
+  if (_pending == 0) {
+    return 0;
+  }
+  if (_ratePerSecond == 0 || _tokens >= 1000) {
+    return now;
+  }
+  // tokens come at _ratePerSecond per 1000 ms, i.e. one per 1000 / rate ms
+  const uint32_t missing = 1000 - _tokens;
+  return _lastRefill + (missing + _ratePerSecond - 1) / _ratePerSecond;
+}
+
+size_t MqttSpool::getPending() const {
+  return _pending;
+}
+
+size_t MqttSpool::getInFlight() const {
+  return _inFlight;
+}
+
+size_t MqttSpool::getUsedBytes() const {
+  return _used;
+}
+
+size_t MqttSpool::getCapacity() const {
+  return _capacity;
+}
+
+size_t MqttSpool::getPeakBytes() const {
+  return _peak;
+}
+
+uint32_t MqttSpool::getDropped() const {
+  return _dropped;
+}
+
+uint32_t MqttSpool::getResent() const {
+  return _resent;
+}
+
+uint32_t MqttSpool::getConfirmed() const {
+  return _confirmed;
+}
+
+void MqttSpool::read(size_t position, uint8_t *out, size_t length) const {
+  const size_t first = length < _capacity - position ? length : _capacity - position;
+  memcpy(out, _ring + position, first);
+  memcpy(out + first, _ring, length - first);
+}
+
+void MqttSpool::write(size_t position, const uint8_t *data, size_t length) {
+  const size_t first = length < _capacity - position ? length : _capacity - position;
+  memcpy(_ring + position, data, first);
+  memcpy(_ring, data + first, length - first);
+}
+
+size_t MqttSpool::recordLength(size_t position) const {
+  uint8_t header[2];
+  read(position, header, sizeof(header));
+  return ((size_t)header[0] << 8) | header[1];
+}
+
+uint32_t MqttSpool::recordSentAt(size_t position) const {
+  uint8_t sentAt[4];
+  read((position + 2) % _capacity, sentAt, sizeof(sentAt));
+  return ((uint32_t)sentAt[0] << 24) | ((uint32_t)sentAt[1] << 16) | ((uint32_t)sentAt[2] << 8) | sentAt[3];
+}
+
+void MqttSpool::dropOldest() {
+  const size_t record = RECORD_HEADER + recordLength(_head);
+  _head               = (_head + record) % _capacity;
+  _used -= record;
+  if (_inFlight > 0) {
+    _sendOffset -= record;
+    _inFlight--;
+  } else {
+    _pending--;
+  }
+  _dropped++;
+}
+
+void MqttSpool::refill(uint32_t now) {
+  const uint32_t elapsed = now - _lastRefill;
+  if (elapsed == 0) {
+    return;
+  }
+  const uint64_t tokens = _tokens + (uint64_t)elapsed * _ratePerSecond;
+  const uint64_t limit  = (uint64_t)_burst * 1000;
+  _tokens               = tokens > limit ? (uint32_t)limit : (uint32_t)tokens;
+  _lastRefill           = now;
+}
@@ -0,0 +1,95 @@
+#ifndef MQTT_SPOOL_H_
+#define MQTT_SPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Serialized MQTT messages waiting for the broker, in a fixed byte ring.
+// Every message goes through the spool, so nothing is lost while the broker
+// is unreachable and the order is kept on replay. When the ring is full the
+// oldest messages are dropped and counted.
+//
+// PubSubClient can only publish with QoS 0, so a sent message is held as
+// in flight until the connection stayed up for the confirm delay after it
+// was written. If the connection drops before, resend() puts it back in
+// front of the queue: every message arrives at least once, as with QoS 1.
+//
+// Replay is rate limited by a token bucket, so a long backlog goes out
+// gradually instead of blocking the main loop.
+class MqttSpool {
+public:
+  static const size_t MAX_MESSAGE = 0xFFFF;
+
+  MqttSpool();
+  ~MqttSpool();
+
+  MqttSpool(const MqttSpool &)            = delete;
+  MqttSpool &operator=(const MqttSpool &) = delete;
+
+  // allocates the ring, only the first call has an effect
+  bool begin(size_t bytes);
+  void setConfirmDelay(uint32_t delayMs);
+  // messages per second and how many may go at once after a pause
+  void setRate(uint32_t perSecond, uint32_t burst, uint32_t now);
+
+  // false if the message can not fit even into an empty spool
+  bool push(const char *data, size_t length);
+  bool hasRoom(size_t length) const;
+
+  // copy the next message not sent yet, returns its length (0 if there is none or out is too small)
+  size_t peek(char *out, size_t size) const;
+  size_t peekLength() const;
+  // the peeked message was written to the broker
+  void   sent(uint32_t now);
+  // release what stayed sent for the confirm delay, returns how many
+  size_t confirm(uint32_t now);
+  // the connection dropped, everything in flight goes again
+  void   resend();
+  void   clear();
+
+  // a token is free to send the next message
+  bool     canSend(uint32_t now);
+  // millis() when the next token is due, 0 if nothing is pending
+  uint32_t getNextSend(uint32_t now) const;
+
+  size_t   getPending() const;
+  size_t   getInFlight() const;
+  size_t   getUsedBytes() const;
+  size_t   getCapacity() const;
+  size_t   getPeakBytes() const;
+  uint32_t getDropped() const;
+  uint32_t getResent() const;
+  uint32_t getConfirmed() const;
+
+private:
+  // per message: length (2 bytes) and the millis() it was sent (4 bytes)
+  static const size_t RECORD_HEADER = 6;
+
+  uint8_t *_ring;
+  size_t   _capacity;
+  size_t   _head; // oldest message, in flight if there are any
+  size_t   _used;
+  size_t   _sendOffset; // bytes in flight, the next message to send starts there
+  size_t   _inFlight;
+  size_t   _pending;
+  size_t   _peak;
+
+  uint32_t _confirmDelay;
+  uint32_t _ratePerSecond;
+  uint32_t _burst;
+  uint32_t _tokens; // in 1/1000 of a message
+  uint32_t _lastRefill;
+
+  uint32_t _dropped;
+  uint32_t _resent;
+  uint32_t _confirmed;
+
+  void     read(size_t position, uint8_t *out, size_t length) const;
+  void     write(size_t position, const uint8_t *data, size_t length);
+  size_t   recordLength(size_t position) const;
+  uint32_t recordSentAt(size_t position) const;
+  void     dropOldest();
+  void     refill(uint32_t now);
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include <string.h>
+
+#include "Router.h"
+
+Router::Router(TxQueue &toModem, TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs, TaskQueue<std::shared_ptr<AprsPacket>> &toMQTT) : _toModem(toModem), _toAprsIs(toAprsIs), _toMQTT(toMQTT), _uplink(false), _digi(false), _mqtt(false) {
+  _callsign[0] = 0;
+}
+
+void Router::setCallsign(const char *callsign) {
+  strncpy(_callsign, callsign, sizeof(_callsign) - 1);
+  _callsign[sizeof(_callsign) - 1] = 0;
+  _digipeater.setCallsign(callsign);
+  _isGate.setCallsign(callsign);
+}
+
+void Router::setUplink(bool active) {
+  _uplink = active;
+}
+
+void Router::setDigi(bool active) {
+  _digi = active;
+}
+
+void Router::setMQTT(bool active) {
+  _mqtt = active;
+}
+
+RfRoute Router::fromRf(const std::shared_ptr<AprsPacket> &packet, uint32_t now) {
+  RfRoute    route;
+  const bool ownPacket = packet->getSource().equals(_callsign);
+
+  if (_mqtt) {
+    _toMQTT.addElement(packet);
+  }
+
+  if (!ownPacket) {
+    _isGate.heardOnRf(*packet, now);
+  }
+
+  if (!_uplink) {
+    route.uplink = RouteUplinkDisabled;
+  } else if (ownPacket) {
+    route.uplink = RouteUplinkOwnPacket;
+  } else {
+    PacketView path = packet->getPath();
+    if (path.contains("RFONLY") || path.contains("NOGATE") || path.contains("TCPIP")) {
+      route.uplink = RouteUplinkNoGate;
+    } else if (_dedupe.isDuplicate(*packet, DedupeIGate, now)) {
+      route.uplink = RouteUplinkDuplicate;
+    } else {
+      // the packet is shared, qAO and our call are added when it is written to APRS-IS
+      route.uplink = RouteUplinkForwarded;
+      _toAprsIs.addElement(packet);
+    }
+  }
+
+  if (!_digi || ownPacket) {
+    return route;
+  }
+
+  const uint32_t hash = DedupeCache::hashOf(*packet);
+  route.cancelled     = _viscous.cancel(hash);
+
+  char   digiPath[AprsPacket::MAX_LENGTH];
+  size_t length    = 0;
+  route.digiResult = _digipeater.decide(*packet, digiPath, sizeof(digiPath), length);
+  if (!Digipeater::shouldRepeat(route.digiResult)) {
+    route.digi = RouteDigiNoRepeat;
+    return route;
+  }
+  if (_dedupe.isDuplicate(hash, DedupeDigi, now)) {
+    route.digi = RouteDigiDuplicate;
+    return route;
+  }
+
+  route.digiPacket = AprsPacket::create(*packet);
+  route.digiPacket->setOrigin(OriginLocal);
+  if (!route.digiPacket->setPath(digiPath, length)) {
+    route.digi = RouteDigiTooLong;
+  } else if (route.digiResult != DigiDirect && _viscous.getDelay() != 0 && _viscous.hold(route.digiPacket, hash, now)) {
+    route.digi = RouteDigiDelayed;
+  } else {
+    route.digi = RouteDigiQueued;
+    _toModem.push(route.digiPacket, txClassOf(*route.digiPacket), now);
+  }
+  return route;
+}
+
+IsGateResult Router::fromAprsIs(const std::shared_ptr<AprsPacket> &packet, uint32_t now, std::shared_ptr<AprsPacket> &rfPacket) {
+  rfPacket            = AprsPacket::create();
+  IsGateResult result = _isGate.gate(*packet, *rfPacket, now);
+  if (result == IsGateOkay) {
+    _toModem.push(rfPacket, TxClassIsToRf, now);
+  } else {
+    rfPacket.reset();
+  }
+  return result;
+}
+
+size_t Router::release(uint32_t now) {
+  size_t count = 0;
+  for (std::shared_ptr<AprsPacket> digiMsg = _viscous.release(now); digiMsg; digiMsg = _viscous.release(now)) {
+    _toModem.push(digiMsg, txClassOf(*digiMsg), now);
+    count++;
+  }
+  return count;
+}
+
+uint32_t Router::getDeadline() const {
+  return _viscous.getNextDue();
+}
+
+DedupeCache &Router::getDedupeCache() {
+  return _dedupe;
+}
+
+const DedupeCache &Router::getDedupeCache() const {
+  return _dedupe;
+}
+
+Digipeater &Router::getDigipeater() {
+  return _digipeater;
+}
+
+ViscousQueue &Router::getViscousQueue() {
+  return _viscous;
+}
+
+IsGate &Router::getIsGate() {
+  return _isGate;
+}
+
+const IsGate &Router::getIsGate() const {
+  return _isGate;
+}
+
+TxClass Router::txClassOf(const AprsPacket &packet) {
+  const PacketView body = packet.getBody();
+  return body.length > 0 && body.data[0] == ':' ? TxClassMessage : TxClassDigi;
+}
@@ -0,0 +1,91 @@
+#ifndef ROUTER_H_
+#define ROUTER_H_
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AprsPacket.h"
+#include "DedupeCache.h"
+#include "Digipeater.h"
+#include "IsGate.h"
+#include "LoRa/TxQueue.h"
+#include "System/TaskQueue.h"
+
+enum RouteUplink {
+  RouteUplinkForwarded,
+  RouteUplinkDisabled,
+  RouteUplinkOwnPacket,
+  RouteUplinkNoGate, // RFONLY, NOGATE or TCPIP in the path
+  RouteUplinkDuplicate,
+};
+
+enum RouteDigi {
+  RouteDigiDisabled, // digi off or own packet
+  RouteDigiNoRepeat, // see digiResult
+  RouteDigiDuplicate,
+  RouteDigiTooLong,
+  RouteDigiDelayed, // held in the viscous queue
+  RouteDigiQueued,
+};
+
+// What the router did with a packet received on RF.
+class RfRoute {
+public:
+  RfRoute() : uplink(RouteUplinkDisabled), digi(RouteDigiDisabled), digiResult(DigiNotForUs), cancelled(false) {
+  }
+
+  RouteUplink                 uplink;
+  RouteDigi                   digi;
+  DigiResult                  digiResult;
+  bool                        cancelled; // a held repeat of this packet was dropped
+  std::shared_ptr<AprsPacket> digiPacket;
+};
+
+// The decisions between the modem, APRS-IS and MQTT: uplink with dedupe,
+// digipeating (viscous or not) and IS to RF gating. Free of Arduino and
+// logging, so the same code runs in RouterTask and on the host.
+class Router {
+public:
+  Router(TxQueue &toModem, TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs, TaskQueue<std::shared_ptr<AprsPacket>> &toMQTT);
+
+  void setCallsign(const char *callsign);
+  void setUplink(bool active);
+  void setDigi(bool active);
+  void setMQTT(bool active);
+
+  RfRoute      fromRf(const std::shared_ptr<AprsPacket> &packet, uint32_t now);
+  IsGateResult fromAprsIs(const std::shared_ptr<AprsPacket> &packet, uint32_t now, std::shared_ptr<AprsPacket> &rfPacket);
+  // push the held repeats whose delay is over, returns how many
+  size_t       release(uint32_t now);
+
+  // millis() when the next held repeat is due, 0 if none
+  uint32_t getDeadline() const;
+
+  DedupeCache       &getDedupeCache();
+  const DedupeCache &getDedupeCache() const;
+  Digipeater        &getDigipeater();
+  ViscousQueue      &getViscousQueue();
+  IsGate            &getIsGate();
+  const IsGate      &getIsGate() const;
+
+  // messages and acks are what users wait for, they go ahead of other digipeats
+  static TxClass txClassOf(const AprsPacket &packet);
+
+private:
+  TxQueue                                &_toModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_toAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_toMQTT;
+
+  char _callsign[Digipeater::CALL_LENGTH + 1];
+  bool _uplink;
+  bool _digi;
+  bool _mqtt;
+
+  DedupeCache  _dedupe;
+  Digipeater   _digipeater;
+  ViscousQueue _viscous;
+  IsGate       _isGate;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef RX_STATS_H_
+#define RX_STATS_H_
+
+#include <stdint.h>
+
+#include "AprsPacket.h"
+
+// Link quality summary of the packets received since the last reset().
+// Only packets received intact count towards RSSI and SNR.
+class RxStats {
+public:
+  RxStats() {
+    reset();
+  }
+
+  void reset() {
+    for (int i = 0; i < RxStatusCount; i++) {
+      _counts[i] = 0;
+    }
+    _rssiSum = 0;
+    _rssiMin = 0;
+    _rssiMax = 0;
+    _snrSum  = 0;
+    _snrMin  = 0;
+    _snrMax  = 0;
+  }
+
+  void add(const RxMetadata &rx) {
+    _counts[rx.status]++;
+    if (rx.status != RxOkay) {
+      return;
+    }
+    const bool first = _counts[RxOkay] == 1;
+    _rssiSum += rx.rssi;
+    _snrSum  += rx.snr;
+    if (first || rx.rssi < _rssiMin) {
+      _rssiMin = rx.rssi;
+    }
+    if (first || rx.rssi > _rssiMax) {
+      _rssiMax = rx.rssi;
+    }
+    if (first || rx.snr < _snrMin) {
+      _snrMin = rx.snr;
+    }
+    if (first || rx.snr > _snrMax) {
+      _snrMax = rx.snr;
+    }
+  }
+
+  uint32_t getCount(RxStatus status) const {
+    return _counts[status];
+  }
+
+  float getRssiMin() const {
+    return _rssiMin;
+  }
+
+  float getRssiAverage() const {
+    return _counts[RxOkay] == 0 ? 0 : _rssiSum / _counts[RxOkay];
+  }
+
+  float getRssiMax() const {
+    return _rssiMax;
+  }
+
+  float getSnrMin() const {
+    return _snrMin;
+  }
+
+  float getSnrAverage() const {
+    return _counts[RxOkay] == 0 ? 0 : _snrSum / _counts[RxOkay];
+  }
+
+  float getSnrMax() const {
+    return _snrMax;
+  }
+
+private:
+  uint32_t _counts[RxStatusCount];
+  float    _rssiSum;
+  float    _rssiMin;
+  float    _rssiMax;
+  float    _snrSum;
+  float    _snrMin;
+  float    _snrMax;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Histogram of durations (or any other unsigned value) with two buckets per
+// power of two. That keeps percentiles within ~40% of the real value while
+// using only a few hundred bytes, independent of the number of samples.
+class Histogram {
+public:
+  static const size_t BUCKETS = 64;
+
+  Histogram() {
+    reset();
+  }
+
+  void reset() {
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _sum   = 0;
+    _min   = UINT32_MAX;
+    _max   = 0;
+  }
+
+  void add(uint32_t value) {
+    _buckets[bucketOf(value)]++;
+    _count++;
+    _sum += value;
+    if (value < _min) {
+      _min = value;
+    }
+    if (value > _max) {
+      _max = value;
+    }
+  }
+
+  uint32_t getCount() const {
+    return _count;
+  }
+
+  uint32_t getMin() const {
+    return _count == 0 ? 0 : _min;
+  }
+
+  uint32_t getMax() const {
+    return _max;
+  }
+
+  uint64_t getSum() const {
+    return _sum;
+  }
+
+  uint32_t getAverage() const {
+    return _count == 0 ? 0 : (uint32_t)(_sum / _count);
+  }
+
+  // upper bound of the bucket holding the given percentile (0-100), clamped to the max seen
+  uint32_t getPercentile(uint8_t percent) const {
+    if (_count == 0) {
+      return 0;
+    }
+    uint64_t rank = ((uint64_t)_count * percent + 99) / 100;
+    if (rank == 0) {
+      rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += _buckets[i];
+      if (seen >= rank) {
+        uint32_t upper = upperBoundOf(i);
+        return upper < _max ? upper : _max;
+      }
+    }
+    return _max;
+  }
+
+  uint32_t getBucketCount(size_t bucket) const {
+    return bucket < BUCKETS ? _buckets[bucket] : 0;
+  }
+
+  // largest value that still falls into the given bucket
+  static uint32_t upperBoundOf(size_t bucket) {
+    if (bucket < 2) {
+      return bucket;
+    }
+    const uint32_t exponent = bucket / 2;
+    const uint64_t base     = (uint64_t)1 << exponent;
+    const uint64_t upper    = (bucket & 1) ? (base << 1) - 1 : base + (base >> 1) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+  }
+
+  static size_t bucketOf(uint32_t value) {
+    if (value < 2) {
+      return value;
+    }
+    const uint32_t exponent = 31 - __builtin_clz(value);
+    const uint32_t half     = (value >> (exponent - 1)) & 1;
+    return exponent * 2 + half;
+  }
+
+private:
+  uint32_t _buckets[BUCKETS];
+  uint32_t _count;
+  uint64_t _sum;
+  uint32_t _min;
+  uint32_t _max;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <new>
+
+#include "MemoryPool.h"
+
+MemoryPool *MemoryPool::_first = 0;
+
+static size_t alignBlockSize(size_t size) {
+  const size_t alignment = alignof(std::max_align_t);
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+MemoryPool::MemoryPool(const char *name, size_t blockSize) : _name(name), _blockSize(alignBlockSize(blockSize)), _slots(0), _blocks(0), _freeHead(NO_BLOCK), _nextFree(0), _used(0), _peak(0), _fallbacks(0), _next(_first) {
+  _first = this;
+}
+
+MemoryPool::~MemoryPool() {
+  for (MemoryPool **pool = &_first; *pool != 0; pool = &(*pool)->_next) {
+    if (*pool == this) {
+      *pool = _next;
+      break;
+    }
+  }
+  delete[] _blocks;
+  delete[] _nextFree;
+}
+
+bool MemoryPool::begin(size_t slots) {
+  if (_blocks != 0 || slots == 0) {
+    return _blocks != 0;
+  }
+  if (slots > MAX_SLOTS) {
+    slots = MAX_SLOTS;
+  }
+  uint8_t               *blocks   = new (std::nothrow) uint8_t[slots * _blockSize];
+  std::atomic<uint16_t> *nextFree = new (std::nothrow) std::atomic<uint16_t>[slots];
+  if (blocks == 0 || nextFree == 0) {
+    delete[] blocks;
+    delete[] nextFree;
+    return false;
+  }
+  for (size_t i = 0; i < slots; i++) {
+    nextFree[i].store(i + 1 < slots ? i + 1 : NO_BLOCK, std::memory_order_relaxed);
+  }
+  _nextFree = nextFree;
+  _slots    = slots;
+  _blocks   = blocks;
+  _freeHead.store(0, std::memory_order_release);
+  return true;
+}
+
+void *MemoryPool::allocate(size_t size) {
+  if (size <= _blockSize) {
+    uint32_t head = _freeHead.load(std::memory_order_acquire);
+    while ((head & 0xFFFF) != NO_BLOCK) {
+      const uint16_t index = head & 0xFFFF;
+      const uint32_t next  = (((head >> 16) + 1) << 16) | _nextFree[index].load(std::memory_order_relaxed);
+      if (_freeHead.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        const size_t used = _used.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t       peak = _peak.load(std::memory_order_relaxed);
+        while (used > peak && !_peak.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+        }
+        return _blocks + index * _blockSize;
+      }
+    }
+  }
+  _fallbacks.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+void MemoryPool::deallocate(void *ptr, size_t size) {
+  if (!owns(ptr)) {
+    ::operator delete(ptr);
+    return;
+  }
+  const uint16_t index = ((uint8_t *)ptr - _blocks) / _blockSize;
+  uint32_t       head  = _freeHead.load(std::memory_order_relaxed);
+  uint32_t       next;
+  do {
+    _nextFree[index].store(head & 0xFFFF, std::memory_order_relaxed);
+    next = (((head >> 16) + 1) << 16) | index;
+  } while (!_freeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+  _used.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool MemoryPool::owns(const void *ptr) const {
+  const uint8_t *p = (const uint8_t *)ptr;
+  return _blocks != 0 && p >= _blocks && p < _blocks + _slots * _blockSize;
+}
+
+const char *MemoryPool::getName() const {
+  return _name;
+}
+
+size_t MemoryPool::getBlockSize() const {
+  return _blockSize;
+}
+
+size_t MemoryPool::getSlots() const {
+  return _slots;
+}
+
+size_t MemoryPool::getUsed() const {
+  return _used.load(std::memory_order_relaxed);
+}
+
+size_t MemoryPool::getPeak() const {
+  return _peak.load(std::memory_order_relaxed);
+}
+
+uint32_t MemoryPool::getFallbacks() const {
+  return _fallbacks.load(std::memory_order_relaxed);
+}
+
+MemoryPool *MemoryPool::getFirst() {
+  return _first;
+}
+
+MemoryPool *MemoryPool::getNext() const {
+  return _next;
+}
@@ -0,0 +1,101 @@
+#ifndef MEMORY_POOL_H_
+#define MEMORY_POOL_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed number of equally sized blocks, carved out of one allocation made in
+// begin(). Objects that are created and destroyed all the time (packets,
+// display frames) come from here instead of the heap, so they can not
+// fragment it. Requests that do not fit into a block, arrive before begin()
+// or find the pool empty fall back to the heap and are counted.
+//
+// allocate() and deallocate() are lock free and may be called from
+// different FreeRTOS tasks.
+class MemoryPool {
+public:
+  // room for the std::shared_ptr control block that allocate_shared puts in front of the object
+  static const size_t SHARED_OVERHEAD = 4 * sizeof(void *);
+  static const size_t MAX_SLOTS       = 0xFFFE;
+
+  MemoryPool(const char *name, size_t blockSize);
+  ~MemoryPool();
+
+  MemoryPool(const MemoryPool &)            = delete;
+  MemoryPool &operator=(const MemoryPool &) = delete;
+
+  // allocates the blocks, only the first call has an effect
+  bool begin(size_t slots);
+
+  void *allocate(size_t size);
+  void  deallocate(void *ptr, size_t size);
+
+  const char *getName() const;
+  size_t      getBlockSize() const;
+  size_t      getSlots() const;
+  size_t      getUsed() const;
+  size_t      getPeak() const;
+  uint32_t    getFallbacks() const;
+
+  // all pools, for statistics
+  static MemoryPool *getFirst();
+  MemoryPool        *getNext() const;
+
+private:
+  static const uint16_t NO_BLOCK = 0xFFFF;
+
+  const char *_name;
+  size_t      _blockSize;
+  size_t      _slots;
+  uint8_t    *_blocks;
+
+  // free list: index of the first free block in the low, an ABA tag in the high 16 bits
+  std::atomic<uint32_t>  _freeHead;
+  std::atomic<uint16_t> *_nextFree;
+
+  std::atomic<size_t>   _used;
+  std::atomic<size_t>   _peak;
+  std::atomic<uint32_t> _fallbacks;
+
+  MemoryPool        *_next;
+  static MemoryPool *_first;
+
+  bool owns(const void *ptr) const;
+};
+
+// Minimal std allocator on top of a MemoryPool, meant for std::allocate_shared
+// so the object and its control block end up in a single pool block.
+template <typename T> class PoolAllocator {
+public:
+  typedef T value_type;
+
+  explicit PoolAllocator(MemoryPool &pool) : _pool(&pool) {
+  }
+  template <typename U> PoolAllocator(const PoolAllocator<U> &other) : _pool(other.getPool()) {
+  }
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(_pool->allocate(n * sizeof(T)));
+  }
+  void deallocate(T *ptr, size_t n) {
+    _pool->deallocate(ptr, n * sizeof(T));
+  }
+
+  MemoryPool *getPool() const {
+    return _pool;
+  }
+
+private:
+  MemoryPool *_pool;
+};
+
+template <typename T, typename U> bool operator==(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+  return a.getPool() == b.getPool();
+}
+
+template <typename T, typename U> bool operator!=(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+  return a.getPool() != b.getPool();
+}
+
+#endif
@@ -1,10 +1,37 @@
 #include "TaskManager.h"
 #include "Display/FontConfig.h"
+#include "System/MemoryPool.h"
+#include <esp_heap_caps.h>
 #include <logger.h>
 
 #define MODULE_NAME "TaskManager"
 
-TaskManager::TaskManager() {
+// a ready task that did not run for this long is picked before any other
+#define STARVATION_LIMIT_MS 1000
+// upper bound for sleeping when no task is due
+#define MAX_SLEEP_MS      20
+#define PROFILE_PERIOD_MS (5 * 60 * 1000)
+// the status frame alternates between task states and the profile
+#define PROFILE_PAGE_PERIOD_MS 5000
+
+TaskHandle_t          TaskManager::_loopTaskHandle = 0;
+std::atomic<uint32_t> Task::_stateVersion(0);
+
+void Task::setState(TaskDisplayState state) {
+  if (state != _state) {
+    _state = state;
+    _stateVersion++;
+  }
+}
+
+void Task::setStateInfo(const String &stateInfo) {
+  if (stateInfo != _stateInfo) {
+    _stateInfo = stateInfo;
+    _stateVersion++;
+  }
+}
+
+TaskManager::TaskManager() : _lastLoopStart(0), _cyclesPerMicro(1) {
 }
 
 void TaskManager::addTask(Task *task) {
@@ -31,24 +58,210 @@ bool TaskManager::setup(System &system) {
     system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, MODULE_NAME, "call setup for %s", elem->getName().c_str());
     elem->setup(system);
   }
-  _nextTask = _tasks.begin();
+  _nextTask       = _tasks.begin();
+  _loopTaskHandle = xTaskGetCurrentTaskHandle();
+  _cyclesPerMicro = ESP.getCpuFreqMHz();
+  _profileTimer.setTimeout(PROFILE_PERIOD_MS);
+  _profileTimer.start();
   return true;
 }
 
 bool TaskManager::loop(System &system) {
+  uint32_t loopStart = micros();
+  if (_lastLoopStart != 0) {
+    _loopPeriod.add(loopStart - _lastLoopStart);
+  }
+  _lastLoopStart = loopStart;
+
   for (Task *elem : _alwaysRunTasks) {
-    elem->loop(system);
+    runTask(system, elem);
+  }
+
+  uint32_t now = millis();
+  bool     ran = false;
+
+  // high priority tasks get every turn they are ready for
+  for (Task *task : _tasks) {
+    if (task->getPriority() == TaskPriorityHigh && isReady(task, now)) {
+      runTask(system, task);
+      ran = true;
+    }
+  }
+
+  // and one of the others, the highest priority ready one
+  Task *next = pickNextTask(now);
+  if (next != 0) {
+    runTask(system, next);
+    ran = true;
+  }
+
+  if (_profileTimer.check()) {
+    logProfile(system, logging::LoggerLevel::LOGGER_LEVEL_DEBUG);
+    logMemory(system, logging::LoggerLevel::LOGGER_LEVEL_DEBUG);
+    _profileTimer.start();
+  }
+
+  if (!ran) {
+    sleep(millis());
+  }
+  return ran;
+}
+
+void TaskManager::wakeup() {
+  if (_loopTaskHandle) {
+    xTaskNotifyGive(_loopTaskHandle);
+  }
+}
+
+void IRAM_ATTR TaskManager::wakeupFromISR() {
+  if (_loopTaskHandle) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(_loopTaskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+      portYIELD_FROM_ISR();
+    }
   }
+}
 
-  if (_nextTask == _tasks.end()) {
-    _nextTask = _tasks.begin();
+bool TaskManager::isReady(Task *task, uint32_t now) const {
+  if (task->hasPendingWork()) {
+    return true;
+  }
+  uint32_t deadline = task->getDeadline();
+  if (deadline != 0 && (int32_t)(now - deadline) >= 0) {
+    return true;
+  }
+  return now - task->_lastRun >= task->_pollInterval;
+}
+
+Task *TaskManager::pickNextTask(uint32_t now) {
+  if (_tasks.empty()) {
+    return 0;
+  }
+
+  // round robin starting at _nextTask, so tasks with the same priority take turns
+  std::list<Task *>::iterator best         = _tasks.end();
+  int                         bestPriority = -1;
+  std::list<Task *>::iterator it           = _nextTask;
+  for (size_t i = 0; i < _tasks.size(); i++) {
+    if (it == _tasks.end()) {
+      it = _tasks.begin();
+    }
+    Task *task = *it;
+    if (task->getPriority() != TaskPriorityHigh && isReady(task, now)) {
+      int priority = task->getPriority();
+      if (now - task->_lastRun > STARVATION_LIMIT_MS) {
+        priority = TaskPriorityHigh;
+      }
+      if (priority > bestPriority) {
+        best         = it;
+        bestPriority = priority;
+      }
+    }
+    ++it;
   }
-  bool ret = (*_nextTask)->loop(system);
+
+  if (best == _tasks.end()) {
+    return 0;
+  }
+  _nextTask = best;
   ++_nextTask;
+  return *best;
+}
+
+bool TaskManager::runTask(System &system, Task *task) {
+  // the cycle counter wraps after ~18s at 240MHz, far beyond the watchdog timeout
+  uint32_t start  = ESP.getCycleCount();
+  bool     ret    = task->loop(system);
+  uint32_t cycles = ESP.getCycleCount() - start;
+  task->_loopTime.add(cycles / _cyclesPerMicro);
+  task->_lastRun = millis();
   return ret;
 }
 
+void TaskManager::sleep(uint32_t now) {
+  // nothing is due: block until the next task wants to run or an interrupt wakes the loop, the CPU is left to the other tasks meanwhile
+  uint32_t sleepTime = MAX_SLEEP_MS;
+  for (Task *task : _tasks) {
+    if (task->hasPendingWork()) {
+      return;
+    }
+    uint32_t untilPoll = task->_lastRun + task->_pollInterval - now;
+    if ((int32_t)untilPoll <= 0) {
+      return;
+    }
+    if (untilPoll < sleepTime) {
+      sleepTime = untilPoll;
+    }
+    uint32_t deadline = task->getDeadline();
+    if (deadline != 0) {
+      int32_t untilDeadline = deadline - now;
+      if (untilDeadline <= 0) {
+        return;
+      }
+      if ((uint32_t)untilDeadline < sleepTime) {
+        sleepTime = untilDeadline;
+      }
+    }
+  }
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepTime));
+}
+
+const Histogram &TaskManager::getLoopPeriod() const {
+  return _loopPeriod;
+}
+
+void TaskManager::logProfile(System &system, logging::LoggerLevel level) {
+  for (Task const *const task : getTasks()) {
+    const Histogram &loopTime = task->getLoopTime();
+    system.getLogger().log(level, MODULE_NAME, "%s: %u runs, %llums total, min %uus, avg %uus, p99 %uus, max %uus", task->getName().c_str(), loopTime.getCount(), loopTime.getSum() / 1000, loopTime.getMin(), loopTime.getAverage(), loopTime.getPercentile(99), loopTime.getMax());
+  }
+  system.getLogger().log(level, MODULE_NAME, "main loop period: %u loops, min %uus, avg %uus, p50 %uus, p99 %uus, max %uus", _loopPeriod.getCount(), _loopPeriod.getMin(), _loopPeriod.getAverage(), _loopPeriod.getPercentile(50), _loopPeriod.getPercentile(99), _loopPeriod.getMax());
+  for (size_t i = 0; i < Histogram::BUCKETS; i++) {
+    if (_loopPeriod.getBucketCount(i) != 0) {
+      system.getLogger().log(level, MODULE_NAME, "main loop period <= %uus: %u", Histogram::upperBoundOf(i), _loopPeriod.getBucketCount(i));
+    }
+  }
+}
+
+void TaskManager::resetProfile() {
+  for (Task *task : getTasks()) {
+    task->_loopTime.reset();
+  }
+  _loopPeriod.reset();
+}
+
+void TaskManager::logMemory(System &system, logging::LoggerLevel level) {
+  const size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  const size_t largest  = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  const size_t minFree  = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  // share of the free heap that can not be handed out in one piece
+  const unsigned fragmentation = freeHeap == 0 ? 0 : 100 - largest * 100 / freeHeap;
+  system.getLogger().log(level, MODULE_NAME, "heap: %u bytes free, largest block %u, minimum free %u, fragmentation %u%%", freeHeap, largest, minFree, fragmentation);
+  for (MemoryPool const *pool = MemoryPool::getFirst(); pool != 0; pool = pool->getNext()) {
+    system.getLogger().log(level, MODULE_NAME, "pool %s: %u of %u blocks (%u bytes) used, peak %u, %u heap fallbacks", pool->getName(), pool->getUsed(), pool->getSlots(), pool->getBlockSize(), pool->getPeak(), pool->getFallbacks());
+  }
+}
+
+// 0 for the task states, 1 for the profile
+uint32_t StatusFrame::getPage() const {
+  return _showProfile ? (millis() / PROFILE_PAGE_PERIOD_MS) % 2 : 0;
+}
+
+// the profile is live, the task states only change with a task
+bool StatusFrame::hasChanged() const {
+  const uint32_t page = getPage();
+  return page != _drawnPage || page == 1 || Task::getStateVersion() != _drawnVersion;
+}
+
 void StatusFrame::drawStatusPage(Bitmap &bitmap) {
+  _drawnPage    = getPage();
+  _drawnVersion = Task::getStateVersion();
+  if (_drawnPage == 1) {
+    drawProfilePage(bitmap);
+    return;
+  }
+
   int y = 0;
   for (Task const *const task : _tasks) {
     int x = bitmap.drawString(0, y, (task->getName()).substring(0, task->getName().indexOf("Task")));
@@ -70,3 +283,16 @@ void StatusFrame::drawStatusPage(Bitmap &bitmap) {
     y += getSystemFont()->heightInPixel;
   }
 }
+
+void StatusFrame::drawProfilePage(Bitmap &bitmap) {
+  int x = bitmap.drawString(0, 0, "loop p99: ");
+  bitmap.drawString(x, 0, String(_loopPeriod.getPercentile(99) / 1000.0, 1) + "ms");
+  int y = getSystemFont()->heightInPixel;
+  for (Task const *const task : _tasks) {
+    const Histogram &loopTime = task->getLoopTime();
+    x                         = bitmap.drawString(0, y, (task->getName()).substring(0, task->getName().indexOf("Task")));
+    x                         = bitmap.drawString(x, y, ": ");
+    bitmap.drawString(x, y, String(loopTime.getAverage() / 1000.0, 1) + "/" + String(loopTime.getMax() / 1000.0, 1) + "ms");
+    y += getSystemFont()->heightInPixel;
+  }
+}
@@ -2,12 +2,15 @@
 #define TASK_MANAGER_H_
 
 #include <Arduino.h>
+#include <atomic>
 #include <list>
 #include <memory>
 
 #include "BoardFinder/BoardFinder.h"
 #include "ConfigurationManagement/configuration.h"
 #include "Display/Display.h"
+#include "System/Histogram.h"
+#include "System/Timer.h"
 
 #include "TaskQueue.h"
 
@@ -19,11 +22,17 @@ enum TaskDisplayState {
   Okay,
 };
 
+enum TaskPriority {
+  TaskPriorityLow,
+  TaskPriorityNormal,
+  TaskPriorityHigh,
+};
+
 class Task {
 public:
-  Task(String &name, int taskId) : _state(Okay), _stateInfo("Booting"), _name(name), _taskId(taskId) {
+  Task(String &name, int taskId, TaskPriority priority = TaskPriorityNormal) : _pollInterval(0), _state(Okay), _stateInfo("Booting"), _name(name), _taskId(taskId), _priority(priority), _lastRun(0) {
   }
-  Task(const char *name, int taskId) : _state(Okay), _stateInfo("Booting"), _name(name), _taskId(taskId) {
+  Task(const char *name, int taskId, TaskPriority priority = TaskPriorityNormal) : _pollInterval(0), _state(Okay), _stateInfo("Booting"), _name(name), _taskId(taskId), _priority(priority), _lastRun(0) {
   }
   virtual ~Task() {
   }
@@ -42,16 +51,59 @@ public:
     return _stateInfo;
   }
 
+  TaskPriority getPriority() const {
+    return _priority;
+  }
+
+  // profiler statistics, loop durations in micro seconds
+  uint32_t getRunCount() const {
+    return _loopTime.getCount();
+  }
+  uint64_t getRunTime() const {
+    return _loopTime.getSum();
+  }
+  const Histogram &getLoopTime() const {
+    return _loopTime;
+  }
+
   virtual bool setup(System &system) = 0;
   virtual bool loop(System &system)  = 0;
 
+  // Scheduling hints: a task is run if it has pending work, its deadline
+  // (a millis() timestamp, 0 for none) has passed or its poll interval
+  // elapsed. Tasks without hints keep the poll interval of 0 and run on
+  // every scheduler turn.
+  virtual bool hasPendingWork() const {
+    return false;
+  }
+  virtual uint32_t getDeadline() const {
+    return 0;
+  }
+
+  // bumped on every change of a task state, the status page is only redrawn when it moved
+  static uint32_t getStateVersion() {
+    return _stateVersion;
+  }
+
 protected:
+  uint32_t _pollInterval;
+
+  // setting the same value again is no change
+  void setState(TaskDisplayState state);
+  void setStateInfo(const String &stateInfo);
+
+private:
   TaskDisplayState _state;
   String           _stateInfo;
+  String           _name;
+  int              _taskId;
+  TaskPriority     _priority;
+  uint32_t         _lastRun;
+  Histogram        _loopTime;
 
-private:
-  String _name;
-  int    _taskId;
+  static std::atomic<uint32_t> _stateVersion;
+
+  friend class TaskManager;
 };
 
 class TaskManager {
@@ -67,22 +119,54 @@ public:
   bool setup(System &system);
   bool loop(System &system);
 
+  // cut a scheduler sleep short, e.g. when another FreeRTOS task queued work
+  static void wakeup();
+  static void wakeupFromISR();
+
+  // profiler: loop durations of every task and the period of the main loop
+  const Histogram &getLoopPeriod() const;
+  void             logProfile(System &system, logging::LoggerLevel level);
+  void             resetProfile();
+
+  // heap fragmentation and memory pool usage
+  void logMemory(System &system, logging::LoggerLevel level);
+
 private:
   std::list<Task *>           _tasks;
   std::list<Task *>::iterator _nextTask;
   std::list<Task *>           _alwaysRunTasks;
+  Timer                       _profileTimer;
+  Histogram                   _loopPeriod;
+  uint32_t                    _lastLoopStart;
+  uint32_t                    _cyclesPerMicro;
+
+  static TaskHandle_t _loopTaskHandle;
+
+  bool  isReady(Task *task, uint32_t now) const;
+  Task *pickNextTask(uint32_t now);
+  bool  runTask(System &system, Task *task);
+  void  sleep(uint32_t now);
 };
 
 class StatusFrame : public DisplayFrame {
 public:
-  explicit StatusFrame(const std::list<Task *> &tasks) : _tasks(tasks) {
+  StatusFrame(const std::list<Task *> &tasks, const Histogram &loopPeriod, bool showProfile) : _tasks(tasks), _loopPeriod(loopPeriod), _showProfile(showProfile), _drawnVersion(0), _drawnPage(0) {
   }
   virtual ~StatusFrame() {
   }
   void drawStatusPage(Bitmap &bitmap) override;
+  bool hasChanged() const override;
 
 private:
   std::list<Task *> _tasks;
+  const Histogram  &_loopPeriod;
+  bool              _showProfile;
+  uint32_t          _drawnVersion;
+  uint32_t          _drawnPage;
+
+  uint32_t getPage() const;
+
+  void drawProfilePage(Bitmap &bitmap);
 };
 
 #include "System.h"
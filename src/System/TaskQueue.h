@@ -1,29 +1,167 @@
 #ifndef TASK_QUEUE_H_
 #define TASK_QUEUE_H_
 
-#include <list>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+// What addElement() does when the queue is full.
+enum class TaskQueueOverflow {
+  DropOldest, // evict the oldest element to make room for the new one
+  DropNewest, // discard the new element, addElement() still reports success
+  Reject,     // refuse the new element, addElement() returns false
+};
+
+// Fixed-capacity ring buffer used to hand elements from one task to another.
+//
+// One producer and one consumer may use the queue concurrently (e.g. an ISR
+// driven FreeRTOS task and the Arduino loop) without any lock. Every slot
+// carries a sequence number, so the producer can safely take the oldest
+// element away from the consumer when it has to evict on overflow.
+template <typename T, size_t Capacity = 16> class TaskQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "TaskQueue capacity has to be a power of two");
 
-template <typename T> class TaskQueue {
 public:
-  TaskQueue() {
+  explicit TaskQueue(TaskQueueOverflow policy = TaskQueueOverflow::DropOldest) : _policy(policy), _enqueuePos(0), _dequeuePos(0), _dropped(0), _rejected(0), _highWatermark(0) {
+    for (size_t i = 0; i < Capacity; i++) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
   }
 
-  void addElement(T elem) {
-    _elements.push_back(elem);
+  TaskQueue(const TaskQueue &)            = delete;
+  TaskQueue &operator=(const TaskQueue &) = delete;
+
+  // producer side
+  bool addElement(T elem) {
+    if (push(elem)) {
+      return true;
+    }
+    switch (_policy) {
+    case TaskQueueOverflow::DropOldest: {
+      T oldest;
+      if (pop(oldest)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        if (push(elem)) {
+          return true;
+        }
+      }
+      // the consumer is just taking the slot we need, drop the new one instead
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    case TaskQueueOverflow::DropNewest:
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    case TaskQueueOverflow::Reject:
+    default:
+      _rejected.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
   }
 
+  // consumer side, returns a default constructed element if the queue is empty
   T getElement() {
-    T elem = _elements.front();
-    _elements.pop_front();
+    T elem = T();
+    pop(elem);
     return elem;
   }
 
   bool empty() const {
-    return _elements.empty();
+    return size() == 0;
+  }
+
+  size_t size() const {
+    const size_t dequeuePos = _dequeuePos.load(std::memory_order_acquire);
+    const size_t enqueuePos = _enqueuePos.load(std::memory_order_acquire);
+    const size_t size       = enqueuePos - dequeuePos;
+    return size > Capacity ? 0 : size;
+  }
+
+  static constexpr size_t capacity() {
+    return Capacity;
+  }
+
+  TaskQueueOverflow getOverflowPolicy() const {
+    return _policy;
+  }
+
+  void setOverflowPolicy(TaskQueueOverflow policy) {
+    _policy = policy;
+  }
+
+  // number of elements lost by DropOldest / DropNewest
+  uint32_t getDroppedCount() const {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  // number of elements refused by Reject
+  uint32_t getRejectedCount() const {
+    return _rejected.load(std::memory_order_relaxed);
+  }
+
+  // highest fill level seen since construction
+  size_t getHighWatermark() const {
+    return _highWatermark.load(std::memory_order_relaxed);
   }
 
 private:
-  std::list<T> _elements;
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T                   data;
+  };
+
+  bool push(T &elem) {
+    const size_t pos      = _enqueuePos.load(std::memory_order_relaxed);
+    Slot        &slot     = _slots[pos & (Capacity - 1)];
+    const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != pos) {
+      // slot still holds an element (or is being read): full
+      return false;
+    }
+    slot.data = std::move(elem);
+    slot.sequence.store(pos + 1, std::memory_order_release);
+    _enqueuePos.store(pos + 1, std::memory_order_release);
+
+    const size_t fill = pos + 1 - _dequeuePos.load(std::memory_order_relaxed);
+    if (fill <= Capacity && fill > _highWatermark.load(std::memory_order_relaxed)) {
+      _highWatermark.store(fill, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // called by the consumer and, on DropOldest overflow, by the producer
+  bool pop(T &elem) {
+    size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    Slot  *slot;
+    while (true) {
+      slot                  = &_slots[pos & (Capacity - 1)];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff   = (intptr_t)sequence - (intptr_t)(pos + 1);
+      if (diff == 0) {
+        if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = _dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    elem       = std::move(slot->data);
+    slot->data = T();
+    slot->sequence.store(pos + Capacity, std::memory_order_release);
+    return true;
+  }
+
+  TaskQueueOverflow _policy;
+  Slot              _slots[Capacity];
+
+  std::atomic<size_t>   _enqueuePos;
+  std::atomic<size_t>   _dequeuePos;
+  std::atomic<uint32_t> _dropped;
+  std::atomic<uint32_t> _rejected;
+  std::atomic<size_t>   _highWatermark;
 };
 
 #endif
@@ -13,6 +13,11 @@ uint32_t Timer::getTriggerTimeInSec() const {
   return (_nextTimeout - millis()) / 1000;
 }
 
+// absolute millis() timestamp of the next timeout, 0 if not started
+uint32_t Timer::getTriggerTime() const {
+  return _nextTimeout;
+}
+
 bool Timer::isActive() const {
   return _nextTimeout != 0;
 }
@@ -21,7 +26,7 @@ void Timer::reset() {
   _nextTimeout = 0;
 }
 
-bool Timer::check() {
+bool Timer::check() const {
   return millis() > _nextTimeout;
 }
 
@@ -7,12 +7,13 @@ public:
 
   void     setTimeout(const uint32_t timeout_ms);
   uint32_t getTriggerTimeInSec() const;
+  uint32_t getTriggerTime() const;
 
   bool isActive() const;
 
   void reset();
 
-  bool check();
+  bool check() const;
   void start();
 
 private:
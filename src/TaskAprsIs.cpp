@@ -1,67 +1,121 @@
+#include <esp_system.h>
 #include <logger.h>
 
 #include "Task.h"
 #include "TaskAprsIs.h"
 #include "project_configuration.h"
 
-AprsIsTask::AprsIsTask(TaskQueue<std::shared_ptr<APRSMessage>> &toAprsIs, TaskQueue<std::shared_ptr<APRSMessage>> &toModem) : Task(TASK_APRS_IS, TaskAprsIs), _toAprsIs(toAprsIs), _toModem(toModem) {
+AprsIsTask::AprsIsTask(TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs, TaskQueue<std::shared_ptr<AprsPacket>> &fromAprsIs) : Task(TASK_APRS_IS, TaskAprsIs), _toAprsIs(toAprsIs), _fromAprsIs(fromAprsIs), _lastState(APRS_IS::Idle) {
 }
 
 AprsIsTask::~AprsIsTask() {
 }
 
 bool AprsIsTask::setup(System &system) {
-  _aprs_is.setup(system.getUserConfig()->callsign, system.getUserConfig()->aprs_is.passcode, "ESP32-APRS-IS", "0.2");
+  const Configuration::APRS_IS &config = system.getUserConfig()->aprs_is;
+  _aprs_is.setup(system.getUserConfig()->callsign.c_str(), config.passcode.c_str(), "ESP32-APRS-IS", "0.2", config.filter.c_str());
+  _aprs_is.setRandomSeed(esp_random());
+  if (!_aprs_is.addServer(config.server.c_str(), config.port)) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "invalid APRS-IS server: '%s'", config.server.c_str());
+  }
+  for (String server : config.failoverServers) {
+    if (!_aprs_is.addServer(server.c_str(), config.port)) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "failover server '%s' not used", server.c_str());
+    }
+  }
+  _pollInterval = 100;
+  _reportTimer.setTimeout(5 * 60 * 1000);
+  _reportTimer.start();
   return true;
 }
 
+bool AprsIsTask::hasPendingWork() const {
+  return (_aprs_is.canSend() && !_toAprsIs.empty()) || _aprs_is.hasReceivedLine();
+}
+
+uint32_t AprsIsTask::getDeadline() const {
+  return _aprs_is.getFlushDeadline();
+}
+
 bool AprsIsTask::loop(System &system) {
   if (!system.isWifiOrEthConnected()) {
+    if (_aprs_is.getState() != APRS_IS::Idle) {
+      _aprs_is.disconnect();
+      reportState(system);
+    }
     return false;
   }
+
+  _aprs_is.loop(millis());
+  reportState(system);
   if (!_aprs_is.connected()) {
-    if (!connect(system)) {
-      _stateInfo = "not connected";
-      _state     = Error;
-      return false;
-    }
-    _stateInfo = "connected";
-    _state     = Okay;
     return false;
   }
 
-  {
-    std::shared_ptr<APRSMessage> msg = _aprs_is.getAPRSMessage();
-    if (msg) {
-      _toModem.addElement(msg);
+  // drain a burst from the server, the rest waits for the next turn
+  for (size_t i = 0; i < RECEIVE_BUDGET; i++) {
+    std::shared_ptr<AprsPacket> msg = _aprs_is.getAprsPacket();
+    if (!msg) {
+      break;
     }
+    _fromAprsIs.addElement(msg);
   }
 
-  if (!_toAprsIs.empty()) {
-    std::shared_ptr<APRSMessage> msg = _toAprsIs.getElement();
+  // queue everything that fits, loop() sends it as one batch
+  while (!_toAprsIs.empty() && _aprs_is.canSend()) {
+    std::shared_ptr<AprsPacket> msg = _toAprsIs.getElement();
     _aprs_is.sendMessage(msg);
   }
 
+  if (_reportTimer.check()) {
+    reportFlush(system);
+    _reportTimer.start();
+  }
+
   return true;
 }
 
-bool AprsIsTask::connect(System &system) {
-  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "connecting to APRS-IS server: %s on port: %d, with filter: '%s'", system.getUserConfig()->aprs_is.server.c_str(), system.getUserConfig()->aprs_is.port, system.getUserConfig()->aprs_is.filter.c_str());
-  APRS_IS::ConnectionStatus status = APRS_IS::ConnectionStatus::ERROR_CONNECTION;
-  if (system.getUserConfig()->aprs_is.filter.isEmpty()) {
-    status = _aprs_is.connect(system.getUserConfig()->aprs_is.server, system.getUserConfig()->aprs_is.port);
-  } else {
-    status = _aprs_is.connect(system.getUserConfig()->aprs_is.server, system.getUserConfig()->aprs_is.port, system.getUserConfig()->aprs_is.filter);
+void AprsIsTask::reportFlush(System &system) {
+  const Histogram &bytes   = _aprs_is.getFlushBytes();
+  const Histogram &packets = _aprs_is.getFlushPackets();
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "flush: %u batches, %llu packets, %llu bytes; per flush avg %u packets / %u bytes, max %u packets / %u bytes; %u dropped", bytes.getCount(), packets.getSum(), bytes.getSum(), packets.getAverage(), bytes.getAverage(), packets.getMax(), bytes.getMax(), _aprs_is.getSendDropped());
+}
+
+void AprsIsTask::reportState(System &system) {
+  const APRS_IS::State state    = _aprs_is.getState();
+  const APRS_IS::State previous = _lastState;
+  if (state == previous) {
+    return;
   }
-  if (status == APRS_IS::ERROR_CONNECTION) {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "Something went wrong on connecting! Is the server reachable?");
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "Connection failed.");
-    return false;
-  } else if (status == APRS_IS::ERROR_PASSCODE) {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "User can not be verified with passcode!");
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "Connection failed.");
-    return false;
+  _lastState = state;
+
+  switch (state) {
+  case APRS_IS::Resolving:
+  case APRS_IS::Connecting:
+    if (previous == APRS_IS::Resolving) {
+      break;
+    }
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "connecting to APRS-IS server: %s on port: %d, with filter: '%s'", _aprs_is.getServer(), _aprs_is.getPort(), system.getUserConfig()->aprs_is.filter.c_str());
+    setStateInfo("connecting");
+    setState(Warning);
+    break;
+  case APRS_IS::LoggingIn:
+    setStateInfo("logging in");
+    setState(Warning);
+    break;
+  case APRS_IS::Connected:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "Connected to APRS-IS server %s!", _aprs_is.getServer());
+    setStateInfo("connected");
+    setState(Okay);
+    break;
+  case APRS_IS::Backoff:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "Connection failed: %s, retry in %u s.", APRS_IS::toString(_aprs_is.getLastError()), _aprs_is.getBackoffDelay() / 1000);
+    setStateInfo(APRS_IS::toString(_aprs_is.getLastError()));
+    setState(Error);
+    break;
+  case APRS_IS::Idle:
+    setStateInfo("not connected");
+    setState(Error);
+    break;
   }
-  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "Connected to APRS-IS server!");
-  return true;
 }
@@ -4,23 +4,31 @@
 #include "APRS-IS/APRS-IS.h"
 #include "System/TaskManager.h"
 #include "System/Timer.h"
-#include <APRSMessage.h>
 
 class AprsIsTask : public Task {
 public:
-  explicit AprsIsTask(TaskQueue<std::shared_ptr<APRSMessage>> &toAprsIs, TaskQueue<std::shared_ptr<APRSMessage>> &toModem);
+  // packets taken from the server per loop
+  static const size_t RECEIVE_BUDGET = 16;
+
+  explicit AprsIsTask(TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs, TaskQueue<std::shared_ptr<AprsPacket>> &fromAprsIs);
   virtual ~AprsIsTask();
 
-  virtual bool setup(System &system) override;
-  virtual bool loop(System &system) override;
+  virtual bool     setup(System &system) override;
+  virtual bool     loop(System &system) override;
+  virtual bool     hasPendingWork() const override;
+  virtual uint32_t getDeadline() const override;
 
 private:
   APRS_IS _aprs_is;
 
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toAprsIs;
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_toAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_fromAprsIs;
+
+  APRS_IS::State _lastState;
+  Timer          _reportTimer;
 
-  bool connect(System &system);
+  void reportState(System &system);
+  void reportFlush(System &system);
 };
 
 #endif
@@ -7,7 +7,7 @@
 #include "TaskBeacon.h"
 #include "project_configuration.h"
 
-BeaconTask::BeaconTask(TaskQueue<std::shared_ptr<APRSMessage>> &toModem, TaskQueue<std::shared_ptr<APRSMessage>> &toAprsIs) : Task(TASK_BEACON, TaskBeacon), _toModem(toModem), _toAprsIs(toAprsIs), _ss(1), _useGps(false) {
+BeaconTask::BeaconTask(TxQueue &toModem, TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs) : Task(TASK_BEACON, TaskBeacon), _toModem(toModem), _toAprsIs(toAprsIs), _ss(1), _useGps(false), _countdown(UINT32_MAX) {
 }
 
 BeaconTask::~BeaconTask() {
@@ -41,9 +41,14 @@ bool BeaconTask::setup(System &system) {
   // setup beacon
   _beacon_timer.setTimeout(system.getUserConfig()->beacon.timeout * 60 * 1000);
 
-  _beaconMsg = std::shared_ptr<APRSMessage>(new APRSMessage());
-  _beaconMsg->setSource(system.getUserConfig()->callsign);
-  _beaconMsg->setDestination("APLG01");
+  // the button needs frequent ticks for debouncing, GPS only has to be read before the UART buffer fills up
+  if (system.getBoardConfig()->Button.Pin != -1) {
+    _pollInterval = 20;
+  } else if (_useGps) {
+    _pollInterval = 100;
+  } else {
+    _pollInterval = 1000;
+  }
 
   return true;
 }
@@ -66,12 +71,24 @@ bool BeaconTask::loop(System &system) {
     }
   }
 
+  // the countdown on the status page changes once a second, not on every loop
   uint32_t diff = _beacon_timer.getTriggerTimeInSec();
-  _stateInfo    = "beacon " + String(uint32_t(diff / 600)) + String(uint32_t(diff / 60) % 10) + ":" + String(uint32_t(diff / 10) % 6) + String(uint32_t(diff % 10));
+  if (diff != _countdown) {
+    _countdown = diff;
+    setStateInfo("beacon " + String(uint32_t(diff / 600)) + String(uint32_t(diff / 60) % 10) + ":" + String(uint32_t(diff / 10) % 6) + String(uint32_t(diff % 10)));
+  }
 
   return true;
 }
 
+bool BeaconTask::hasPendingWork() const {
+  return _send_update;
+}
+
+uint32_t BeaconTask::getDeadline() const {
+  return _beacon_timer.getTriggerTime();
+}
+
 String create_lat_aprs(double lat) {
   char str[20];
   char n_s = 'N';
@@ -108,19 +125,25 @@ bool BeaconTask::sendBeacon(System &system) {
       return false;
     }
   }
-  _beaconMsg->getBody()->setData(String("=") + create_lat_aprs(lat) + "L" + create_long_aprs(lng) + "&" + system.getUserConfig()->beacon.message);
+  // a new packet every time, the previous one may still wait in a queue
+  std::shared_ptr<AprsPacket> beaconMsg = AprsPacket::create();
+  String                      line      = system.getUserConfig()->callsign + ">APLG01:=" + create_lat_aprs(lat) + "L" + create_long_aprs(lng) + "&" + system.getUserConfig()->beacon.message;
+  if (!beaconMsg->decode(line.c_str(), line.length())) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] beacon does not fit into a packet: %s", timeString().c_str(), line.c_str());
+    return true;
+  }
 
-  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] %s", timeString().c_str(), _beaconMsg->encode().c_str());
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] %s", timeString().c_str(), beaconMsg->c_str());
 
   if (system.getUserConfig()->aprs_is.active) {
-    _toAprsIs.addElement(_beaconMsg);
+    _toAprsIs.addElement(beaconMsg);
   }
 
   if (system.getUserConfig()->beacon.send_on_hf) {
-    _toModem.addElement(_beaconMsg);
+    _toModem.push(beaconMsg, TxClassBeacon, millis());
   }
 
-  system.getDisplay().addFrame(std::shared_ptr<DisplayFrame>(new TextFrame("BEACON", _beaconMsg->toString())));
+  system.getDisplay().addFrame(TextFrame::create("BEACON", beaconMsg->c_str()));
 
   return true;
 }
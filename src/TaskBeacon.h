@@ -4,25 +4,28 @@
 #include <OneButton.h>
 #include <TinyGPS++.h>
 
+#include "LoRa/TxQueue.h"
+#include "Packet/AprsPacket.h"
 #include "System/TaskManager.h"
-#include <APRSMessage.h>
 #include <TaskMQTT.h>
 
 class BeaconTask : public Task {
 public:
-  BeaconTask(TaskQueue<std::shared_ptr<APRSMessage>> &toModem, TaskQueue<std::shared_ptr<APRSMessage>> &toAprsIs);
+  BeaconTask(TxQueue &toModem, TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs);
   virtual ~BeaconTask();
 
   virtual bool setup(System &system) override;
-  virtual bool loop(System &system) override;
-  bool         sendBeacon(System &system);
+  virtual bool     loop(System &system) override;
+  virtual bool     hasPendingWork() const override;
+  virtual uint32_t getDeadline() const override;
+  bool             sendBeacon(System &system);
 
 private:
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toModem;
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toAprsIs;
+  TxQueue                                &_toModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_toAprsIs;
 
-  std::shared_ptr<APRSMessage> _beaconMsg;
-  Timer                        _beacon_timer;
+  Timer    _beacon_timer;
+  uint32_t _countdown;
 
   HardwareSerial _ss;
   TinyGPSPlus    _gps;
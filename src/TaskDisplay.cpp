@@ -3,7 +3,7 @@
 #include "TaskDisplay.h"
 #include "project_configuration.h"
 
-DisplayTask::DisplayTask() : Task("DisplayTask", 0) {
+DisplayTask::DisplayTask() : Task("DisplayTask", 0), _display(0), _lastBytesSent(0) {
 }
 
 DisplayTask::~DisplayTask() {
@@ -14,13 +14,24 @@ bool DisplayTask::setup(System &system) {
   if (system.getUserConfig()->display.turn180) {
     system.getDisplay().turn180();
   }
-  std::shared_ptr<StatusFrame> statusFrame = std::shared_ptr<StatusFrame>(new StatusFrame(system.getTaskManager().getTasks()));
+  std::shared_ptr<StatusFrame> statusFrame = std::shared_ptr<StatusFrame>(new StatusFrame(system.getTaskManager().getTasks(), system.getTaskManager().getLoopPeriod(), system.getUserConfig()->display.showProfile));
   system.getDisplay().setStatusFrame(statusFrame);
   if (!system.getUserConfig()->display.alwaysOn) {
     system.getDisplay().activateDisplaySaveMode();
     system.getDisplay().setDisplaySaveTimeout(system.getUserConfig()->display.timeout);
   }
-  _stateInfo = system.getUserConfig()->callsign;
+  // one more frame is alive while it is created and handed over, the rest would come from the heap
+  const int poolLimit  = system.getUserConfig()->memory.framePool - 1;
+  int       frameLimit = system.getUserConfig()->display.frameLimit;
+  if (frameLimit > poolLimit) {
+    frameLimit = poolLimit;
+  }
+  system.getDisplay().setFrameLimit(frameLimit > 0 ? frameLimit : 1);
+  setStateInfo(system.getUserConfig()->callsign);
+  _display      = &system.getDisplay();
+  _pollInterval = system.getUserConfig()->display.overwritePin != 0 ? PIN_POLL_MS : IDLE_POLL_MS;
+  _reportTimer.setTimeout(REPORT_PERIOD_MS);
+  _reportTimer.start();
   return true;
 }
 
@@ -29,5 +40,25 @@ bool DisplayTask::loop(System &system) {
     system.getDisplay().activateDistplay();
   }
   system.getDisplay().update();
+  if (_reportTimer.check()) {
+    report(system);
+    _reportTimer.start();
+  }
   return true;
 }
+
+bool DisplayTask::hasPendingWork() const {
+  return _display != 0 && _display->hasPendingUpdate();
+}
+
+uint32_t DisplayTask::getDeadline() const {
+  return _display != 0 ? _display->getNextUpdate() : 0;
+}
+
+void DisplayTask::report(System &system) {
+  const Display   &display    = system.getDisplay();
+  const Histogram &renderTime = display.getRenderTime();
+  const uint32_t   bytesSent  = display.getBytesSent();
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "%u frames sent, %u unchanged, %u bytes/s over I2C, render avg %u us / max %u us, %u queued frames replaced, %u dropped", display.getFramesSent(), display.getFramesUnchanged(), (bytesSent - _lastBytesSent) / (REPORT_PERIOD_MS / 1000), renderTime.getAverage(), renderTime.getMax(), display.getFramesReplaced(), display.getFramesDropped());
+  _lastBytesSent = bytesSent;
+}
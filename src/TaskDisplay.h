@@ -3,14 +3,29 @@
 
 #include "Display/Display.h"
 #include "System/TaskManager.h"
+#include "System/Timer.h"
 
 class DisplayTask : public Task {
 public:
   DisplayTask();
   virtual ~DisplayTask();
 
-  virtual bool setup(System &system) override;
-  virtual bool loop(System &system) override;
+  virtual bool     setup(System &system) override;
+  virtual bool     loop(System &system) override;
+  virtual bool     hasPendingWork() const override;
+  virtual uint32_t getDeadline() const override;
+
+private:
+  static const uint32_t REPORT_PERIOD_MS = 5 * 60 * 1000;
+  // changes and display timers come as hints, polling is only needed for the overwrite pin and the report
+  static const uint32_t PIN_POLL_MS  = 100;
+  static const uint32_t IDLE_POLL_MS = 60 * 1000;
+
+  Display *_display;
+  Timer    _reportTimer;
+  uint32_t _lastBytesSent;
+
+  void report(System &system);
 };
 
 #endif
@@ -106,12 +106,12 @@ bool EthTask::setup(System &system) {
 bool EthTask::loop(System &system) {
   if (!eth_connected) {
     system.connectedViaEth(false);
-    _stateInfo = "Ethernet not connected";
-    _state     = Error;
+    setStateInfo("Ethernet not connected");
+    setState(Error);
     return false;
   }
   system.connectedViaEth(true);
-  _stateInfo = ETH.localIP().toString();
-  _state     = Okay;
+  setStateInfo(ETH.localIP().toString());
+  setState(Okay);
   return true;
 }
@@ -6,7 +6,7 @@
 #include "TaskFTP.h"
 #include "project_configuration.h"
 
-FTPTask::FTPTask() : Task(TASK_FTP, TaskFtp), _beginCalled(false) {
+FTPTask::FTPTask() : Task(TASK_FTP, TaskFtp, TaskPriorityLow), _beginCalled(false) {
 }
 
 FTPTask::~FTPTask() {
@@ -18,7 +18,8 @@ bool FTPTask::setup(System &system) {
     _ftpServer.addUser(user.name, user.password);
   }
   _ftpServer.addFilesystem("SPIFFS", &SPIFFS);
-  _stateInfo = "waiting";
+  setStateInfo("waiting");
+  _pollInterval = 10;
   return true;
 }
 
@@ -35,7 +36,7 @@ bool FTPTask::loop(System &system) {
   }
   if (_ftpServer.countConnections() > 0) {
     configWasOpen = true;
-    _stateInfo    = "has connection";
+    setStateInfo("has connection");
   }
   return true;
 }
@@ -1,58 +1,236 @@
+#include <SPIFFS.h>
 #include <logger.h>
 
 #include "Task.h"
 #include "TaskMQTT.h"
 #include "project_configuration.h"
 
-#include <ArduinoJson.h>
+#include <APRSMessage.h>
 
-MQTTTask::MQTTTask(TaskQueue<std::shared_ptr<APRSMessage>> &toMQTT) : Task(TASK_MQTT, TaskMQTT), _toMQTT(toMQTT), _MQTT(_client) {
+static const char *SPILL_FILE = "/mqtt_spool.bin";
+
+MQTTTask::MQTTTask(TaskQueue<std::shared_ptr<AprsPacket>> &toMQTT) : Task(TASK_MQTT, TaskMQTT), _toMQTT(toMQTT), _MQTT(_client), _format(MqttFormatJson), _typeNameCount(0), _tooLong(0), _connected(false), _spillLimit(0), _spillSize(0), _spillRead(0), _spilled(0), _spillDropped(0) {
 }
 
 MQTTTask::~MQTTTask() {
 }
 
 bool MQTTTask::setup(System &system) {
-  _MQTT.setServer(system.getUserConfig()->mqtt.server.c_str(), system.getUserConfig()->mqtt.port);
+  const Configuration::MQTT &config = system.getUserConfig()->mqtt;
+  _MQTT.setServer(config.server.c_str(), config.port);
+  _pollInterval = 100;
+
+  // the topic never changes, build it once instead of per message
+  _topic = config.topic;
+  if (!_topic.endsWith("/")) {
+    _topic += "/";
+  }
+  _topic += system.getUserConfig()->callsign;
+
+  if (!MqttPayload::parseFormat(config.format.c_str(), _format)) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "unknown format '%s', using %s", config.format.c_str(), MqttPayload::toString(_format));
+  }
+  // PubSubClient builds the whole MQTT packet in its buffer: fixed header, topic and payload
+  _MQTT.setBufferSize(5 + 2 + _topic.length() + PAYLOAD_SIZE);
+
+  if (!_spool.begin(config.spool_size * 1024)) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "no memory for a %u KB spool", config.spool_size);
+    return false;
+  }
+  _spool.setRate(config.replay_rate, MAX_PER_LOOP, millis());
+
+  // a spill left from before a restart is still replayed
+  _spillLimit = config.spool_flash * 1024;
+  if (SPIFFS.exists(SPILL_FILE)) {
+    File file = SPIFFS.open(SPILL_FILE, FILE_READ);
+    if (_spillLimit > 0 && file) {
+      _spillSize = file.size();
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "replaying %u bytes spooled in flash", _spillSize);
+    }
+    file.close();
+    if (_spillSize == 0) {
+      SPIFFS.remove(SPILL_FILE);
+    }
+  }
+
+  _reportTimer.setTimeout(5 * 60 * 1000);
+  _reportTimer.start();
   return true;
 }
 
+bool MQTTTask::hasPendingWork() const {
+  if (!_toMQTT.empty()) {
+    return true;
+  }
+  const uint32_t now = millis();
+  return _connected && _spool.getPending() > 0 && (int32_t)(_spool.getNextSend(now) - now) <= 0;
+}
+
+uint32_t MQTTTask::getDeadline() const {
+  if (!_connected) {
+    return 0;
+  }
+  return _spool.getNextSend(millis());
+}
+
 bool MQTTTask::loop(System &system) {
+  // every message goes through the spool, packets are kept while the broker is away
+  for (size_t i = 0; i < MAX_PER_LOOP && !_toMQTT.empty(); i++) {
+    enqueue(system, *_toMQTT.getElement());
+  }
+  if (_spillSize > 0 && _spool.getUsedBytes() < _spool.getCapacity() / 2) {
+    unspill();
+  }
+  if (_reportTimer.check()) {
+    report(system);
+    _reportTimer.start();
+  }
+
   if (!system.isWifiOrEthConnected()) {
+    disconnected(system);
     return false;
   }
 
   if (!_MQTT.connected()) {
-    connect(system);
+    disconnected(system);
+    if (!connect(system)) {
+      return false;
+    }
   }
-
-  if (!_toMQTT.empty()) {
-    std::shared_ptr<APRSMessage> msg = _toMQTT.getElement();
-
-    DynamicJsonDocument data(1024);
-    data["source"]      = msg->getSource();
-    data["destination"] = msg->getDestination();
-    data["path"]        = msg->getPath();
-    data["type"]        = msg->getType().toString();
-    String body         = msg->getBody()->encode();
-    body.replace("\n", "");
-    data["data"] = body;
-
-    String r;
-    serializeJson(data, r);
-
-    String topic = String(system.getUserConfig()->mqtt.topic);
-    if (!topic.endsWith("/")) {
-      topic = topic + "/";
+  if (!_connected) {
+    _connected = true;
+    if (_spool.getPending() > 0 || _spillSize > 0) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "replaying %u spooled messages (%u bytes in flash)", _spool.getPending(), _spillSize - _spillRead);
     }
-    topic = topic + system.getUserConfig()->callsign;
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "Send MQTT with topic: '%s', data: %s", topic.c_str(), r.c_str());
-    _MQTT.publish(topic.c_str(), r.c_str());
   }
+
+  publish(system);
   _MQTT.loop();
   return true;
 }
 
+void MQTTTask::enqueue(System &system, const AprsPacket &packet) {
+  const size_t length = MqttPayload::encode(_format, packet, typeName(packet.getBody()), _payload, sizeof(_payload));
+  if (length == 0) {
+    _tooLong++;
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "packet too long for MQTT (%u so far): %s", _tooLong, packet.c_str());
+    return;
+  }
+  if (_format == MqttFormatJson) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "Send MQTT with topic: '%s', data: %s", _topic.c_str(), _payload);
+  } else {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "Send MQTT with topic: '%s', %u bytes %s", _topic.c_str(), length, MqttPayload::toString(_format));
+  }
+
+  // once anything is spilled, newer messages follow it to keep the order
+  if (_spillLimit > 0 && (_spillSize > 0 || !_spool.hasRoom(length))) {
+    if (!spill(_payload, length)) {
+      _spillDropped++;
+    }
+    return;
+  }
+  _spool.push(_payload, length);
+}
+
+void MQTTTask::publish(System &system) {
+  const uint32_t now = millis();
+  _spool.confirm(now);
+  for (size_t i = 0; i < MAX_PER_LOOP && _spool.canSend(now); i++) {
+    const size_t length = _spool.peek(_payload, sizeof(_payload));
+    if (!_MQTT.publish(_topic.c_str(), (const uint8_t *)_payload, length)) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "publish failed, %u messages kept", _spool.getPending());
+      break;
+    }
+    _spool.sent(now);
+  }
+}
+
+// nothing written since the last confirm is known to have arrived
+void MQTTTask::disconnected(System &system) {
+  if (!_connected) {
+    return;
+  }
+  _connected = false;
+  if (_spool.getInFlight() > 0) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "connection lost, %u messages are sent again", _spool.getInFlight());
+  }
+  _spool.resend();
+}
+
+bool MQTTTask::spill(const char *data, size_t length) {
+  if (_spillSize + SPILL_HEADER + length > _spillLimit) {
+    return false;
+  }
+  File file = SPIFFS.open(SPILL_FILE, FILE_APPEND);
+  if (!file) {
+    return false;
+  }
+  const uint8_t header[SPILL_HEADER] = {(uint8_t)(length >> 8), (uint8_t)(length & 0xff)};
+  size_t        written              = file.write(header, sizeof(header));
+  written += file.write((const uint8_t *)data, length);
+  file.close();
+  // a short write leaves a broken record, unspill() discards from there on
+  _spillSize += written;
+  _spilled++;
+  return written == SPILL_HEADER + length;
+}
+
+// moves spilled messages back into RAM as long as they fit
+void MQTTTask::unspill() {
+  File file = SPIFFS.open(SPILL_FILE, FILE_READ);
+  if (file && file.seek(_spillRead)) {
+    while (_spillRead < _spillSize) {
+      uint8_t header[SPILL_HEADER];
+      if (file.read(header, sizeof(header)) != sizeof(header)) {
+        _spillRead = _spillSize;
+        break;
+      }
+      const size_t length = ((size_t)header[0] << 8) | header[1];
+      if (length == 0 || length > sizeof(_payload) || _spillRead + SPILL_HEADER + length > _spillSize) {
+        _spillRead = _spillSize;
+        break;
+      }
+      if (!_spool.hasRoom(length)) {
+        break;
+      }
+      if (file.read((uint8_t *)_payload, length) != length) {
+        _spillRead = _spillSize;
+        break;
+      }
+      _spool.push(_payload, length);
+      _spillRead += SPILL_HEADER + length;
+    }
+  } else {
+    _spillRead = _spillSize;
+  }
+  file.close();
+
+  if (_spillRead >= _spillSize) {
+    SPIFFS.remove(SPILL_FILE);
+    _spillSize = 0;
+    _spillRead = 0;
+  }
+}
+
+void MQTTTask::report(System &system) {
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "spool: %u pending, %u in flight, %u/%u bytes (peak %u); %u confirmed, %u resent, %u dropped; flash %u bytes, %u spilled, %u dropped", _spool.getPending(), _spool.getInFlight(), _spool.getUsedBytes(), _spool.getCapacity(), _spool.getPeakBytes(), _spool.getConfirmed(), _spool.getResent(), _spool.getDropped(), _spillSize - _spillRead, _spilled, _spillDropped);
+}
+
+// APRSMessageType::toString() returns a new String, the handful of names in use are kept
+const char *MQTTTask::typeName(const PacketView &body) {
+  const char identifier = body.empty() ? 0 : body.data[0];
+  for (size_t i = 0; i < _typeNameCount; i++) {
+    if (_typeNames[i].identifier == identifier) {
+      return _typeNames[i].name.c_str();
+    }
+  }
+  // once all slots are taken the last one is reused for rare identifiers
+  TypeName &slot  = _typeNames[_typeNameCount < TYPE_NAMES ? _typeNameCount++ : TYPE_NAMES - 1];
+  slot.identifier = identifier;
+  slot.name       = APRSMessageType(identifier).toString();
+  return slot.name.c_str();
+}
+
 bool MQTTTask::connect(System &system) {
   bool result = false;
   system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "Connecting to MQTT broker: %s on port %d", system.getUserConfig()->mqtt.server.c_str(), system.getUserConfig()->mqtt.port);
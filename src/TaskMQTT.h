@@ -1,26 +1,72 @@
 #ifndef TASK_MQTT_H_
 #define TASK_MQTT_H_
 
+#include "Packet/AprsPacket.h"
+#include "Packet/MqttPayload.h"
+#include "Packet/MqttSpool.h"
 #include "System/TaskManager.h"
-#include <APRSMessage.h>
+#include "System/Timer.h"
 #include <PubSubClient.h>
 #include <WiFi.h>
 
 class MQTTTask : public Task {
 public:
-  explicit MQTTTask(TaskQueue<std::shared_ptr<APRSMessage>> &toMQTT);
+  explicit MQTTTask(TaskQueue<std::shared_ptr<AprsPacket>> &toMQTT);
   virtual ~MQTTTask();
 
-  virtual bool setup(System &system) override;
-  virtual bool loop(System &system) override;
+  virtual bool     setup(System &system) override;
+  virtual bool     loop(System &system) override;
+  virtual bool     hasPendingWork() const override;
+  virtual uint32_t getDeadline() const override;
 
 private:
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toMQTT;
+  // messages published per loop(), a burst does not wait one poll interval per packet
+  static const size_t MAX_PER_LOOP = 8;
+  static const size_t PAYLOAD_SIZE = 1024;
+  static const size_t TYPE_NAMES   = 8;
+  // length (2 bytes) in front of every message in the spill file
+  static const size_t SPILL_HEADER = 2;
+
+  class TypeName {
+  public:
+    TypeName() : identifier(0) {
+    }
+
+    char   identifier;
+    String name;
+  };
+
+  TaskQueue<std::shared_ptr<AprsPacket>> &_toMQTT;
 
   WiFiClient   _client;
   PubSubClient _MQTT;
 
-  bool connect(System &system);
+  String     _topic;
+  MqttFormat _format;
+  char       _payload[PAYLOAD_SIZE];
+  TypeName   _typeNames[TYPE_NAMES];
+  size_t     _typeNameCount;
+  uint32_t   _tooLong;
+
+  MqttSpool _spool;
+  bool      _connected;
+  Timer     _reportTimer;
+
+  // messages that did not fit into RAM, appended to a file and read back in order
+  size_t   _spillLimit;
+  size_t   _spillSize;
+  size_t   _spillRead;
+  uint32_t _spilled;
+  uint32_t _spillDropped;
+
+  bool        connect(System &system);
+  void        enqueue(System &system, const AprsPacket &packet);
+  void        publish(System &system);
+  void        disconnected(System &system);
+  bool        spill(const char *data, size_t length);
+  void        unspill();
+  void        report(System &system);
+  const char *typeName(const PacketView &body);
 };
 
 #endif
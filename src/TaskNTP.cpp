@@ -6,7 +6,7 @@
 #include "TaskNTP.h"
 #include "project_configuration.h"
 
-NTPTask::NTPTask() : Task(TASK_NTP, TaskNtp), _beginCalled(false) {
+NTPTask::NTPTask() : Task(TASK_NTP, TaskNtp, TaskPriorityLow), _beginCalled(false) {
 }
 
 NTPTask::~NTPTask() {
@@ -14,6 +14,7 @@ NTPTask::~NTPTask() {
 
 bool NTPTask::setup(System &system) {
   _ntpClient.setPoolServerName(system.getUserConfig()->ntpServer.c_str());
+  _pollInterval = 1000;
   return true;
 }
 
@@ -29,7 +30,7 @@ bool NTPTask::loop(System &system) {
     setTime(_ntpClient.getEpochTime());
     system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "Current time: %s", _ntpClient.getFormattedTime().c_str());
   }
-  _stateInfo = _ntpClient.getFormattedTime();
-  _state     = Okay;
+  setStateInfo(_ntpClient.getFormattedTime());
+  setState(Okay);
   return true;
 }
@@ -5,7 +5,7 @@
 #include "TaskOTA.h"
 #include "project_configuration.h"
 
-OTATask::OTATask() : Task(TASK_OTA, TaskOta), _beginCalled(false) {
+OTATask::OTATask() : Task(TASK_OTA, TaskOta, TaskPriorityLow), _beginCalled(false) {
 }
 
 OTATask::~OTATask() {
@@ -47,7 +47,8 @@ bool OTATask::setup(System &system) {
   } else {
     _ota.setHostname(system.getUserConfig()->callsign.c_str());
   }
-  _stateInfo = "";
+  setStateInfo("");
+  _pollInterval = 100;
   return true;
 }
 
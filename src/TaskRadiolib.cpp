@@ -1,12 +1,25 @@
 #include "Task.h"
 #include "TimeLib/TimeLib.h"
+#include <esp_system.h>
 #include <logger.h>
 
 #include "TaskRadiolib.h"
 
-volatile bool RadiolibTask::_modemInterruptOccurred = false;
+volatile bool     RadiolibTask::_modemInterruptOccurred = false;
+volatile uint32_t RadiolibTask::_modemInterruptMicros   = 0;
+TaskHandle_t      RadiolibTask::_radioTaskHandle        = 0;
 
-RadiolibTask::RadiolibTask(TaskQueue<std::shared_ptr<APRSMessage>> &fromModem, TaskQueue<std::shared_ptr<APRSMessage>> &toModem) : Task(TASK_RADIOLIB, TaskRadiolib), _modem(0), _rxEnable(false), _txEnable(false), _fromModem(fromModem), _toModem(toModem), _transmitFlag(false), _frequencyTx(0.0), _frequencyRx(0.0), _frequenciesAreSame(false) {
+#define RADIO_TASK_STACK_SIZE 4096
+#define RADIO_TASK_PRIORITY   3
+#define RADIO_TASK_POLL_MS    10
+// a channel activity scan takes two symbols, 65 ms at SF12
+#define CAD_TIMEOUT_MS           500
+#define LATENCY_REPORT_PERIOD_MS (5 * 60 * 1000)
+// a packet waiting longer than this for the duty cycle is dropped
+#define DUTY_CYCLE_MAX_WAIT_MS 60000
+
+RadiolibTask::RadiolibTask(TaskQueue<std::shared_ptr<AprsPacket>> &fromModem, TxQueue &toModem) : Task(TASK_RADIOLIB, TaskRadiolib, TaskPriorityHigh), _modem(0), _rxEnable(false), _txEnable(false), _fromModem(fromModem), _toModem(toModem), _events(TaskQueueOverflow::DropOldest), _transmitFlag(false), _txWaitTXReported(false), _txWaitRXReported(false), _frequencyTx(0.0), _frequencyRx(0.0), _frequenciesAreSame(false), _txPendingSince(0), _txNotBefore(0), _txDutyCycleReported(false), _utilisation(0), _channelAccessEnable(false), _cadRunning(false), _cadStarted(0), _dutyCycleDelayed(0), _dutyCycleDropped(0), _channelBusy(0), _channelDeferred(0), _channelForced(0) {
+  memset(_txExpired, 0, sizeof(_txExpired));
 }
 
 RadiolibTask::~RadiolibTask() {
@@ -23,9 +36,10 @@ bool RadiolibTask::setup(System &system) {
     _frequenciesAreSame = true;
   }
 
-  const uint16_t preambleLength = 8;
-
-  if (system.getBoardConfig()->Lora.Modem == eSX1278) {
+  if (system.getUserConfig()->lora.trace.length() > 0) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] replaying %s instead of the modem", timeString().c_str(), system.getUserConfig()->lora.trace.c_str());
+    _modem = new Modem_Simulated();
+  } else if (system.getBoardConfig()->Lora.Modem == eSX1278) {
     system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] using SX1278", timeString().c_str());
     _modem = new Modem_SX1278();
   } else if (system.getBoardConfig()->Lora.Modem == eSX1268) {
@@ -35,129 +49,545 @@ bool RadiolibTask::setup(System &system) {
     system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] Modem not correctly defined!", timeString().c_str());
   }
 
-  int16_t state = _modem->begin(system.getBoardConfig()->Lora, system.getUserConfig()->lora, preambleLength, setFlag);
+  const bool simulated = system.getUserConfig()->lora.trace.length() > 0;
+  int16_t    state     = _modem->begin(system.getBoardConfig()->Lora, system.getUserConfig()->lora, LoRaModem::PREAMBLE_LENGTH, simulated ? setFlagFromTask : setFlag);
   if (state != RADIOLIB_ERR_NONE) {
     decodeError(system, state);
   }
 
-  startRX(system);
+  startRX();
+  handleEvents(system);
+
+  _modulation = LoRaModem::getModulation(system.getUserConfig()->lora);
+  _txWaitTimer.setTimeout(LoRaAirtime::preambleMicros(_modulation) * 2 / 1000);
+  // the EU sub-band limits are per hour
+  _dutyCycle.setLimit((uint16_t)(system.getUserConfig()->lora.dutyCycle * 10 + 0.5), 60 * 60 * 1000, millis());
+  // by default a slot is the time other stations need to notice our preamble
+  const uint32_t slotTime = system.getUserConfig()->lora.slotTime > 0 ? system.getUserConfig()->lora.slotTime : LoRaAirtime::preambleMicros(_modulation) / 1000;
+  _toModem.setDigiSlots(system.getUserConfig()->digi.randomSlots, slotTime);
+  _toModem.setRandomSeed(esp_random());
+  _channelAccessEnable = system.getUserConfig()->lora.channelAccess;
+  _channelAccess.setSlotTime(slotTime);
+  _channelAccess.setPersistence(system.getUserConfig()->lora.persistence);
+  _channelAccess.setRandomSeed(esp_random());
+
+  // everything urgent is signaled via hasPendingWork(), polling is only needed for the latency report
+  _pollInterval = 1000;
 
-  uint32_t preambleDurationMilliSec = ((uint64_t)(preambleLength + 4) << (system.getUserConfig()->lora.spreadingFactor + 10 /* to milli-sec */)) / system.getUserConfig()->lora.signalBandwidth;
-  _txWaitTimer.setTimeout(preambleDurationMilliSec * 2);
+  _latencyReportTimer.setTimeout(LATENCY_REPORT_PERIOD_MS);
+  _latencyReportTimer.start();
 
-  _stateInfo = "";
+  if (system.getUserConfig()->lora.dedicated_task) {
+    // pin the radio next to the Arduino loop, but with a higher priority so it preempts long running tasks
+    if (xTaskCreatePinnedToCore(radioTask, "RadiolibTask", RADIO_TASK_STACK_SIZE, this, RADIO_TASK_PRIORITY, &_radioTaskHandle, xPortGetCoreID()) != pdPASS) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] could not create radio task, falling back to main loop", timeString().c_str());
+      _radioTaskHandle = 0;
+    } else {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] radio runs in dedicated task on core %d", timeString().c_str(), xPortGetCoreID());
+    }
+  }
+
+  setStateInfo("");
   return true;
 }
 
 bool RadiolibTask::loop(System &system) {
-  if (_modemInterruptOccurred) {
-    handleModemInterrupt(system);
-  } else if (_txWaitTimer.check() && !_toModem.empty()) {
-    handleTXing(system);
+  if (!_radioTaskHandle) {
+    serviceModem();
+  }
+  handleEvents(system);
+  if (_latencyReportTimer.check()) {
+    reportLatency(system);
+    reportLinkQuality(system);
+    reportAirtime(system);
+    reportQueue(system);
+    reportChannel(system);
+    _latencyReportTimer.start();
   }
   return true;
 }
 
-void RadiolibTask::setFlag(void) {
+bool RadiolibTask::hasPendingWork() const {
+  if (!_events.empty()) {
+    return true;
+  }
+  if (_radioTaskHandle) {
+    return false;
+  }
+  return _modemInterruptOccurred || txReady();
+}
+
+uint32_t RadiolibTask::getDeadline() const {
+  if (_radioTaskHandle) {
+    return 0;
+  }
+  if (_cadRunning) {
+    return _cadStarted + CAD_TIMEOUT_MS;
+  }
+  if (_transmitFlag) {
+    // TX done comes as interrupt
+    return 0;
+  }
+  if (_txWaitTimer.isActive() && !_txWaitTimer.check()) {
+    // Timer::check() only passes once the trigger time is over
+    return _txWaitTimer.getTriggerTime() + 1;
+  }
+  if (_txPending.packet) {
+    return _txNotBefore;
+  }
+  return _toModem.getNextDue(millis());
+}
+
+uint16_t RadiolibTask::getUtilisation() const {
+  return _utilisation;
+}
+
+const Histogram &RadiolibTask::getAirtime() const {
+  return _airtime;
+}
+
+bool RadiolibTask::txReady() const {
+  if (_cadRunning) {
+    // normally the end of the scan is signaled by the interrupt
+    return millis() - _cadStarted > CAD_TIMEOUT_MS;
+  }
+  if (_transmitFlag) {
+    // the next packet can only go after TX done
+    return false;
+  }
+  if (!_txWaitTimer.check()) {
+    return false;
+  }
+  const uint32_t now = millis();
+  // only a pending packet waits for the duty cycle, the timestamp is stale otherwise
+  if (_txPending.packet) {
+    return (int32_t)(now - _txNotBefore) >= 0;
+  }
+  return _toModem.isDue(now);
+}
+
+void IRAM_ATTR RadiolibTask::setFlag(void) {
+  _modemInterruptMicros   = micros();
   _modemInterruptOccurred = true;
+  if (_radioTaskHandle) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(_radioTaskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+      portYIELD_FROM_ISR();
+    }
+  } else {
+    TaskManager::wakeupFromISR();
+  }
+}
+
+void RadiolibTask::setFlagFromTask(void) {
+  _modemInterruptMicros   = micros();
+  _modemInterruptOccurred = true;
+  if (_radioTaskHandle) {
+    xTaskNotifyGive(_radioTaskHandle);
+  } else {
+    TaskManager::wakeup();
+  }
 }
 
-void RadiolibTask::handleModemInterrupt(System &system) {
+void RadiolibTask::radioTask(void *parameter) {
+  RadiolibTask *task = static_cast<RadiolibTask *>(parameter);
+  while (true) {
+    // woken by the DIO interrupt, the timeout is only needed to pick up new TX packets
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RADIO_TASK_POLL_MS));
+    task->serviceModem();
+    if (!task->_events.empty()) {
+      TaskManager::wakeup();
+    }
+  }
+}
+
+void RadiolibTask::serviceModem() {
+  if (_modemInterruptOccurred) {
+    handleModemInterrupt();
+  } else if (txReady()) {
+    handleTXing();
+  }
+  _utilisation = _dutyCycle.getUtilisation(millis());
+}
+
+void RadiolibTask::handleModemInterrupt() {
   _modemInterruptOccurred = false;
 
   if (_transmitFlag) { // transmitted
     _transmitFlag = false;
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] TX done", timeString().c_str());
+    RadioEvent event;
+    event.type = RadioEvent::TxDone;
+    _events.addElement(event);
     _txWaitTimer.start();
-    startRX(system);
+    startRX();
+    return;
+  }
+
+  if (_cadRunning) {
+    _cadRunning = false;
+    finishChannelScan(_modem->getChannelScanResult() == RADIOLIB_PREAMBLE_DETECTED, millis());
     return;
   }
 
-  // received
-  String str;
-  int    state = _modem->readData(str);
+  // received, read straight into the packet buffer
+  RadioEvent                  event;
+  std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+  size_t                      length = _modem->getPacketLength();
+  if (length > AprsPacket::getRawCapacity()) {
+    length = AprsPacket::getRawCapacity();
+  }
+  int state = _modem->readData(packet->getRawBuffer(), length);
+
+  // the link quality goes along with the packet, nobody has to ask the modem again
+  RxMetadata rx;
+  rx.rssi           = _modem->getRSSI();
+  rx.snr            = _modem->getSNR();
+  rx.frequencyError = -_modem->getFrequencyError();
+  rx.timestamp      = _modemInterruptMicros;
+  if (state == RADIOLIB_ERR_CRC_MISMATCH) {
+    rx.status = RxCrcError;
+  } else if (state == RADIOLIB_ERR_LORA_HEADER_DAMAGED) {
+    rx.status = RxHeaderError;
+  }
+  packet->setRxMetadata(rx);
+  event.packet = packet;
+
   if (state != RADIOLIB_ERR_NONE) {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] readData failed, code %d", timeString().c_str(), state);
+    event.type  = RadioEvent::ReadFailed;
+    event.state = state;
+    _events.addElement(event);
     return;
   }
-  if (str.substring(0, 3) != "<\xff\x01") {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] Unknown packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeString().c_str(), str.c_str(), _modem->getRSSI(), _modem->getSNR(), -_modem->getFrequencyError());
+
+  if (!packet->decodeRaw(length)) {
+    event.type  = RadioEvent::UnknownPacket;
+    event.state = length;
+    _events.addElement(event);
     return;
   }
+  packet->setOrigin(OriginRf);
+  _fromModem.addElement(packet);
 
-  std::shared_ptr<APRSMessage> msg = std::shared_ptr<APRSMessage>(new APRSMessage());
-  msg->decode(str.substring(3));
-  _fromModem.addElement(msg);
-  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] Received packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeString().c_str(), msg->toString().c_str(), _modem->getRSSI(), _modem->getSNR(), -_modem->getFrequencyError());
-  system.getDisplay().addFrame(std::shared_ptr<DisplayFrame>(new TextFrame("LoRa", msg->toString().c_str())));
+  event.type          = RadioEvent::Received;
+  event.latencyMicros = micros() - _modemInterruptMicros;
+  _events.addElement(event);
 }
 
-void RadiolibTask::handleTXing(System &system) {
+void RadiolibTask::handleTXing() {
   if (!_txEnable) {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] TX is not enabled", timeString().c_str());
-    _toModem.getElement(); // empty list, otherwise memory will get full.
+    RadioEvent event;
+    event.type = RadioEvent::TxDisabled;
+    _events.addElement(event);
+    _toModem.clear(); // empty list, otherwise memory will get full.
+    return;
+  }
+
+  const uint32_t now = millis();
+  if (_cadRunning) {
+    // the scan did not finish in time, take the channel as free
+    _cadRunning = false;
+    finishChannelScan(false, now);
     return;
   }
 
-  static bool txsignaldetected_print = false;
   if (_transmitFlag) { // we are currently TXing, need to wait
-    if (!txsignaldetected_print) {
-      txsignaldetected_print = true;
-      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] TX signal detected. Waiting TX", timeString().c_str());
+    if (!_txWaitTXReported) {
+      _txWaitTXReported = true;
+      RadioEvent event;
+      event.type = RadioEvent::TxWaitTX;
+      _events.addElement(event);
+    }
+    return;
+  }
+
+  if (!_txPending.packet) {
+    TxQueueResult result;
+    while ((result = _toModem.pop(_txPending, now)) == TxQueueExpired) {
+      RadioEvent event;
+      event.type    = RadioEvent::TxExpired;
+      event.packet  = _txPending.packet;
+      event.txClass = _txPending.txClass;
+      event.queued  = now - _txPending.queuedAt;
+      _events.addElement(event);
+    }
+    if (result != TxQueueReady) {
+      // nothing left, or only digipeats waiting for their slot
+      _txPending.packet.reset();
+      return;
     }
+    _txPendingSince      = now;
+    _txDutyCycleReported = false;
+  }
+
+  const uint32_t airtime = LoRaAirtime::packetMillis(_modulation, _txPending.packet->getRawLength());
+  const uint32_t delay   = _dutyCycle.getDelay(airtime, now);
+  if (delay != 0) {
+    RadioEvent event;
+    event.packet  = _txPending.packet;
+    event.airtime = airtime;
+    event.delay   = delay;
+    if (delay == DutyCycle::NEVER || now - _txPendingSince + delay > DUTY_CYCLE_MAX_WAIT_MS) {
+      event.type = RadioEvent::TxDutyCycleDropped;
+      _events.addElement(event);
+      _txPending.packet.reset();
+      _channelAccess.reset();
+      return;
+    }
+    if (!_txDutyCycleReported) {
+      _txDutyCycleReported = true;
+      event.type           = RadioEvent::TxDutyCycleWait;
+      _events.addElement(event);
+    }
+    _txNotBefore = now + delay;
     return;
   }
 
   // we are currently RXing
-  static bool rxsignaldetected_print = false;
-  if (_frequenciesAreSame && (_modem->getModemStatus() & 0x01) == 0x01) {
-    if (!rxsignaldetected_print) {
-      rxsignaldetected_print = true;
+  const bool receiving = _frequenciesAreSame && (_modem->getModemStatus() & 0x01) == 0x01;
+  if (!_channelAccessEnable) {
+    if (receiving) {
+      if (!_txWaitRXReported) {
+        _txWaitRXReported = true;
+        RadioEvent event;
+        event.type = RadioEvent::TxWaitRX;
+        _events.addElement(event);
+      }
+      return;
+    }
+    transmitPending(now);
+    return;
+  }
+
+  if (!_channelAccess.isStarted()) {
+    _channelAccess.start(now);
+  }
+  if (receiving) {
+    // as good as a busy scan, and a scan would abort the reception
+    if (_channelAccess.scanned(true, now)) {
+      transmitPending(now);
+    } else {
+      _txNotBefore = _channelAccess.getNotBefore();
+    }
+    return;
+  }
+  if (!startChannelScan(now)) {
+    transmitPending(now);
+  }
+}
+
+bool RadiolibTask::startChannelScan(uint32_t now) {
+  int16_t state = RADIOLIB_ERR_NONE;
+  if (!_frequenciesAreSame) {
+    state = _modem->setFrequency(_frequencyTx);
+  }
+  if (state == RADIOLIB_ERR_NONE) {
+    state = _modem->startChannelScan();
+  }
+  if (state != RADIOLIB_ERR_NONE) {
+    RadioEvent event;
+    event.type  = RadioEvent::StartCadFailed;
+    event.state = state;
+    _events.addElement(event);
+    return false;
+  }
+  _cadRunning = true;
+  _cadStarted = now;
+  return true;
+}
+
+void RadiolibTask::finishChannelScan(bool busy, uint32_t now) {
+  if (_channelAccess.scanned(busy, now)) {
+    transmitPending(now);
+    return;
+  }
+  _txNotBefore = _channelAccess.getNotBefore();
+  startRX();
+}
+
+void RadiolibTask::transmitPending(uint32_t now) {
+  RadioEvent event;
+  event.type            = RadioEvent::TxStarted;
+  event.packet          = _txPending.packet;
+  event.airtime         = LoRaAirtime::packetMillis(_modulation, _txPending.packet->getRawLength());
+  event.txClass         = _txPending.txClass;
+  event.queued          = now - _txPending.queuedAt;
+  event.channelWait     = _channelAccess.getWait(now);
+  event.channelBusy     = _channelAccess.getBusy();
+  event.channelDeferred = _channelAccess.getDeferred();
+  event.channelForced   = _channelAccess.isForced();
+  _events.addElement(event);
+  _txPending.packet.reset();
+  _channelAccess.reset();
+  _dutyCycle.record(event.airtime, now);
+  startTX(*event.packet);
+  _txWaitRXReported = false;
+  _txWaitTXReported = false;
+}
+
+void RadiolibTask::handleEvents(System &system) {
+  while (!_events.empty()) {
+    RadioEvent event = _events.getElement();
+    switch (event.type) {
+    case RadioEvent::Received: {
+      const RxMetadata &rx = event.packet->getRxMetadata();
+      _latency.add(event.latencyMicros);
+      _rxStats.add(rx);
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] Received packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeString().c_str(), event.packet->c_str(), rx.rssi, rx.snr, rx.frequencyError);
+      system.getDisplay().addFrame(TextFrame::create("LoRa", event.packet->c_str()));
+      break;
+    }
+    case RadioEvent::UnknownPacket: {
+      const RxMetadata &rx = event.packet->getRxMetadata();
+      _rxStats.add(rx);
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] Unknown packet '%.*s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeString().c_str(), event.state, (const char *)event.packet->getRawData(), rx.rssi, rx.snr, rx.frequencyError);
+      break;
+    }
+    case RadioEvent::ReadFailed:
+      _rxStats.add(event.packet->getRxMetadata());
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] readData failed, code %d (RSSI %.0fdBm, SNR %.2fdB)", timeString().c_str(), event.state, event.packet->getRxMetadata().rssi, event.packet->getRxMetadata().snr);
+      break;
+    case RadioEvent::TxDone:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] TX done", timeString().c_str());
+      break;
+    case RadioEvent::TxStarted:
+      _airtime.add(event.airtime);
+      _queueLatency[event.txClass].add(event.queued);
+      if (_channelAccessEnable) {
+        _channelWait.add(event.channelWait);
+        _channelBusy     += event.channelBusy;
+        _channelDeferred += event.channelDeferred;
+        _channelForced   += event.channelForced ? 1 : 0;
+      }
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] Transmitting packet '%s' (%ums)", timeString().c_str(), event.packet->c_str(), event.airtime);
+      break;
+    case RadioEvent::TxExpired:
+      _txExpired[event.txClass]++;
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] %s packet '%s' dropped after %ums in the TX queue", timeString().c_str(), TxQueue::toString(event.txClass), event.packet->c_str(), event.queued);
+      break;
+    case RadioEvent::TxDutyCycleWait:
+      _dutyCycleDelayed++;
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] duty cycle exhausted, packet '%s' waits %ums", timeString().c_str(), event.packet->c_str(), event.delay);
+      break;
+    case RadioEvent::TxDutyCycleDropped:
+      _dutyCycleDropped++;
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "[%s] duty cycle exhausted, packet '%s' (%ums) dropped", timeString().c_str(), event.packet->c_str(), event.airtime);
+      break;
+    case RadioEvent::TxDisabled:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] TX is not enabled", timeString().c_str());
+      break;
+    case RadioEvent::TxWaitTX:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] TX signal detected. Waiting TX", timeString().c_str());
+      break;
+    case RadioEvent::TxWaitRX:
       system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] RX signal detected. Waiting TX", timeString().c_str());
+      break;
+    case RadioEvent::StartRxFreqFailed:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startRX failed, Freq update, code %d", timeString().c_str(), event.state);
+      decodeError(system, event.state);
+      break;
+    case RadioEvent::StartRxFailed:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startRX failed, code %d", timeString().c_str(), event.state);
+      decodeError(system, event.state);
+      break;
+    case RadioEvent::StartTxFreqFailed:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startTX failed, Freq update, code %d", timeString().c_str(), event.state);
+      decodeError(system, event.state);
+      break;
+    case RadioEvent::StartCadFailed:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "[%s] channel scan failed, code %d, sending without", timeString().c_str(), event.state);
+      break;
+    case RadioEvent::StartTxFailed:
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startTX failed, code %d", timeString().c_str(), event.state);
+      decodeError(system, event.state);
+      break;
     }
+  }
+}
+
+void RadiolibTask::reportLatency(System &system) {
+  if (_latency.getCount() == 0) {
     return;
   }
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] ISR to decode latency (%s): p50 %uus, p90 %uus, p99 %uus, max %uus over %u packets", timeString().c_str(), _radioTaskHandle ? "radio task" : "main loop", _latency.getPercentile(50), _latency.getPercentile(90), _latency.getPercentile(99), _latency.getMax(), _latency.getCount());
+  _latency.reset();
+}
 
-  std::shared_ptr<APRSMessage> msg = _toModem.getElement();
-  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "[%s] Transmitting packet '%s'", timeString().c_str(), msg->toString().c_str());
-  startTX(system, "<\xff\x01" + msg->encode());
-  rxsignaldetected_print = false;
-  txsignaldetected_print = false;
+void RadiolibTask::reportLinkQuality(System &system) {
+  if (_rxStats.getCount(RxOkay) == 0 && _rxStats.getCount(RxCrcError) == 0 && _rxStats.getCount(RxHeaderError) == 0) {
+    return;
+  }
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] RX: %u packets, RSSI %.0f/%.0f/%.0fdBm, SNR %.2f/%.2f/%.2fdB (min/avg/max); %u CRC errors, %u header errors", timeString().c_str(), _rxStats.getCount(RxOkay), _rxStats.getRssiMin(), _rxStats.getRssiAverage(), _rxStats.getRssiMax(), _rxStats.getSnrMin(), _rxStats.getSnrAverage(), _rxStats.getSnrMax(), _rxStats.getCount(RxCrcError), _rxStats.getCount(RxHeaderError));
+  _rxStats.reset();
 }
 
-void RadiolibTask::startRX(System &system) {
+void RadiolibTask::reportAirtime(System &system) {
+  const uint16_t utilisation = _utilisation;
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] airtime: %u packets, p50 %ums, max %ums; duty cycle %u.%u%% used of %u.%u%%, %u delayed, %u dropped", timeString().c_str(), _airtime.getCount(), _airtime.getPercentile(50), _airtime.getMax(), utilisation / 10, utilisation % 10, _dutyCycle.getLimit() / 10, _dutyCycle.getLimit() % 10, _dutyCycleDelayed, _dutyCycleDropped);
+}
+
+void RadiolibTask::reportQueue(System &system) {
+  for (size_t i = 0; i < TxClassCount; i++) {
+    const TxClass txClass = (TxClass)i;
+    Histogram    &latency = _queueLatency[i];
+    if (latency.getCount() == 0 && _txExpired[i] == 0 && _toModem.getDropped(txClass) == 0) {
+      continue;
+    }
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] TX queue %s: %u sent, latency p50 %ums, p99 %ums, max %ums; %u expired, %u dropped", timeString().c_str(), TxQueue::toString(txClass), latency.getCount(), latency.getPercentile(50), latency.getPercentile(99), latency.getMax(), _txExpired[i], _toModem.getDropped(txClass));
+    latency.reset();
+  }
+}
+
+void RadiolibTask::reportChannel(System &system) {
+  if (!_channelAccessEnable) {
+    return;
+  }
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "[%s] channel access: %u packets waited p50 %ums, p99 %ums, max %ums; %u busy scans (collisions avoided), %u deferred slots, %u sent on a busy channel", timeString().c_str(), _channelWait.getCount(), _channelWait.getPercentile(50), _channelWait.getPercentile(99), _channelWait.getMax(), _channelBusy, _channelDeferred, _channelForced);
+}
+
+void RadiolibTask::startRX() {
+  if (!_rxEnable) {
+    // disabled by decodeError(), the modem is not put back into receive
+    return;
+  }
+  RadioEvent event;
   if (!_frequenciesAreSame) {
     int16_t state = _modem->setFrequency(_frequencyRx);
     if (state != RADIOLIB_ERR_NONE) {
-      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startRX failed, Freq update, code %d", timeString().c_str(), state);
-      decodeError(system, state);
+      event.type  = RadioEvent::StartRxFreqFailed;
+      event.state = state;
+      _events.addElement(event);
       return;
     }
   }
 
   int16_t state = _modem->startReceive();
   if (state != RADIOLIB_ERR_NONE) {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startRX failed, code %d", timeString().c_str(), state);
-    decodeError(system, state);
+    event.type  = RadioEvent::StartRxFailed;
+    event.state = state;
+    _events.addElement(event);
   }
 }
 
-void RadiolibTask::startTX(System &system, String &str) {
+void RadiolibTask::startTX(AprsPacket &packet) {
+  RadioEvent event;
   if (!_frequenciesAreSame) {
     int16_t state = _modem->setFrequency(_frequencyTx);
     if (state != RADIOLIB_ERR_NONE) {
-      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startTX failed, Freq update, code %d", timeString().c_str(), state);
-      decodeError(system, state);
-      startRX(system);
+      event.type  = RadioEvent::StartTxFreqFailed;
+      event.state = state;
+      _events.addElement(event);
+      startRX();
       return;
     }
   }
 
-  int16_t state = _modem->startTransmit(str);
+  int16_t state = _modem->startTransmit(packet.getRawBuffer(), packet.getRawLength());
   if (state != RADIOLIB_ERR_NONE) {
-    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "[%s] startTX failed, code %d", timeString().c_str(), state);
-    decodeError(system, state);
-    startRX(system);
+    event.type  = RadioEvent::StartTxFailed;
+    event.state = state;
+    _events.addElement(event);
+    startRX();
     return;
   }
   _transmitFlag = true;
@@ -269,6 +699,6 @@ void RadiolibTask::decodeError(System &system, int16_t state) {
     _rxEnable = false;
     _txEnable = false;
   }
-  _stateInfo = "LoRa-Modem failed";
-  _state     = Error;
+  setStateInfo("LoRa-Modem failed");
+  setState(Error);
 }
@@ -1,46 +1,149 @@
 #ifndef TASK_LORA_H_
 #define TASK_LORA_H_
 
+#include <atomic>
+
 #include "BoardFinder/BoardFinder.h"
+#include "LoRa/ChannelAccess.h"
+#include "LoRa/DutyCycle.h"
+#include "LoRa/TxQueue.h"
 #include "LoRaModem.h"
+#include "Packet/AprsPacket.h"
+#include "Packet/RxStats.h"
+#include "System/Histogram.h"
 #include "System/TaskManager.h"
 #include "project_configuration.h"
-#include <APRS-Decoder.h>
 
 class RadiolibTask : public Task {
 public:
-  explicit RadiolibTask(TaskQueue<std::shared_ptr<APRSMessage>> &fromModem, TaskQueue<std::shared_ptr<APRSMessage>> &_toModem);
+  explicit RadiolibTask(TaskQueue<std::shared_ptr<AprsPacket>> &fromModem, TxQueue &toModem);
   virtual ~RadiolibTask();
 
-  virtual bool setup(System &system) override;
-  virtual bool loop(System &system) override;
+  virtual bool     setup(System &system) override;
+  virtual bool     loop(System &system) override;
+  virtual bool     hasPendingWork() const override;
+  virtual uint32_t getDeadline() const override;
+
+  // permille of the duty cycle window spent transmitting
+  uint16_t         getUtilisation() const;
+  const Histogram &getAirtime() const;
 
 private:
+  // Everything the modem side wants to tell the rest of the system. The
+  // modem may be serviced from its own FreeRTOS task, so logging, display
+  // and error handling are done in loop() from these events.
+  class RadioEvent {
+  public:
+    enum Type {
+      Received,
+      UnknownPacket,
+      ReadFailed,
+      TxDone,
+      TxStarted,
+      TxExpired,
+      TxDisabled,
+      TxDutyCycleWait,
+      TxDutyCycleDropped,
+      TxWaitTX,
+      TxWaitRX,
+      StartRxFailed,
+      StartRxFreqFailed,
+      StartTxFailed,
+      StartTxFreqFailed,
+      StartCadFailed,
+    };
+
+    RadioEvent() : type(Received), state(0), latencyMicros(0), airtime(0), delay(0), txClass(TxClassDigi), queued(0), channelWait(0), channelBusy(0), channelDeferred(0), channelForced(false) {
+    }
+
+    Type                        type;
+    int16_t                     state;
+    std::shared_ptr<AprsPacket> packet;
+    uint32_t                    latencyMicros;
+    uint32_t                    airtime; // ms
+    uint32_t                    delay;   // ms
+    TxClass                     txClass;
+    uint32_t                    queued;      // ms spent in the TX queue
+    uint32_t                    channelWait; // ms
+    uint16_t                    channelBusy;
+    uint16_t                    channelDeferred;
+    bool                        channelForced;
+  };
+
   LoRaModem *_modem;
 
-  bool _rxEnable;
-  bool _txEnable;
+  // a decode error on the main loop disables RX and TX, the dedicated task checks them in startRX() and handleTXing()
+  std::atomic<bool> _rxEnable;
+  std::atomic<bool> _txEnable;
 
-  TaskQueue<std::shared_ptr<APRSMessage>> &_fromModem;
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_fromModem;
+  TxQueue                                &_toModem;
+  TaskQueue<RadioEvent, 16>               _events;
 
-  static volatile bool _modemInterruptOccurred;
+  static volatile bool     _modemInterruptOccurred;
+  static volatile uint32_t _modemInterruptMicros;
+  static TaskHandle_t      _radioTaskHandle;
 
   Timer _txWaitTimer;
 
   bool _transmitFlag;
+  bool _txWaitTXReported;
+  bool _txWaitRXReported;
 
   float _frequencyTx;
   float _frequencyRx;
   bool  _frequenciesAreSame;
 
+  Histogram _latency;
+  RxStats   _rxStats;
+  Timer     _latencyReportTimer;
+
+  // owned by the side that services the modem
+  LoRaModulation              _modulation;
+  DutyCycle                   _dutyCycle;
+  TxQueue::Entry              _txPending;
+  uint32_t                    _txPendingSince;
+  volatile uint32_t           _txNotBefore;
+  bool                        _txDutyCycleReported;
+  std::atomic<uint16_t>       _utilisation;
+  bool                        _channelAccessEnable;
+  ChannelAccess               _channelAccess;
+  volatile bool               _cadRunning;
+  volatile uint32_t           _cadStarted;
+
+  // main loop side, fed by events
+  Histogram _airtime;
+  uint32_t  _dutyCycleDelayed;
+  uint32_t  _dutyCycleDropped;
+  Histogram _queueLatency[TxClassCount];
+  uint32_t  _txExpired[TxClassCount];
+  Histogram _channelWait;
+  uint32_t  _channelBusy;
+  uint32_t  _channelDeferred;
+  uint32_t  _channelForced;
+
   static void setFlag(void);
+  // the same for the simulated modem, its timer calls back from task context
+  static void setFlagFromTask(void);
+  static void radioTask(void *parameter);
+
+  void serviceModem();
+  void handleEvents(System &system);
+  void reportLatency(System &system);
+  void reportLinkQuality(System &system);
+  void reportAirtime(System &system);
+  void reportQueue(System &system);
+  void reportChannel(System &system);
 
-  void startRX(System &system);
-  void startTX(System &system, String &str);
+  void startRX();
+  void startTX(AprsPacket &packet);
 
-  void handleModemInterrupt(System &system);
-  void handleTXing(System &system);
+  void handleModemInterrupt();
+  void handleTXing();
+  bool startChannelScan(uint32_t now);
+  void finishChannelScan(bool busy, uint32_t now);
+  void transmitPending(uint32_t now);
+  bool txReady() const;
 
   void decodeError(System &system, int16_t state);
 };
@@ -2,71 +2,140 @@
 
 #include "TimeLib/TimeLib.h"
 
+#include "LoRaModem.h"
 #include "Task.h"
 #include "TaskRouter.h"
 #include "project_configuration.h"
 
-RouterTask::RouterTask(TaskQueue<std::shared_ptr<APRSMessage>> &fromModem, TaskQueue<std::shared_ptr<APRSMessage>> &toModem, TaskQueue<std::shared_ptr<APRSMessage>> &toAprsIs, TaskQueue<std::shared_ptr<APRSMessage>> &toMQTT) : Task(TASK_ROUTER, TaskRouter), _fromModem(fromModem), _toModem(toModem), _toAprsIs(toAprsIs), _toMQTT(toMQTT) {
+RouterTask::RouterTask(TaskQueue<std::shared_ptr<AprsPacket>> &fromModem, TaskQueue<std::shared_ptr<AprsPacket>> &fromAprsIs, TxQueue &toModem, TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs, TaskQueue<std::shared_ptr<AprsPacket>> &toMQTT) : Task(TASK_ROUTER, TaskRouter, TaskPriorityHigh), _fromModem(fromModem), _fromAprsIs(fromAprsIs), _router(toModem, toAprsIs, toMQTT) {
 }
 
 RouterTask::~RouterTask() {
 }
 
 bool RouterTask::setup(System &system) {
+  _pollInterval = 1000;
+  _router.setCallsign(system.getUserConfig()->callsign.c_str());
+  _router.setUplink(system.getUserConfig()->aprs_is.active);
+  _router.setDigi(system.getUserConfig()->digi.active);
+  _router.setMQTT(system.getUserConfig()->mqtt.active);
+  _router.getDedupeCache().setWindow(system.getUserConfig()->dedupe.window * 1000);
+
+  Digipeater &digipeater = _router.getDigipeater();
+  for (const String &alias : system.getUserConfig()->digi.aliases) {
+    if (!digipeater.addAlias(alias.c_str())) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "DIGI: alias '%s' ignored", alias.c_str());
+    }
+  }
+  digipeater.setMaxHops(system.getUserConfig()->digi.maxHops);
+  _router.getViscousQueue().setDelay(system.getUserConfig()->digi.viscousDelay * 1000);
+
+  IsGate &isGate = _router.getIsGate();
+  isGate.setActive(system.getUserConfig()->aprs_is.gateToRf);
+  isGate.setBudget(system.getUserConfig()->aprs_is.airtimeBudget * 1000, millis());
+  isGate.setModulation(LoRaModem::getModulation(system.getUserConfig()->lora));
+  isGate.getHeardList().setWindow(system.getUserConfig()->aprs_is.heardWindow * 60 * 1000);
+
+  _dedupeReportTimer.setTimeout(5 * 60 * 1000);
+  _dedupeReportTimer.start();
   return true;
 }
 
+bool RouterTask::hasPendingWork() const {
+  return !_fromModem.empty() || !_fromAprsIs.empty();
+}
+
+uint32_t RouterTask::getDeadline() const {
+  return _router.getDeadline();
+}
+
+const DedupeCache &RouterTask::getDedupeCache() const {
+  return _router.getDedupeCache();
+}
+
+const IsGate &RouterTask::getIsGate() const {
+  return _router.getIsGate();
+}
+
 bool RouterTask::loop(System &system) {
   if (!_fromModem.empty()) {
-    std::shared_ptr<APRSMessage> modemMsg = _fromModem.getElement();
+    std::shared_ptr<AprsPacket> modemMsg = _fromModem.getElement();
+    logRoute(system, *modemMsg, _router.fromRf(modemMsg, millis()));
+  }
 
-    if (system.getUserConfig()->mqtt.active) {
-      _toMQTT.addElement(modemMsg);
+  // gating is cheap, take all of them so a burst from the server does not wait behind RF
+  while (!_fromAprsIs.empty()) {
+    std::shared_ptr<AprsPacket> rfMsg;
+    IsGateResult                result = _router.fromAprsIs(_fromAprsIs.getElement(), millis(), rfMsg);
+    if (result == IsGateOkay) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "RF: %s", rfMsg->c_str());
+    } else if (result == IsGateBudget || result == IsGateTooLong) {
+      system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "RF: no forward => %s", IsGate::toString(result));
     }
+  }
 
-    if (system.getUserConfig()->aprs_is.active && modemMsg->getSource() != system.getUserConfig()->callsign) {
-      std::shared_ptr<APRSMessage> aprsIsMsg = std::make_shared<APRSMessage>(*modemMsg);
-      String                       path      = aprsIsMsg->getPath();
-
-      if (!(path.indexOf("RFONLY") != -1 || path.indexOf("NOGATE") != -1 || path.indexOf("TCPIP") != -1)) {
-        if (!path.isEmpty()) {
-          path += ",";
-        }
-
-        aprsIsMsg->setPath(path + "qAO," + system.getUserConfig()->callsign);
-
-        system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: %s", aprsIsMsg->toString().c_str());
-        _toAprsIs.addElement(aprsIsMsg);
-      } else {
-        system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: no forward => RFonly");
-      }
-    } else {
-      if (!system.getUserConfig()->aprs_is.active) {
-        system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: disabled");
-      }
-
-      if (modemMsg->getSource() == system.getUserConfig()->callsign) {
-        system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: no forward => own packet received");
-      }
-    }
+  _router.release(millis());
 
-    if (system.getUserConfig()->digi.active && modemMsg->getSource() != system.getUserConfig()->callsign) {
-      std::shared_ptr<APRSMessage> digiMsg = std::make_shared<APRSMessage>(*modemMsg);
-      String                       path    = digiMsg->getPath();
+  if (_dedupeReportTimer.check()) {
+    reportDedupe(system);
+    reportIsGate(system);
+    _dedupeReportTimer.start();
+  }
 
-      // simple loop check
-      if (path.indexOf("WIDE1-1") >= 0 && path.indexOf(system.getUserConfig()->callsign) == -1) {
-        // fixme
-        digiMsg->setPath(system.getUserConfig()->callsign + "*");
+  setStateInfo("Router done ");
 
-        system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "DIGI: %s", digiMsg->toString().c_str());
+  return true;
+}
 
-        _toModem.addElement(digiMsg);
-      }
-    }
+void RouterTask::logRoute(System &system, const AprsPacket &packet, const RfRoute &route) {
+  switch (route.uplink) {
+  case RouteUplinkForwarded:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: %s", packet.c_str());
+    break;
+  case RouteUplinkDisabled:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: disabled");
+    break;
+  case RouteUplinkOwnPacket:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: no forward => own packet received");
+    break;
+  case RouteUplinkNoGate:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: no forward => RFonly");
+    break;
+  case RouteUplinkDuplicate:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "APRS-IS: no forward => duplicate");
+    break;
   }
 
-  _stateInfo = "Router done ";
+  if (route.cancelled) {
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "DIGI: already repeated by another digi, dropped");
+  }
+  switch (route.digi) {
+  case RouteDigiDisabled:
+    break;
+  case RouteDigiNoRepeat:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "DIGI: no repeat => %s", Digipeater::toString(route.digiResult));
+    break;
+  case RouteDigiDuplicate:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "DIGI: no repeat => duplicate");
+    break;
+  case RouteDigiTooLong:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_WARN, getName(), "DIGI: no repeat => packet too long");
+    break;
+  case RouteDigiDelayed:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "DIGI (%s, delayed): %s", Digipeater::toString(route.digiResult), route.digiPacket->c_str());
+    break;
+  case RouteDigiQueued:
+    system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_INFO, getName(), "DIGI (%s): %s", Digipeater::toString(route.digiResult), route.digiPacket->c_str());
+    break;
+  }
+}
 
-  return true;
+void RouterTask::reportDedupe(System &system) {
+  const DedupeCache &dedupe = _router.getDedupeCache();
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "dedupe: iGate %u forwarded, %u duplicates; digi %u forwarded, %u duplicates; %u evictions", dedupe.getMisses(DedupeIGate), dedupe.getHits(DedupeIGate), dedupe.getMisses(DedupeDigi), dedupe.getHits(DedupeDigi), dedupe.getEvictions());
+}
+
+void RouterTask::reportIsGate(System &system) {
+  const IsGate &isGate = _router.getIsGate();
+  system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "IS to RF: %u gated, %u no message, %u not to be gated, %u addressee not heard, %u sender on RF, %u too long, %u over airtime budget; %u stations heard", isGate.getCount(IsGateOkay), isGate.getCount(IsGateNoMessage), isGate.getCount(IsGateNoGate), isGate.getCount(IsGateNotHeard), isGate.getCount(IsGateSenderOnRf), isGate.getCount(IsGateTooLong), isGate.getCount(IsGateBudget), isGate.getHeardList().size(millis()));
 }
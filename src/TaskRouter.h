@@ -1,23 +1,36 @@
 #ifndef TASK_ROUTER_H_
 #define TASK_ROUTER_H_
 
+#include "LoRa/TxQueue.h"
+#include "Packet/AprsPacket.h"
+#include "Packet/Router.h"
 #include "System/TaskManager.h"
-#include <APRSMessage.h>
+#include "System/Timer.h"
 #include <TaskMQTT.h>
 
 class RouterTask : public Task {
 public:
-  RouterTask(TaskQueue<std::shared_ptr<APRSMessage>> &fromModem, TaskQueue<std::shared_ptr<APRSMessage>> &toModem, TaskQueue<std::shared_ptr<APRSMessage>> &toAprsIs, TaskQueue<std::shared_ptr<APRSMessage>> &toMQTT);
+  RouterTask(TaskQueue<std::shared_ptr<AprsPacket>> &fromModem, TaskQueue<std::shared_ptr<AprsPacket>> &fromAprsIs, TxQueue &toModem, TaskQueue<std::shared_ptr<AprsPacket>> &toAprsIs, TaskQueue<std::shared_ptr<AprsPacket>> &toMQTT);
   virtual ~RouterTask();
 
-  virtual bool setup(System &system) override;
-  virtual bool loop(System &system) override;
+  virtual bool     setup(System &system) override;
+  virtual bool     loop(System &system) override;
+  virtual bool     hasPendingWork() const override;
+  virtual uint32_t getDeadline() const override;
+
+  const DedupeCache &getDedupeCache() const;
+  const IsGate      &getIsGate() const;
 
 private:
-  TaskQueue<std::shared_ptr<APRSMessage>> &_fromModem;
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toModem;
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toAprsIs;
-  TaskQueue<std::shared_ptr<APRSMessage>> &_toMQTT;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_fromModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> &_fromAprsIs;
+
+  Router _router;
+  Timer  _dedupeReportTimer;
+
+  void logRoute(System &system, const AprsPacket &packet, const RfRoute &route);
+  void reportDedupe(System &system);
+  void reportIsGate(System &system);
 };
 
 #endif
@@ -43,8 +43,8 @@ bool WifiTask::loop(System &system) {
     system.connectedViaWifi(false);
     system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, getName(), "WiFi not connected!");
     _oldWifiStatus = wifi_status;
-    _stateInfo     = "WiFi not connected";
-    _state         = Error;
+    setStateInfo("WiFi not connected");
+    setState(Error);
     return false;
   } else if (wifi_status != _oldWifiStatus) {
     system.getLogger().log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, getName(), "WiFi IP address: %s", WiFi.localIP().toString().c_str());
@@ -52,7 +52,7 @@ bool WifiTask::loop(System &system) {
     return false;
   }
   system.connectedViaWifi(true);
-  _stateInfo = String("IP .") + String(WiFi.localIP()[3]) + String(" @ ") + String(WiFi.RSSI()) + String("dBm");
-  _state     = Okay;
+  setStateInfo(String("IP .") + String(WiFi.localIP()[3]) + String(" @ ") + String(WiFi.RSSI()) + String("dBm"));
+  setState(Okay);
   return true;
 }
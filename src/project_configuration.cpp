@@ -52,11 +52,29 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
     conf.aprs_is.passcode = data["aprs_is"]["passcode"].as<String>();
   if (data.containsKey("aprs_is") && data["aprs_is"].containsKey("server"))
     conf.aprs_is.server = data["aprs_is"]["server"].as<String>();
+  JsonArray failoverServers = data["aprs_is"]["failover_servers"].as<JsonArray>();
+  for (JsonVariant s : failoverServers) {
+    conf.aprs_is.failoverServers.push_back(s.as<String>());
+  }
   conf.aprs_is.port = data["aprs_is"]["port"] | 14580;
   if (data.containsKey("aprs_is") && data["aprs_is"].containsKey("filter"))
     conf.aprs_is.filter = data["aprs_is"]["filter"].as<String>();
+  conf.aprs_is.gateToRf      = data["aprs_is"]["gate_to_rf"] | true;
+  conf.aprs_is.airtimeBudget = data["aprs_is"]["airtime_budget"] | 6;
+  conf.aprs_is.heardWindow   = data["aprs_is"]["heard_window"] | 30;
 
   conf.digi.active = data["digi"]["active"] | false;
+  if (data["digi"].containsKey("aliases")) {
+    JsonArray aliases = data["digi"]["aliases"].as<JsonArray>();
+    for (JsonVariant a : aliases) {
+      conf.digi.aliases.push_back(a.as<String>());
+    }
+  } else {
+    conf.digi.aliases.push_back("WIDE1-1");
+  }
+  conf.digi.maxHops      = data["digi"]["max_hops"] | 1;
+  conf.digi.viscousDelay = data["digi"]["viscous_delay"] | 0;
+  conf.digi.randomSlots  = data["digi"]["random_slots"] | 0;
 
   conf.lora.frequencyRx     = data["lora"]["frequency_rx"] | 433775000;
   conf.lora.gainRx          = data["lora"]["gain_rx"] | 0;
@@ -66,11 +84,20 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
   conf.lora.signalBandwidth = data["lora"]["signal_bandwidth"] | 125000;
   conf.lora.codingRate4     = data["lora"]["coding_rate4"] | 5;
   conf.lora.tx_enable       = data["lora"]["tx_enable"] | true;
+  conf.lora.dedicated_task  = data["lora"]["dedicated_task"] | false;
+  conf.lora.dutyCycle       = data["lora"]["duty_cycle"] | 10.0;
+  conf.lora.channelAccess   = data["lora"]["channel_access"] | true;
+  conf.lora.persistence     = data["lora"]["persistence"] | 50;
+  conf.lora.slotTime        = data["lora"]["slot_time"] | 0;
+  if (data.containsKey("lora") && data["lora"].containsKey("trace"))
+    conf.lora.trace = data["lora"]["trace"].as<String>();
 
   conf.display.alwaysOn     = data["display"]["always_on"] | true;
   conf.display.timeout      = data["display"]["timeout"] | 10;
   conf.display.overwritePin = data["display"]["overwrite_pin"] | 0;
   conf.display.turn180      = data["display"]["turn180"] | true;
+  conf.display.showProfile  = data["display"]["show_profile"] | false;
+  conf.display.frameLimit   = data["display"]["frame_limit"] | 3;
 
   conf.ftp.active = data["ftp"]["active"] | false;
   JsonArray users = data["ftp"]["user"].as<JsonArray>();
@@ -106,12 +133,26 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
     conf.mqtt.will_message = data["mqtt"]["will_message"].as<String>();
   if (data["mqtt"].containsKey("birth_message"))
     conf.mqtt.birth_message = data["mqtt"]["birth_message"].as<String>();
+  if (data["mqtt"].containsKey("format"))
+    conf.mqtt.format = data["mqtt"]["format"].as<String>();
+  conf.mqtt.spool_size  = data["mqtt"]["spool_size"] | 16;
+  conf.mqtt.spool_flash = data["mqtt"]["spool_flash"] | 0;
+  conf.mqtt.replay_rate = data["mqtt"]["replay_rate"] | 10;
 
   conf.syslog.active = data["syslog"]["active"] | true;
   if (data["syslog"].containsKey("server"))
     conf.syslog.server = data["syslog"]["server"].as<String>();
   conf.syslog.port = data["syslog"]["port"] | 514;
 
+  conf.dedupe.window = data["dedupe"]["window"] | 30;
+
+  conf.memory.packetPool = data["memory"]["packet_pool"] | 32;
+  conf.memory.framePool  = data["memory"]["frame_pool"] | 4;
+  // a frame is created before the one it replaces on the display is released
+  if (conf.memory.framePool < 2) {
+    conf.memory.framePool = 2;
+  }
+
   if (data.containsKey("ntp_server"))
     conf.ntpServer = data["ntp_server"].as<String>();
 
@@ -151,7 +192,13 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
   data["aprs_is"]["server"]               = conf.aprs_is.server;
   data["aprs_is"]["port"]                 = conf.aprs_is.port;
   data["aprs_is"]["filter"]               = conf.aprs_is.filter;
+  data["aprs_is"]["gate_to_rf"]           = conf.aprs_is.gateToRf;
+  data["aprs_is"]["airtime_budget"]       = conf.aprs_is.airtimeBudget;
+  data["aprs_is"]["heard_window"]         = conf.aprs_is.heardWindow;
   data["digi"]["active"]                  = conf.digi.active;
+  data["digi"]["max_hops"]                = conf.digi.maxHops;
+  data["digi"]["viscous_delay"]           = conf.digi.viscousDelay;
+  data["digi"]["random_slots"]            = conf.digi.randomSlots;
   data["lora"]["frequency_rx"]            = conf.lora.frequencyRx;
   data["lora"]["gain_rx"]                 = conf.lora.gainRx;
   data["lora"]["frequency_tx"]            = conf.lora.frequencyTx;
@@ -160,10 +207,18 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
   data["lora"]["signal_bandwidth"]        = conf.lora.signalBandwidth;
   data["lora"]["coding_rate4"]            = conf.lora.codingRate4;
   data["lora"]["tx_enable"]               = conf.lora.tx_enable;
+  data["lora"]["dedicated_task"]          = conf.lora.dedicated_task;
+  data["lora"]["duty_cycle"]              = conf.lora.dutyCycle;
+  data["lora"]["channel_access"]          = conf.lora.channelAccess;
+  data["lora"]["persistence"]             = conf.lora.persistence;
+  data["lora"]["slot_time"]               = conf.lora.slotTime;
+  data["lora"]["trace"]                   = conf.lora.trace;
   data["display"]["always_on"]            = conf.display.alwaysOn;
   data["display"]["timeout"]              = conf.display.timeout;
   data["display"]["overwrite_pin"]        = conf.display.overwritePin;
   data["display"]["turn180"]              = conf.display.turn180;
+  data["display"]["show_profile"]         = conf.display.showProfile;
+  data["display"]["frame_limit"]          = conf.display.frameLimit;
   data["ftp"]["active"]                   = conf.ftp.active;
   JsonArray users                         = data["ftp"].createNestedArray("user");
   for (Configuration::Ftp::User u : conf.ftp.users) {
@@ -180,10 +235,27 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
   data["mqtt"]["will_active"]   = conf.mqtt.will_active;
   data["mqtt"]["will_topic"]    = conf.mqtt.will_topic;
   data["mqtt"]["birth_message"] = conf.mqtt.birth_message;
+  data["mqtt"]["format"]        = conf.mqtt.format;
+  data["mqtt"]["spool_size"]    = conf.mqtt.spool_size;
+  data["mqtt"]["spool_flash"]   = conf.mqtt.spool_flash;
+  data["mqtt"]["replay_rate"]   = conf.mqtt.replay_rate;
   data["syslog"]["active"]      = conf.syslog.active;
   data["syslog"]["server"]      = conf.syslog.server;
   data["syslog"]["port"]        = conf.syslog.port;
+  data["dedupe"]["window"]      = conf.dedupe.window;
+  data["memory"]["packet_pool"] = conf.memory.packetPool;
+  data["memory"]["frame_pool"]  = conf.memory.framePool;
   data["ntp_server"]            = conf.ntpServer;
 
+  JsonArray aliases = data["digi"].createNestedArray("aliases");
+  for (String alias : conf.digi.aliases) {
+    aliases.add(alias);
+  }
+
+  JsonArray failoverServers = data["aprs_is"].createNestedArray("failover_servers");
+  for (String server : conf.aprs_is.failoverServers) {
+    failoverServers.add(server);
+  }
+
   data["board"] = conf.board;
 }
@@ -64,27 +64,35 @@ public:
 
   class APRS_IS {
   public:
-    APRS_IS() : active(true), server("euro.aprs2.net"), port(14580) {
+    APRS_IS() : active(true), server("euro.aprs2.net"), port(14580), gateToRf(true), airtimeBudget(6), heardWindow(30) {
     }
 
-    bool   active;
-    String passcode;
-    String server;
-    int    port;
-    String filter;
+    bool              active;
+    String            passcode;
+    String            server;
+    std::list<String> failoverServers;
+    int               port;
+    String            filter;
+    bool              gateToRf;
+    int               airtimeBudget;
+    int               heardWindow;
   };
 
   class Digi {
   public:
-    Digi() : active(false) {
+    Digi() : active(false), maxHops(1), viscousDelay(0), randomSlots(0) {
     }
 
-    bool active;
+    bool              active;
+    std::list<String> aliases;
+    int               maxHops;
+    int               viscousDelay;
+    int               randomSlots;
   };
 
   class LoRa {
   public:
-    LoRa() : frequencyRx(433775000), gainRx(0), frequencyTx(433775000), power(20), spreadingFactor(12), signalBandwidth(125000), codingRate4(5), tx_enable(true) {
+    LoRa() : frequencyRx(433775000), gainRx(0), frequencyTx(433775000), power(20), spreadingFactor(12), signalBandwidth(125000), codingRate4(5), tx_enable(true), dedicated_task(false), dutyCycle(10.0), channelAccess(true), persistence(50), slotTime(0) {
     }
 
     long    frequencyRx;
@@ -95,17 +103,25 @@ public:
     long    signalBandwidth;
     int     codingRate4;
     bool    tx_enable;
+    bool    dedicated_task;
+    double  dutyCycle;
+    bool    channelAccess;
+    int     persistence;
+    int     slotTime;
+    String  trace; // packet trace on SPIFFS to replay instead of the modem, empty for the real one
   };
 
   class Display {
   public:
-    Display() : alwaysOn(true), timeout(10), overwritePin(0), turn180(true) {
+    Display() : alwaysOn(true), timeout(10), overwritePin(0), turn180(true), showProfile(false), frameLimit(3) {
     }
 
     bool alwaysOn;
     int  timeout;
     int  overwritePin;
     bool turn180;
+    bool showProfile;
+    int  frameLimit;
   };
 
   class Ftp {
@@ -125,7 +141,7 @@ public:
 
   class MQTT {
   public:
-    MQTT() : active(false), server(""), port(1883), name(""), password(""), topic("LoraAPRS/Data"), will_active(false), will_topic("LoraAPRS/State"), will_message("offline"), birth_message("online") {
+    MQTT() : active(false), server(""), port(1883), name(""), password(""), topic("LoraAPRS/Data"), will_active(false), will_topic("LoraAPRS/State"), will_message("offline"), birth_message("online"), format("json"), spool_size(16), spool_flash(0), replay_rate(10) {
     }
 
     bool   active;
@@ -138,6 +154,10 @@ public:
     String will_topic;
     String will_message;
     String birth_message;
+    String format;      // json or msgpack
+    int    spool_size;  // KB of RAM for messages waiting for the broker
+    int    spool_flash; // KB in SPIFFS once the RAM spool is full, 0 to drop the oldest instead
+    int    replay_rate; // messages per second, 0 for no limit
   };
 
   class Syslog {
@@ -150,6 +170,23 @@ public:
     int    port;
   };
 
+  class Dedupe {
+  public:
+    Dedupe() : window(30) {
+    }
+
+    int window;
+  };
+
+  class Memory {
+  public:
+    Memory() : packetPool(32), framePool(4) {
+    }
+
+    int packetPool;
+    int framePool;
+  };
+
   Configuration() : callsign("NOCALL-10"), ntpServer("pool.ntp.org"), board("") {
   }
 
@@ -164,6 +201,8 @@ public:
   Ftp     ftp;
   MQTT    mqtt;
   Syslog  syslog;
+  Dedupe  dedupe;
+  Memory  memory;
   String  ntpServer;
   String  board;
 };
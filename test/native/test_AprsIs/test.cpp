@@ -0,0 +1,410 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "APRS-IS/APRS-IS.h"
+
+// APRS-IS server on 127.0.0.1, driven from the test thread just like the client
+class FakeServer {
+public:
+  FakeServer() : _client(-1), _port(0) {
+    _listen = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(_listen, (struct sockaddr *)&address, sizeof(address));
+    listen(_listen, 4);
+    fcntl(_listen, F_SETFL, O_NONBLOCK);
+    socklen_t length = sizeof(address);
+    getsockname(_listen, (struct sockaddr *)&address, &length);
+    _port = ntohs(address.sin_port);
+  }
+
+  ~FakeServer() {
+    closeClient();
+    close(_listen);
+  }
+
+  uint16_t port() const {
+    return _port;
+  }
+
+  bool accepted() const {
+    return _client >= 0;
+  }
+
+  void poll() {
+    if (_client < 0) {
+      _client = accept(_listen, 0, 0);
+      if (_client < 0) {
+        return;
+      }
+      fcntl(_client, F_SETFL, O_NONBLOCK);
+      send(_greeting.c_str());
+    }
+    char    buffer[256];
+    ssize_t n;
+    while ((n = recv(_client, buffer, sizeof(buffer), 0)) > 0) {
+      received.append(buffer, n);
+    }
+    if (!_loginResponse.empty() && received.find('\n') != std::string::npos) {
+      send(_loginResponse.c_str());
+      _loginResponse.clear();
+    }
+  }
+
+  void send(const char *data) {
+    ::send(_client, data, strlen(data), MSG_NOSIGNAL);
+  }
+
+  void closeClient() {
+    if (_client >= 0) {
+      close(_client);
+      _client = -1;
+    }
+  }
+
+  void respond(const char *loginResponse) {
+    _loginResponse = loginResponse;
+  }
+
+  std::string received;
+
+private:
+  int         _listen;
+  int         _client;
+  uint16_t    _port;
+  std::string _greeting      = "# aprsc 2.1.10\r\n";
+  std::string _loginResponse = "# logresp NOCALL-10 verified, server T2TEST\r\n";
+};
+
+static uint32_t now;
+
+static void run(APRS_IS &client, FakeServer *a, FakeServer *b, uint32_t duration, uint32_t step = 10) {
+  for (uint32_t end = now + duration; now != end; now += step) {
+    client.loop(now);
+    if (a) {
+      a->poll();
+    }
+    if (b) {
+      b->poll();
+    }
+    usleep(100);
+  }
+}
+
+static std::shared_ptr<AprsPacket> receive(APRS_IS &client) {
+  std::shared_ptr<AprsPacket> packet;
+  for (int i = 0; i < 100 && !packet; i++) {
+    usleep(100);
+    packet = client.getAprsPacket();
+  }
+  return packet;
+}
+
+static uint16_t closedPort() {
+  FakeServer server;
+  return server.port();
+}
+
+void setUp(void) {
+  now = 1000;
+}
+
+void tearDown(void) {
+}
+
+void test_login_verified(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0", "r/48/14/50");
+  client.addServer("127.0.0.1", server.port());
+  TEST_ASSERT_EQUAL(APRS_IS::Idle, client.getState());
+
+  run(client, &server, 0, 200);
+  TEST_ASSERT_EQUAL(APRS_IS::Connected, client.getState());
+  TEST_ASSERT_TRUE(client.connected());
+  TEST_ASSERT_EQUAL(APRS_IS::ErrorNone, client.getLastError());
+  TEST_ASSERT_EQUAL_STRING("user NOCALL-10 pass 12345 vers Test 1.0 filter r/48/14/50\r\n", server.received.c_str());
+}
+
+void test_receive_packet(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+  TEST_ASSERT_TRUE(client.connected());
+
+  server.send("# aprsc 2.1.10 16 Oct 2026 10:00:00 GMT T2TEST\r\nOE5BPA-7>APLT00,WIDE1-1,qAR,OE5BPA-10:!4819.82N/01418.68E>test\r\n");
+  std::shared_ptr<AprsPacket> packet = receive(client);
+  TEST_ASSERT_TRUE(packet != 0);
+  TEST_ASSERT_EQUAL(OriginAprsIs, packet->getOrigin());
+  TEST_ASSERT_EQUAL_STRING_LEN("OE5BPA-7", packet->getSource().data, packet->getSource().length);
+  TEST_ASSERT_TRUE(client.getAprsPacket() == 0);
+}
+
+void test_receive_partial_lines(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+
+  server.send("OE5BPA-7>APLT00:!fir");
+  TEST_ASSERT_TRUE(receive(client) == 0);
+  server.send("st\r\n# keepalive\r\nOE5BPA-8>APLT");
+  std::shared_ptr<AprsPacket> packet = receive(client);
+  TEST_ASSERT_TRUE(packet != 0);
+  TEST_ASSERT_TRUE(packet->getBody().equals("!first"));
+  TEST_ASSERT_TRUE(receive(client) == 0);
+  server.send("00:!second\n");
+  packet = receive(client);
+  TEST_ASSERT_TRUE(packet != 0);
+  TEST_ASSERT_TRUE(packet->getSource().equals("OE5BPA-8"));
+  TEST_ASSERT_TRUE(packet->getBody().equals("!second"));
+}
+
+void test_receive_skips_overlong_line(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+
+  std::string overlong = "OE5BPA-7>APLT00:!" + std::string(APRS_IS::RX_BUFFER_SIZE + 100, 'x') + "\r\n";
+  server.send(overlong.c_str());
+  server.send("OE5BPA-9>APLT00:!after\r\n");
+  std::shared_ptr<AprsPacket> packet = receive(client);
+  TEST_ASSERT_TRUE(packet != 0);
+  TEST_ASSERT_TRUE(packet->getSource().equals("OE5BPA-9"));
+  TEST_ASSERT_TRUE(client.connected());
+}
+
+void test_receive_burst(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+
+  std::string burst;
+  for (int i = 0; i < 8; i++) {
+    burst += "# comment\r\nOE5BPA-7>APLT00:!" + std::to_string(i) + "\r\n";
+  }
+  server.send(burst.c_str());
+  TEST_ASSERT_TRUE(receive(client) != 0);
+  TEST_ASSERT_TRUE(client.hasReceivedLine());
+  int count = 1;
+  while (client.getAprsPacket()) {
+    count++;
+  }
+  TEST_ASSERT_EQUAL(8, count);
+  TEST_ASSERT_FALSE(client.hasReceivedLine());
+}
+
+void test_send_packet(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+  server.received.clear();
+
+  std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+  TEST_ASSERT_TRUE(packet->decode("OE5BPA-7>APLT00,WIDE1-1:!data"));
+  packet->setOrigin(OriginRf);
+  TEST_ASSERT_TRUE(client.sendMessage(packet));
+  run(client, &server, 0, APRS_IS::FLUSH_LATENCY + 20);
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,WIDE1-1,qAO,NOCALL-10:!data\r\n", server.received.c_str());
+  TEST_ASSERT_FALSE(client.hasPendingWrite());
+}
+
+void test_send_is_batched(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+  server.received.clear();
+
+  std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+  TEST_ASSERT_TRUE(packet->decode("OE5BPA-7>APLT00:!data"));
+  client.loop(now);
+  for (int i = 0; i < 5; i++) {
+    TEST_ASSERT_TRUE(client.sendMessage(packet));
+  }
+  TEST_ASSERT_EQUAL(now + APRS_IS::FLUSH_LATENCY, client.getFlushDeadline());
+  run(client, &server, 0, APRS_IS::FLUSH_LATENCY - 10);
+  TEST_ASSERT_EQUAL(0, server.received.size());
+
+  run(client, &server, 0, 20);
+  TEST_ASSERT_EQUAL(5 * strlen("OE5BPA-7>APLT00:!data\r\n"), server.received.size());
+  TEST_ASSERT_EQUAL(1, client.getFlushBytes().getCount());
+  TEST_ASSERT_EQUAL(5, client.getFlushPackets().getMax());
+  TEST_ASSERT_EQUAL(server.received.size(), client.getFlushBytes().getSum());
+  TEST_ASSERT_EQUAL(0, client.getFlushDeadline());
+}
+
+void test_send_flushes_when_full(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+
+  std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+  char                        line[AprsPacket::MAX_LENGTH + 1];
+  memset(line, 'x', sizeof(line) - 1);
+  line[sizeof(line) - 1] = 0;
+  memcpy(line, "OE5BPA-7>APLT00:!", 17);
+  TEST_ASSERT_TRUE(packet->decode(line));
+
+  client.loop(now);
+  int queued = 0;
+  while (client.canSend()) {
+    TEST_ASSERT_TRUE(client.sendMessage(packet));
+    queued++;
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(2, queued);
+  TEST_ASSERT_EQUAL(now, client.getFlushDeadline());
+  client.loop(now);
+  TEST_ASSERT_FALSE(client.hasPendingWrite());
+  TEST_ASSERT_EQUAL(queued, client.getFlushPackets().getMax());
+}
+
+void test_unverified_backs_off(void) {
+  FakeServer server;
+  server.respond("# logresp NOCALL-10 unverified, server T2TEST\r\n");
+  APRS_IS client;
+  client.setup("NOCALL-10", "-1", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+  TEST_ASSERT_EQUAL(APRS_IS::Backoff, client.getState());
+  TEST_ASSERT_EQUAL(APRS_IS::ErrorPasscode, client.getLastError());
+  TEST_ASSERT_GREATER_OR_EQUAL(APRS_IS::BACKOFF_MIN / 2, client.getBackoffDelay());
+  TEST_ASSERT_LESS_OR_EQUAL(APRS_IS::BACKOFF_MIN, client.getBackoffDelay());
+}
+
+void test_login_timeout_fails_over(void) {
+  FakeServer silent;
+  FakeServer working;
+  silent.respond("");
+  APRS_IS client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", silent.port());
+  client.addServer("127.0.0.1", working.port());
+
+  run(client, &silent, &working, APRS_IS::LOGIN_TIMEOUT - 100, 100);
+  TEST_ASSERT_EQUAL(APRS_IS::LoggingIn, client.getState());
+  run(client, &silent, &working, 200, 100);
+  TEST_ASSERT_EQUAL(APRS_IS::Backoff, client.getState());
+  TEST_ASSERT_EQUAL(APRS_IS::ErrorLoginTimeout, client.getLastError());
+  TEST_ASSERT_EQUAL(working.port(), client.getPort());
+
+  run(client, &silent, &working, APRS_IS::BACKOFF_MIN + 200);
+  TEST_ASSERT_EQUAL(APRS_IS::Connected, client.getState());
+  TEST_ASSERT_TRUE(working.accepted());
+  TEST_ASSERT_EQUAL(2, client.getConnectAttempts());
+}
+
+void test_refused_fails_over(void) {
+  FakeServer working;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", closedPort());
+  client.addServer("127.0.0.1", working.port());
+  run(client, 0, &working, 100);
+  TEST_ASSERT_EQUAL(APRS_IS::Backoff, client.getState());
+  TEST_ASSERT_EQUAL(APRS_IS::ErrorConnect, client.getLastError());
+
+  run(client, 0, &working, APRS_IS::BACKOFF_MIN + 200);
+  TEST_ASSERT_EQUAL(APRS_IS::Connected, client.getState());
+}
+
+void test_server_closes(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+  TEST_ASSERT_TRUE(client.connected());
+
+  server.closeClient();
+  for (int i = 0; i < 100 && client.connected(); i++) {
+    usleep(100);
+    client.getAprsPacket();
+  }
+  TEST_ASSERT_EQUAL(APRS_IS::Backoff, client.getState());
+  TEST_ASSERT_EQUAL(APRS_IS::ErrorClosed, client.getLastError());
+}
+
+void test_idle_timeout(void) {
+  FakeServer server;
+  APRS_IS    client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.addServer("127.0.0.1", server.port());
+  run(client, &server, 0, 200);
+  TEST_ASSERT_TRUE(client.connected());
+
+  now += APRS_IS::IDLE_TIMEOUT;
+  client.loop(now);
+  TEST_ASSERT_EQUAL(APRS_IS::Backoff, client.getState());
+  TEST_ASSERT_EQUAL(APRS_IS::ErrorIdleTimeout, client.getLastError());
+}
+
+void test_backoff_grows_with_jitter(void) {
+  const uint16_t port = closedPort();
+  APRS_IS        client;
+  client.setup("NOCALL-10", "12345", "Test", "1.0");
+  client.setRandomSeed(42);
+  client.addServer("127.0.0.1", port);
+
+  uint32_t base     = APRS_IS::BACKOFF_MIN;
+  bool     varied   = false;
+  uint32_t previous = 0;
+  for (int attempt = 0; attempt < 12; attempt++) {
+    for (int i = 0; i < 100 && client.getState() != APRS_IS::Backoff; i++) {
+      usleep(100);
+      client.loop(now);
+    }
+    TEST_ASSERT_EQUAL(APRS_IS::Backoff, client.getState());
+    const uint32_t delay = client.getBackoffDelay();
+    TEST_ASSERT_GREATER_OR_EQUAL(base / 2, delay);
+    TEST_ASSERT_LESS_OR_EQUAL(base, delay);
+    varied |= previous != 0 && delay != previous * 2;
+    previous = delay;
+
+    now += delay;
+    client.loop(now);
+    base = base * 2 < APRS_IS::BACKOFF_MAX ? base * 2 : APRS_IS::BACKOFF_MAX;
+  }
+  TEST_ASSERT_TRUE(varied);
+  TEST_ASSERT_EQUAL(13, client.getConnectAttempts());
+}
+
+int main(void) {
+  AprsPacket::getPool().begin(8);
+  UNITY_BEGIN();
+  RUN_TEST(test_login_verified);
+  RUN_TEST(test_receive_packet);
+  RUN_TEST(test_receive_partial_lines);
+  RUN_TEST(test_receive_skips_overlong_line);
+  RUN_TEST(test_receive_burst);
+  RUN_TEST(test_send_packet);
+  RUN_TEST(test_send_is_batched);
+  RUN_TEST(test_send_flushes_when_full);
+  RUN_TEST(test_unverified_backs_off);
+  RUN_TEST(test_login_timeout_fails_over);
+  RUN_TEST(test_refused_fails_over);
+  RUN_TEST(test_server_closes);
+  RUN_TEST(test_idle_timeout);
+  RUN_TEST(test_backoff_grows_with_jitter);
+  return UNITY_END();
+}
@@ -0,0 +1,228 @@
+#include <memory>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "Packet/AprsPacket.h"
+#include "Packet/RxStats.h"
+#include "System/TaskQueue.h"
+
+// count every heap allocation to see what a packet costs
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size);
+  if (p == 0) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static size_t receive(AprsPacket &packet, const char *text) {
+  uint8_t *raw = packet.getRawBuffer();
+  raw[0]       = '<';
+  raw[1]       = 0xff;
+  raw[2]       = 0x01;
+  memcpy(raw + AprsPacket::HEADER_LENGTH, text, strlen(text));
+  return AprsPacket::HEADER_LENGTH + strlen(text);
+}
+
+void test_decode_raw(void) {
+  AprsPacket packet;
+  TEST_ASSERT_TRUE(packet.decodeRaw(receive(packet, "OE5BPA-7>APLT00,WIDE1-1:!4819.82N/01418.68E>test")));
+  TEST_ASSERT_TRUE(packet.getSource().equals("OE5BPA-7"));
+  TEST_ASSERT_TRUE(packet.getDestination().equals("APLT00"));
+  TEST_ASSERT_TRUE(packet.getPath().equals("WIDE1-1"));
+  TEST_ASSERT_TRUE(packet.getBody().equals("!4819.82N/01418.68E>test"));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,WIDE1-1:!4819.82N/01418.68E>test", packet.c_str());
+}
+
+void test_decode_raw_rejects_unknown_header(void) {
+  AprsPacket packet;
+  size_t     length        = receive(packet, "OE5BPA-7>APLT00:>status");
+  packet.getRawBuffer()[1] = 'x';
+  TEST_ASSERT_FALSE(packet.decodeRaw(length));
+}
+
+void test_decode_without_path(void) {
+  AprsPacket packet;
+  TEST_ASSERT_TRUE(packet.decode("OE5BPA-7>APLT00:>status: with colon\r\n"));
+  TEST_ASSERT_TRUE(packet.getPath().empty());
+  TEST_ASSERT_TRUE(packet.getDestination().equals("APLT00"));
+  TEST_ASSERT_TRUE(packet.getBody().equals(">status: with colon"));
+  TEST_ASSERT_EQUAL(3 + strlen("OE5BPA-7>APLT00:>status: with colon"), packet.getRawLength());
+}
+
+void test_decode_invalid(void) {
+  AprsPacket packet;
+  TEST_ASSERT_FALSE(packet.decode("no header here"));
+  TEST_ASSERT_FALSE(packet.decode(">APLT00:body"));
+  TEST_ASSERT_FALSE(packet.decode("OE5BPA>APLT00 no body"));
+}
+
+void test_set_path(void) {
+  AprsPacket packet;
+  TEST_ASSERT_TRUE(packet.decode("OE5BPA-7>APLT00,WIDE1-1,WIDE2-2:>status"));
+  TEST_ASSERT_TRUE(packet.setPath("OE5BPA-10*,WIDE2-2", 18));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,OE5BPA-10*,WIDE2-2:>status", packet.c_str());
+  TEST_ASSERT_TRUE(packet.getPath().equals("OE5BPA-10*,WIDE2-2"));
+  TEST_ASSERT_TRUE(packet.setPath("", 0));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00:>status", packet.c_str());
+  TEST_ASSERT_TRUE(packet.setPath("WIDE1-1", 7));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,WIDE1-1:>status", packet.c_str());
+  TEST_ASSERT_TRUE(packet.getBody().equals(">status"));
+}
+
+void test_encode_gated(void) {
+  AprsPacket packet;
+  char       line[300];
+  TEST_ASSERT_TRUE(packet.decode("OE5BPA-7>APLT00,WIDE1-1:>status"));
+  TEST_ASSERT_EQUAL(strlen("OE5BPA-7>APLT00,WIDE1-1,qAO,OE5BPA-10:>status"), packet.encode(line, sizeof(line), "OE5BPA-10"));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,WIDE1-1,qAO,OE5BPA-10:>status", line);
+  TEST_ASSERT_TRUE(packet.decode("OE5BPA-7>APLT00:>status"));
+  packet.encode(line, sizeof(line), "OE5BPA-10");
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,qAO,OE5BPA-10:>status", line);
+  TEST_ASSERT_EQUAL(0, packet.encode(line, 10, "OE5BPA-10"));
+}
+
+void test_view_search(void) {
+  AprsPacket packet;
+  TEST_ASSERT_TRUE(packet.decode("OE5BPA-7>APLT00,WIDE1-1,RFONLY:>status"));
+  TEST_ASSERT_TRUE(packet.getPath().contains("RFONLY"));
+  TEST_ASSERT_FALSE(packet.getPath().contains("NOGATE"));
+  TEST_ASSERT_EQUAL(8, packet.getPath().indexOf("RFONLY"));
+  char source[10];
+  TEST_ASSERT_EQUAL(8, packet.getSource().copyTo(source, sizeof(source)));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7", source);
+}
+
+// RX -> router -> APRS-IS, MQTT and digi, like the firmware does it
+void test_rx_metadata(void) {
+  std::shared_ptr<AprsPacket> packet = AprsPacket::create();
+  TEST_ASSERT_EQUAL(RxOkay, packet->getRxMetadata().status);
+  TEST_ASSERT_EQUAL(0, packet->getRxMetadata().timestamp);
+
+  RxMetadata rx;
+  rx.rssi           = -112.5;
+  rx.snr            = -7.25;
+  rx.frequencyError = 812;
+  rx.timestamp      = 123456789;
+  packet->setRxMetadata(rx);
+  TEST_ASSERT_TRUE(packet->decode("OE5BPA-7>APLT00:!data"));
+
+  // the digi copy keeps what the original was received with
+  std::shared_ptr<AprsPacket> copy = AprsPacket::create(*packet);
+  TEST_ASSERT_EQUAL(123456789, copy->getRxMetadata().timestamp);
+  TEST_ASSERT_TRUE(copy->getRxMetadata().rssi == -112.5f);
+  TEST_ASSERT_TRUE(copy->getRxMetadata().snr == -7.25f);
+  TEST_ASSERT_TRUE(copy->getRxMetadata().frequencyError == 812.0f);
+}
+
+void test_rx_stats(void) {
+  RxStats    stats;
+  RxMetadata rx;
+  rx.rssi = -100;
+  rx.snr  = 5;
+  stats.add(rx);
+  rx.rssi = -120;
+  rx.snr  = -10;
+  stats.add(rx);
+  // not counted towards the link quality
+  rx.rssi   = -130;
+  rx.status = RxCrcError;
+  stats.add(rx);
+  rx.status = RxHeaderError;
+  stats.add(rx);
+
+  TEST_ASSERT_EQUAL(2, stats.getCount(RxOkay));
+  TEST_ASSERT_EQUAL(1, stats.getCount(RxCrcError));
+  TEST_ASSERT_EQUAL(1, stats.getCount(RxHeaderError));
+  TEST_ASSERT_TRUE(stats.getRssiMin() == -120.0f);
+  TEST_ASSERT_TRUE(stats.getRssiAverage() == -110.0f);
+  TEST_ASSERT_TRUE(stats.getRssiMax() == -100.0f);
+  TEST_ASSERT_TRUE(stats.getSnrMin() == -10.0f);
+  TEST_ASSERT_TRUE(stats.getSnrAverage() == -2.5f);
+  TEST_ASSERT_TRUE(stats.getSnrMax() == 5.0f);
+
+  stats.reset();
+  TEST_ASSERT_EQUAL(0, stats.getCount(RxOkay));
+  TEST_ASSERT_TRUE(stats.getRssiAverage() == 0.0f);
+}
+
+void test_allocations_per_packet(void) {
+  TaskQueue<std::shared_ptr<AprsPacket>> fromModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> toAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> toMQTT;
+  TaskQueue<std::shared_ptr<AprsPacket>> toModem;
+  char                                   line[300];
+
+  const size_t before = allocations;
+
+  // modem: packet and control block come from the pool
+  std::shared_ptr<AprsPacket> rx = AprsPacket::create();
+  rx->setOrigin(OriginRf);
+  TEST_ASSERT_TRUE(rx->decodeRaw(receive(*rx, "OE5BPA-7>APLT00,WIDE1-1:!4819.82N/01418.68E>test")));
+  fromModem.addElement(rx);
+  rx.reset();
+
+  // router: shares the packet, the digi copy is a new frame
+  std::shared_ptr<AprsPacket> packet = fromModem.getElement();
+  toMQTT.addElement(packet);
+  if (!packet->getSource().equals("OE5BPA-10") && !packet->getPath().contains("RFONLY")) {
+    toAprsIs.addElement(packet);
+  }
+  if (packet->getPath().contains("WIDE1-1")) {
+    std::shared_ptr<AprsPacket> digi = AprsPacket::create(*packet);
+    digi->setPath("OE5BPA-10*", 10);
+    toModem.addElement(digi);
+  }
+  packet.reset();
+
+  // APRS-IS writes into a fixed line buffer
+  std::shared_ptr<AprsPacket> isPacket = toAprsIs.getElement();
+  isPacket->encode(line, sizeof(line), "OE5BPA-10");
+  isPacket.reset();
+  toMQTT.getElement();
+  std::shared_ptr<AprsPacket> txPacket = toModem.getElement();
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLT00,OE5BPA-10*:!4819.82N/01418.68E>test", txPacket->c_str());
+  txPacket.reset();
+
+  const size_t perPacket = allocations - before;
+  TEST_PRINTF("heap allocations per packet (RX, APRS-IS, MQTT and digi): %u", (unsigned)perPacket);
+  TEST_ASSERT_EQUAL(0, perPacket);
+  TEST_ASSERT_EQUAL(0, AprsPacket::getPool().getUsed());
+  TEST_ASSERT_EQUAL(2, AprsPacket::getPool().getPeak());
+  TEST_ASSERT_EQUAL(0, AprsPacket::getPool().getFallbacks());
+}
+
+int main(int argc, char **argv) {
+  AprsPacket::getPool().begin(8);
+  UNITY_BEGIN();
+  RUN_TEST(test_decode_raw);
+  RUN_TEST(test_decode_raw_rejects_unknown_header);
+  RUN_TEST(test_decode_without_path);
+  RUN_TEST(test_decode_invalid);
+  RUN_TEST(test_set_path);
+  RUN_TEST(test_encode_gated);
+  RUN_TEST(test_view_search);
+  RUN_TEST(test_rx_metadata);
+  RUN_TEST(test_rx_stats);
+  RUN_TEST(test_allocations_per_packet);
+  return UNITY_END();
+}
@@ -0,0 +1,104 @@
+#include <unity.h>
+
+#include "LoRa/ChannelAccess.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_free_channel_persistent(void) {
+  ChannelAccess channel;
+  channel.setSlotTime(100);
+  channel.setPersistence(100);
+  TEST_ASSERT_FALSE(channel.isStarted());
+  channel.start(1000);
+  TEST_ASSERT_TRUE(channel.isStarted());
+  TEST_ASSERT_TRUE(channel.scanned(false, 1010));
+  TEST_ASSERT_EQUAL(10, channel.getWait(1010));
+  TEST_ASSERT_EQUAL(0, channel.getBusy());
+  TEST_ASSERT_EQUAL(0, channel.getDeferred());
+  TEST_ASSERT_FALSE(channel.isForced());
+
+  channel.reset();
+  TEST_ASSERT_FALSE(channel.isStarted());
+  TEST_ASSERT_EQUAL(0, channel.getWait(2000));
+}
+
+void test_persistence(void) {
+  ChannelAccess channel;
+  channel.setSlotTime(100);
+  channel.setPersistence(25);
+  channel.setRandomSeed(42);
+  channel.setMaxWait(0);
+
+  // every packet goes out eventually, waiting whole slots
+  uint32_t deferred = 0;
+  for (int i = 0; i < 200; i++) {
+    uint32_t now = i * 100000;
+    channel.start(now);
+    while (!channel.scanned(false, now)) {
+      TEST_ASSERT_EQUAL(now + 100, channel.getNotBefore());
+      now = channel.getNotBefore();
+    }
+    deferred += channel.getDeferred();
+    TEST_ASSERT_EQUAL(channel.getDeferred() * 100, channel.getWait(now));
+  }
+  // on average three slots per packet with p = 0.25
+  TEST_ASSERT_TRUE(deferred > 400 && deferred < 800);
+
+  channel.setPersistence(0);
+  TEST_ASSERT_EQUAL(0, channel.getPersistence());
+  channel.setPersistence(150);
+  TEST_ASSERT_EQUAL(100, channel.getPersistence());
+}
+
+void test_busy_backoff(void) {
+  ChannelAccess channel;
+  channel.setSlotTime(100);
+  channel.setRandomSeed(7);
+  channel.setMaxWait(0);
+  channel.start(0);
+
+  uint32_t now = 0;
+  for (uint16_t busy = 1; busy <= 8; busy++) {
+    TEST_ASSERT_FALSE(channel.scanned(true, now));
+    TEST_ASSERT_EQUAL(busy, channel.getBusy());
+    const uint32_t window = 1u << (busy < ChannelAccess::MAX_BACKOFF_EXPONENT ? busy : ChannelAccess::MAX_BACKOFF_EXPONENT);
+    const uint32_t delay  = channel.getNotBefore() - now;
+    TEST_ASSERT_EQUAL(0, delay % 100);
+    TEST_ASSERT_TRUE(delay >= 100 && delay <= window * 100);
+    now = channel.getNotBefore();
+  }
+  TEST_ASSERT_TRUE(channel.scanned(false, now));
+  TEST_ASSERT_FALSE(channel.isForced());
+}
+
+void test_max_wait(void) {
+  ChannelAccess channel;
+  channel.setSlotTime(100);
+  channel.setMaxWait(1000);
+  channel.start(0);
+  TEST_ASSERT_FALSE(channel.scanned(true, 500));
+  // still busy, but it waited long enough
+  TEST_ASSERT_TRUE(channel.scanned(true, 1000));
+  TEST_ASSERT_TRUE(channel.isForced());
+  TEST_ASSERT_EQUAL(2, channel.getBusy());
+
+  // a free channel after the max wait is not forced
+  channel.setPersistence(0);
+  channel.start(5000);
+  TEST_ASSERT_FALSE(channel.scanned(false, 5000));
+  TEST_ASSERT_TRUE(channel.scanned(false, 6000));
+  TEST_ASSERT_FALSE(channel.isForced());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_free_channel_persistent);
+  RUN_TEST(test_persistence);
+  RUN_TEST(test_busy_backoff);
+  RUN_TEST(test_max_wait);
+  return UNITY_END();
+}
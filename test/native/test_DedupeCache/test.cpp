@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include "Packet/DedupeCache.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static AprsPacket packet(const char *line) {
+  AprsPacket p;
+  TEST_ASSERT_TRUE(p.decode(line));
+  return p;
+}
+
+void test_duplicate_within_window(void) {
+  DedupeCache cache;
+  AprsPacket  p = packet("OE5BPA-7>APLT00,WIDE1-1:!4819.82N/01418.68E>test");
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeIGate, 1000));
+  TEST_ASSERT_TRUE(cache.isDuplicate(p, DedupeIGate, 1000 + 29999));
+  TEST_ASSERT_EQUAL(1, cache.getHits(DedupeIGate));
+  TEST_ASSERT_EQUAL(1, cache.getMisses(DedupeIGate));
+}
+
+void test_window_expires(void) {
+  DedupeCache cache(10000);
+  AprsPacket  p = packet("OE5BPA-7>APLT00:>status");
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeIGate, 0));
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeIGate, 10000));
+  TEST_ASSERT_TRUE(cache.isDuplicate(p, DedupeIGate, 15000));
+}
+
+void test_path_is_ignored(void) {
+  DedupeCache cache;
+  TEST_ASSERT_FALSE(cache.isDuplicate(packet("OE5BPA-7>APLT00,WIDE1-1:!data"), DedupeDigi, 0));
+  TEST_ASSERT_TRUE(cache.isDuplicate(packet("OE5BPA-7>APLT00,OE5XYZ-10*:!data"), DedupeDigi, 500));
+  TEST_ASSERT_FALSE(cache.isDuplicate(packet("OE5BPA-7>APLT00,WIDE1-1:!other"), DedupeDigi, 500));
+  TEST_ASSERT_FALSE(cache.isDuplicate(packet("OE5BPA-8>APLT00,WIDE1-1:!data"), DedupeDigi, 500));
+  TEST_ASSERT_FALSE(cache.isDuplicate(packet("OE5BPA-7>APLT01,WIDE1-1:!data"), DedupeDigi, 500));
+}
+
+void test_paths_decide_separately(void) {
+  DedupeCache cache;
+  AprsPacket  p = packet("OE5BPA-7>APLT00:!data");
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeIGate, 0));
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeDigi, 100));
+  TEST_ASSERT_TRUE(cache.isDuplicate(p, DedupeIGate, 200));
+  TEST_ASSERT_TRUE(cache.isDuplicate(p, DedupeDigi, 200));
+  TEST_ASSERT_EQUAL(1, cache.getHits(DedupeIGate));
+  TEST_ASSERT_EQUAL(1, cache.getHits(DedupeDigi));
+}
+
+void test_wrap_around_of_millis(void) {
+  DedupeCache cache;
+  AprsPacket  p = packet("OE5BPA-7>APLT00:!data");
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeIGate, 0xFFFFF000));
+  TEST_ASSERT_TRUE(cache.isDuplicate(p, DedupeIGate, 0x00001000));
+  TEST_ASSERT_FALSE(cache.isDuplicate(p, DedupeIGate, 0x00010000));
+}
+
+void test_full_table_evicts_oldest(void) {
+  DedupeCache cache;
+  char        line[64];
+  // far more distinct packets than slots within one window
+  for (uint32_t i = 0; i < 4 * DedupeCache::SLOTS; i++) {
+    snprintf(line, sizeof(line), "OE5BPA-7>APLT00:!packet %u", (unsigned)i);
+    TEST_ASSERT_FALSE(cache.isDuplicate(packet(line), DedupeIGate, i));
+  }
+  TEST_ASSERT_TRUE(cache.getEvictions() > 0);
+  // the most recent ones are still known
+  snprintf(line, sizeof(line), "OE5BPA-7>APLT00:!packet %u", (unsigned)(4 * DedupeCache::SLOTS - 1));
+  TEST_ASSERT_TRUE(cache.isDuplicate(packet(line), DedupeIGate, 4 * DedupeCache::SLOTS));
+}
+
+void test_expired_slots_are_reused(void) {
+  DedupeCache cache(1000);
+  char        line[64];
+  for (uint32_t round = 0; round < 10; round++) {
+    for (uint32_t i = 0; i < DedupeCache::SLOTS / 2; i++) {
+      snprintf(line, sizeof(line), "OE5BPA-7>APLT00:!round %u packet %u", (unsigned)round, (unsigned)i);
+      TEST_ASSERT_FALSE(cache.isDuplicate(packet(line), DedupeIGate, round * 2000));
+    }
+  }
+  TEST_ASSERT_EQUAL(0, cache.getEvictions());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_duplicate_within_window);
+  RUN_TEST(test_window_expires);
+  RUN_TEST(test_path_is_ignored);
+  RUN_TEST(test_paths_decide_separately);
+  RUN_TEST(test_wrap_around_of_millis);
+  RUN_TEST(test_full_table_evicts_oldest);
+  RUN_TEST(test_expired_slots_are_reused);
+  return UNITY_END();
+}
@@ -0,0 +1,178 @@
+#include <string.h>
+#include <unity.h>
+
+#include "Packet/DedupeCache.h"
+#include "Packet/Digipeater.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// path in, expected decision and path out
+struct PathVector {
+  const char *path;
+  DigiResult  result;
+  const char *expected;
+};
+
+static const PathVector FILL_IN_VECTORS[] = {
+    {"WIDE1-1", DigiAlias, "OE5BPA-10*"},
+    {"WIDE1-1,WIDE2-1", DigiAlias, "OE5BPA-10*,WIDE2-1"},
+    {"OE5BPA-10", DigiDirect, "OE5BPA-10*"},
+    {"OE5BPA-10,WIDE2-1", DigiDirect, "OE5BPA-10*,WIDE2-1"},
+    {"OE1ABC*,OE5BPA-10", DigiDirect, "OE1ABC,OE5BPA-10*"},
+    {"WIDE2-2", DigiHopLimit, 0},
+    {"WIDE2-1", DigiHopLimit, 0},
+    {"OE5BPA-10*,WIDE2-1", DigiLoop, 0},
+    {"OE5BPA-10,OE1ABC*,WIDE2-1", DigiLoop, 0},
+    {"OE1ABC*", DigiNotForUs, 0},
+    {"OE1ABC*,WIDE1*", DigiNotForUs, 0},
+    {"OE1ABC", DigiNotForUs, 0},
+    {"", DigiNotForUs, 0},
+    {"TCPIP*", DigiNotForUs, 0},
+    {"WIDE1", DigiNotForUs, 0},
+    {"WIDE1-0", DigiNotForUs, 0},
+    {"RELAY", DigiNotForUs, 0},
+    {"OE1ABC-123456", DigiInvalidPath, 0},
+    {"A,B,C,D,E,F,G,H,I", DigiInvalidPath, 0},
+};
+
+static const PathVector WIDE_VECTORS[] = {
+    {"WIDE1-1", DigiAlias, "OE5BPA-10*"},
+    {"WIDE2-2", DigiWide, "OE5BPA-10*,WIDE2-1"},
+    {"WIDE2-1", DigiWide, "OE5BPA-10,WIDE2*"},
+    {"WIDE1-1,WIDE2-2", DigiAlias, "OE5BPA-10*,WIDE2-2"},
+    {"OE1ABC*,WIDE2-2", DigiWide, "OE1ABC,OE5BPA-10*,WIDE2-1"},
+    {"OE1ABC,WIDE1*,WIDE2-2", DigiWide, "OE1ABC,WIDE1,OE5BPA-10*,WIDE2-1"},
+    {"OE1ABC,WIDE1,OE1XYZ,WIDE2*", DigiNotForUs, 0},
+    {"OE1ABC,WIDE1,OE1XYZ*,WIDE2-1", DigiWide, "OE1ABC,WIDE1,OE1XYZ,OE5BPA-10,WIDE2*"},
+    {"WIDE3-3", DigiHopLimit, 0},
+    {"WIDE2-3", DigiHopLimit, 0},
+    {"WIDE7-7", DigiHopLimit, 0},
+    {"RELAY", DigiAlias, "OE5BPA-10*"},
+    {"RELAY,WIDE2-2", DigiAlias, "OE5BPA-10*,WIDE2-2"},
+    // no room for our call anymore, only the decrement
+    {"A*,B,C,D,E,F,G,WIDE2-2", DigiNotForUs, 0},
+    {"A,B,C,D,E,F,G*,WIDE2-2", DigiWide, "A,B,C,D,E,F,G*,WIDE2-1"},
+    {"A,B,C,D,E,F,G*,WIDE2-1", DigiWide, "A,B,C,D,E,F,G,WIDE2*"},
+};
+
+static void runVectors(const Digipeater &digi, const PathVector *vectors, size_t count) {
+  char message[128];
+  for (size_t i = 0; i < count; i++) {
+    char line[128];
+    strcpy(line, "OE5XXX-7>APLT00");
+    if (strlen(vectors[i].path) > 0) {
+      strcat(line, ",");
+      strcat(line, vectors[i].path);
+    }
+    strcat(line, ":!data");
+    AprsPacket packet;
+    TEST_ASSERT_TRUE_MESSAGE(packet.decode(line), line);
+
+    char       path[AprsPacket::MAX_LENGTH];
+    size_t     length = 0;
+    DigiResult result = digi.decide(packet, path, sizeof(path), length);
+    snprintf(message, sizeof(message), "path '%s': %s", vectors[i].path, Digipeater::toString(result));
+    TEST_ASSERT_EQUAL_MESSAGE(vectors[i].result, result, message);
+    TEST_ASSERT_EQUAL_MESSAGE(vectors[i].expected != 0, Digipeater::shouldRepeat(result), message);
+    if (vectors[i].expected != 0) {
+      TEST_ASSERT_EQUAL_STRING_MESSAGE(vectors[i].expected, path, message);
+      TEST_ASSERT_EQUAL_MESSAGE(strlen(vectors[i].expected), length, message);
+    }
+  }
+}
+
+void test_fill_in_digi(void) {
+  Digipeater digi;
+  digi.setCallsign("OE5BPA-10");
+  digi.addAlias("WIDE1-1");
+  runVectors(digi, FILL_IN_VECTORS, sizeof(FILL_IN_VECTORS) / sizeof(FILL_IN_VECTORS[0]));
+}
+
+void test_wide_digi(void) {
+  Digipeater digi;
+  digi.setCallsign("OE5BPA-10");
+  digi.addAlias("WIDE1-1");
+  digi.addAlias("RELAY");
+  digi.setMaxHops(2);
+  runVectors(digi, WIDE_VECTORS, sizeof(WIDE_VECTORS) / sizeof(WIDE_VECTORS[0]));
+}
+
+void test_repeated_packet_is_a_loop(void) {
+  Digipeater digi;
+  digi.setCallsign("OE5BPA-10");
+  digi.setMaxHops(3);
+
+  AprsPacket packet;
+  TEST_ASSERT_TRUE(packet.decode("OE5XXX-7>APLT00,WIDE3-3:!data"));
+  char   path[AprsPacket::MAX_LENGTH];
+  size_t length = 0;
+  TEST_ASSERT_EQUAL(DigiWide, digi.decide(packet, path, sizeof(path), length));
+  TEST_ASSERT_TRUE(packet.setPath(path, length));
+  TEST_ASSERT_EQUAL_STRING("OE5XXX-7>APLT00,OE5BPA-10*,WIDE3-2:!data", packet.c_str());
+  // heard back from the next digipeater
+  TEST_ASSERT_TRUE(packet.decode("OE5XXX-7>APLT00,OE5BPA-10,OE1ABC*,WIDE3-1:!data"));
+  TEST_ASSERT_EQUAL(DigiLoop, digi.decide(packet, path, sizeof(path), length));
+}
+
+void test_aliases_are_limited(void) {
+  Digipeater digi;
+  for (size_t i = 0; i < Digipeater::MAX_ALIASES; i++) {
+    TEST_ASSERT_TRUE(digi.addAlias("RELAY"));
+  }
+  TEST_ASSERT_FALSE(digi.addAlias("TRACE"));
+  digi.clearAliases();
+  TEST_ASSERT_FALSE(digi.addAlias(""));
+  TEST_ASSERT_FALSE(digi.addAlias("TOOLONGALIAS"));
+  TEST_ASSERT_TRUE(digi.addAlias("TRACE"));
+}
+
+void test_viscous_delay(void) {
+  ViscousQueue queue;
+  queue.setDelay(5000);
+  TEST_ASSERT_EQUAL(0, queue.getNextDue());
+
+  std::shared_ptr<AprsPacket> a = std::make_shared<AprsPacket>();
+  std::shared_ptr<AprsPacket> b = std::make_shared<AprsPacket>();
+  TEST_ASSERT_TRUE(a->decode("OE5XXX-7>APLT00,WIDE2-2:!a"));
+  TEST_ASSERT_TRUE(b->decode("OE5XXX-7>APLT00,WIDE2-2:!b"));
+  TEST_ASSERT_TRUE(queue.hold(a, DedupeCache::hashOf(*a), 1000));
+  TEST_ASSERT_TRUE(queue.hold(b, DedupeCache::hashOf(*b), 2000));
+  TEST_ASSERT_EQUAL(6000, queue.getNextDue());
+
+  // another digi repeated a first
+  AprsPacket heard;
+  TEST_ASSERT_TRUE(heard.decode("OE5XXX-7>APLT00,OE1ABC*,WIDE2-1:!a"));
+  TEST_ASSERT_TRUE(queue.cancel(DedupeCache::hashOf(heard)));
+  TEST_ASSERT_FALSE(queue.cancel(DedupeCache::hashOf(heard)));
+  TEST_ASSERT_EQUAL(1, queue.getCancelled());
+  TEST_ASSERT_EQUAL(7000, queue.getNextDue());
+
+  TEST_ASSERT_FALSE(queue.release(6999));
+  TEST_ASSERT_TRUE(queue.release(7000) == b);
+  TEST_ASSERT_FALSE(queue.release(8000));
+  TEST_ASSERT_EQUAL(0, queue.getNextDue());
+}
+
+void test_viscous_queue_full(void) {
+  ViscousQueue                queue;
+  std::shared_ptr<AprsPacket> packet = std::make_shared<AprsPacket>();
+  for (size_t i = 0; i < ViscousQueue::SLOTS; i++) {
+    TEST_ASSERT_TRUE(queue.hold(packet, i, 0));
+  }
+  TEST_ASSERT_FALSE(queue.hold(packet, 100, 0));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fill_in_digi);
+  RUN_TEST(test_wide_digi);
+  RUN_TEST(test_repeated_packet_is_a_loop);
+  RUN_TEST(test_aliases_are_limited);
+  RUN_TEST(test_viscous_delay);
+  RUN_TEST(test_viscous_queue_full);
+  return UNITY_END();
+}
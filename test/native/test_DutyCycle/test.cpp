@@ -0,0 +1,99 @@
+#include <unity.h>
+
+#include "LoRa/Airtime.h"
+#include "LoRa/DutyCycle.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_airtime(void) {
+  const LoRaModulation sf12(12, 125000, 5, 8);
+  TEST_ASSERT_EQUAL(32768, LoRaAirtime::symbolMicros(sf12));
+  TEST_ASSERT_TRUE(LoRaAirtime::lowDataRate(sf12));
+  TEST_ASSERT_EQUAL(401408, LoRaAirtime::preambleMicros(sf12));
+  TEST_ASSERT_EQUAL(1319, LoRaAirtime::packetMillis(sf12, 20));
+  TEST_ASSERT_EQUAL(2302, LoRaAirtime::packetMillis(sf12, 50));
+
+  const LoRaModulation sf9(9, 125000, 7, 8);
+  TEST_ASSERT_FALSE(LoRaAirtime::lowDataRate(sf9));
+  // 4.096 ms symbols, 8 + 12 * 7 payload symbols
+  TEST_ASSERT_EQUAL(50176 + 92 * 4096, LoRaAirtime::packetMicros(sf9, 50));
+
+  // without CRC and header
+  const LoRaModulation implicit(7, 250000, 5, 8, false, false);
+  TEST_ASSERT_EQUAL(6272 + 33 * 512, LoRaAirtime::packetMicros(implicit, 20));
+}
+
+void test_airtime_constexpr(void) {
+  constexpr uint32_t airtime = LoRaAirtime::packetMillis(LoRaModulation(), 100);
+  static_assert(airtime > 3000 && airtime < 4000, "SF12 100 bytes");
+  TEST_ASSERT_EQUAL(LoRaAirtime::packetMillis(LoRaModulation(), 100), airtime);
+}
+
+void test_unlimited(void) {
+  DutyCycle duty;
+  TEST_ASSERT_EQUAL(0, duty.getDelay(100000, 0));
+}
+
+void test_within_budget(void) {
+  DutyCycle duty(100, 60000);
+  TEST_ASSERT_EQUAL(6000, duty.getBudget());
+  TEST_ASSERT_EQUAL(0, duty.getDelay(2000, 0));
+  duty.record(2000, 0);
+  duty.record(2000, 1000);
+  TEST_ASSERT_EQUAL(0, duty.getDelay(2000, 2000));
+  duty.record(2000, 2000);
+  TEST_ASSERT_EQUAL(6000, duty.getUsed(2000));
+  TEST_ASSERT_EQUAL(100, duty.getUtilisation(2000));
+  TEST_ASSERT_EQUAL(DutyCycle::NEVER, duty.getDelay(7000, 2000));
+}
+
+void test_delay_until_airtime_leaves_window(void) {
+  // 1 s slices
+  DutyCycle duty(100, 60000);
+  duty.record(3000, 500);
+  duty.record(3000, 10500);
+  // the first transmission leaves with its slice at 60 s, the second at 70 s
+  TEST_ASSERT_EQUAL(60000 - 20000, duty.getDelay(1000, 20000));
+  TEST_ASSERT_EQUAL(70000 - 20000, duty.getDelay(6000, 20000));
+  TEST_ASSERT_EQUAL(0, duty.getDelay(1000, 60000));
+  TEST_ASSERT_EQUAL(3000, duty.getUsed(60000));
+  TEST_ASSERT_EQUAL(0, duty.getUsed(70000));
+}
+
+void test_long_idle(void) {
+  DutyCycle duty(10, 3600000);
+  duty.record(36000, 0);
+  TEST_ASSERT_EQUAL(10, duty.getUtilisation(1000));
+  TEST_ASSERT_TRUE(duty.getDelay(1000, 1000) > 0);
+  TEST_ASSERT_EQUAL(0, duty.getUsed(10 * 3600000));
+  TEST_ASSERT_EQUAL(0, duty.getDelay(36000, 10 * 3600000));
+  duty.record(1000, 10 * 3600000);
+  TEST_ASSERT_EQUAL(1000, duty.getUsed(10 * 3600000 + 3599999));
+  TEST_ASSERT_EQUAL(0, duty.getUsed(10 * 3600000 + 3600000));
+}
+
+void test_millis_wrap(void) {
+  DutyCycle      duty(100, 60000);
+  const uint32_t start = UINT32_MAX - 5000;
+  duty.setLimit(100, 60000, start);
+  duty.record(6000, start);
+  TEST_ASSERT_EQUAL(60000, duty.getDelay(1000, start));
+  TEST_ASSERT_EQUAL(50000, duty.getDelay(1000, start + 10000));
+  TEST_ASSERT_EQUAL(0, duty.getDelay(1000, start + 60000));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_airtime);
+  RUN_TEST(test_airtime_constexpr);
+  RUN_TEST(test_unlimited);
+  RUN_TEST(test_within_budget);
+  RUN_TEST(test_delay_until_airtime_leaves_window);
+  RUN_TEST(test_long_idle);
+  RUN_TEST(test_millis_wrap);
+  return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#include <unity.h>
+
+#include "Display/FrameQueue.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+class NamedFrame : public DisplayFrame {
+public:
+  NamedFrame(const char *name, const char *source) : _name(name), _source(source) {
+  }
+  void drawStatusPage(Bitmap &) override {
+  }
+  const char *getSource() const override {
+    return _source;
+  }
+  const char *getName() const {
+    return _name;
+  }
+
+private:
+  const char *_name;
+  const char *_source;
+};
+
+static std::shared_ptr<DisplayFrame> frame(const char *name, const char *source = 0) {
+  return std::make_shared<NamedFrame>(name, source);
+}
+
+static void expectFront(FrameQueue &queue, const char *name) {
+  TEST_ASSERT_FALSE(queue.empty());
+  TEST_ASSERT_EQUAL_STRING(name, static_cast<NamedFrame &>(queue.front()).getName());
+}
+
+void test_fifo(void) {
+  FrameQueue queue;
+  queue.push(frame("a"));
+  queue.push(frame("b"));
+  TEST_ASSERT_EQUAL(2, queue.size());
+  expectFront(queue, "a");
+  queue.pop();
+  expectFront(queue, "b");
+  queue.pop();
+  TEST_ASSERT_TRUE(queue.empty());
+  queue.pop();
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_same_source_replaces(void) {
+  FrameQueue queue;
+  queue.push(frame("a1", "LoRa:A"));
+  queue.push(frame("b1", "LoRa:B"));
+  queue.push(frame("a2", "LoRa:A"));
+  queue.push(frame("x"));
+  queue.push(frame("y"));
+  TEST_ASSERT_EQUAL(4, queue.size());
+  TEST_ASSERT_EQUAL(1, queue.getReplaced());
+  expectFront(queue, "a2");
+  queue.pop();
+  expectFront(queue, "b1");
+}
+
+void test_overflow_keeps_shown_and_latest(void) {
+  FrameQueue queue;
+  queue.setLimit(3);
+  static const char *names[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11"};
+  for (const char *name : names) {
+    queue.push(frame(name));
+  }
+  TEST_ASSERT_EQUAL(3, queue.size());
+  TEST_ASSERT_EQUAL(9, queue.getOverflow());
+  TEST_ASSERT_EQUAL(9, queue.getDropped());
+  expectFront(queue, "0");
+  queue.pop();
+  expectFront(queue, "10");
+  queue.pop();
+  expectFront(queue, "11");
+  TEST_ASSERT_EQUAL(9, queue.getOverflow());
+  queue.pop();
+  TEST_ASSERT_EQUAL(0, queue.getOverflow());
+  TEST_ASSERT_EQUAL(9, queue.getDropped());
+}
+
+void test_frames_are_released(void) {
+  FrameQueue                    queue;
+  std::shared_ptr<DisplayFrame> first = frame("first");
+  std::weak_ptr<DisplayFrame>   watch = first;
+  queue.setLimit(1);
+  queue.push(first);
+  first.reset();
+  TEST_ASSERT_FALSE(watch.expired());
+  queue.push(frame("second"));
+  TEST_ASSERT_TRUE(watch.expired());
+  expectFront(queue, "second");
+  TEST_ASSERT_EQUAL(1, queue.getOverflow());
+}
+
+void test_limit_is_clamped(void) {
+  FrameQueue queue;
+  queue.setLimit(0);
+  TEST_ASSERT_EQUAL(1, queue.getLimit());
+  queue.setLimit(100);
+  TEST_ASSERT_EQUAL(FrameQueue::MAX_FRAMES, queue.getLimit());
+  for (size_t i = 0; i < 2 * FrameQueue::MAX_FRAMES; i++) {
+    queue.push(frame("f"));
+  }
+  TEST_ASSERT_EQUAL(FrameQueue::MAX_FRAMES, queue.size());
+  queue.setLimit(2);
+  TEST_ASSERT_EQUAL(2, queue.size());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo);
+  RUN_TEST(test_same_source_replaces);
+  RUN_TEST(test_overflow_keeps_shown_and_latest);
+  RUN_TEST(test_frames_are_released);
+  RUN_TEST(test_limit_is_clamped);
+  return UNITY_END();
+}
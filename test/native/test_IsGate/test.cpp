@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include "Packet/IsGate.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static AprsPacket packet(const char *line) {
+  AprsPacket p;
+  TEST_ASSERT_TRUE(p.decode(line));
+  return p;
+}
+
+static IsGate gate() {
+  IsGate g;
+  g.setCallsign("OE5BPA-10");
+  g.setBudget(60000, 0);
+  return g;
+}
+
+void test_message_to_heard_station(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  g.heardOnRf(packet("OE5XYZ-7>APLT00,WIDE1-1:!4819.82N/01418.68E>"), 1000);
+  TEST_ASSERT_EQUAL(IsGateOkay, g.gate(packet("DL1ABC>APRS,TCPIP*,qAC,T2TEST::OE5XYZ-7 :hello{01"), out, 2000));
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-10>APLG01:}DL1ABC>APRS,TCPIP,OE5BPA-10*::OE5XYZ-7 :hello{01", out.c_str());
+  TEST_ASSERT_EQUAL(OriginLocal, out.getOrigin());
+  TEST_ASSERT_EQUAL(1, g.getCount(IsGateOkay));
+}
+
+void test_not_heard(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  g.heardOnRf(packet("OE5XYZ-7>APLT00:!data"), 0);
+  TEST_ASSERT_EQUAL(IsGateNotHeard, g.gate(packet("DL1ABC>APRS,TCPIP*::OE5XYZ-8 :hello"), out, 1000));
+  // heard too long ago
+  TEST_ASSERT_EQUAL(IsGateNotHeard, g.gate(packet("DL1ABC>APRS,TCPIP*::OE5XYZ-7 :hello"), out, 30 * 60 * 1000));
+  TEST_ASSERT_EQUAL(2, g.getCount(IsGateNotHeard));
+}
+
+void test_only_messages(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  g.heardOnRf(packet("OE5XYZ-7>APLT00:!data"), 0);
+  TEST_ASSERT_EQUAL(IsGateNoMessage, g.gate(packet("DL1ABC>APRS,TCPIP*:!4819.82N/01418.68E>"), out, 1000));
+  TEST_ASSERT_EQUAL(IsGateNoMessage, g.gate(packet("DL1ABC>APRS,TCPIP*::OE5XYZ-7"), out, 1000));
+  TEST_ASSERT_EQUAL(IsGateNoGate, g.gate(packet("DL1ABC>APRS,TCPXX*::OE5XYZ-7 :hello"), out, 1000));
+  TEST_ASSERT_EQUAL(IsGateNoGate, g.gate(packet("DL1ABC>APRS,NOGATE::OE5XYZ-7 :hello"), out, 1000));
+}
+
+void test_sender_heard_on_rf(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  g.heardOnRf(packet("OE5XYZ-7>APLT00:!data"), 0);
+  g.heardOnRf(packet("OE5XYZ-8>APLT00:!data"), 0);
+  TEST_ASSERT_EQUAL(IsGateSenderOnRf, g.gate(packet("OE5XYZ-8>APRS,TCPIP*::OE5XYZ-7 :hello"), out, 1000));
+}
+
+void test_disabled(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  g.setActive(false);
+  g.heardOnRf(packet("OE5XYZ-7>APLT00:!data"), 0);
+  TEST_ASSERT_EQUAL(IsGateDisabled, g.gate(packet("DL1ABC>APRS,TCPIP*::OE5XYZ-7 :hello"), out, 1000));
+}
+
+void test_too_long(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  char       line[AprsPacket::MAX_LENGTH + 1];
+  memset(line, 'x', sizeof(line) - 1);
+  line[sizeof(line) - 1] = 0;
+  memcpy(line, "DL1ABC>APRS,TCPIP*::OE5XYZ-7 :", 30);
+  g.heardOnRf(packet("OE5XYZ-7>APLT00:!data"), 0);
+  TEST_ASSERT_EQUAL(IsGateTooLong, g.gate(packet(line), out, 1000));
+}
+
+void test_airtime(void) {
+  IsGate g;
+  // SF12, 125 kHz, CR 4/5, preamble 8: 20 bytes take 1318.9 ms, 50 bytes 2301.9 ms
+  TEST_ASSERT_EQUAL(1319, g.airtimeOf(20));
+  TEST_ASSERT_EQUAL(2302, g.airtimeOf(50));
+  g.setModulation(LoRaModulation(7, 125000, 5, 8));
+  TEST_ASSERT_EQUAL(57, g.airtimeOf(20));
+}
+
+void test_airtime_budget(void) {
+  IsGate     g = gate();
+  AprsPacket out;
+  g.setBudget(6000, 0);
+  g.heardOnRf(packet("OE5XYZ-7>APLT00:!data"), 0);
+  AprsPacket     message  = packet("DL1ABC>APRS,TCPIP*::OE5XYZ-7 :hello");
+  const uint32_t airtime  = g.airtimeOf(AprsPacket::HEADER_LENGTH + strlen("OE5BPA-10>APLG01:}DL1ABC>APRS,TCPIP,OE5BPA-10*::OE5XYZ-7 :hello"));
+  const uint32_t possible = 6000 / airtime;
+  for (uint32_t i = 0; i < possible; i++) {
+    TEST_ASSERT_EQUAL(IsGateOkay, g.gate(message, out, 1000));
+  }
+  TEST_ASSERT_EQUAL(IsGateBudget, g.gate(message, out, 1000));
+  TEST_ASSERT_EQUAL(1, g.getCount(IsGateBudget));
+  // refills with 6 s per minute, so one packet is back after airtime * 10
+  TEST_ASSERT_EQUAL(IsGateOkay, g.gate(message, out, 1000 + airtime * 10));
+  TEST_ASSERT_EQUAL(IsGateBudget, g.gate(message, out, 1000 + airtime * 10));
+}
+
+void test_token_bucket(void) {
+  TokenBucket bucket;
+  bucket.setBudget(600, 0);
+  TEST_ASSERT_EQUAL(600, bucket.getAvailable(0));
+  TEST_ASSERT_TRUE(bucket.take(500, 0));
+  TEST_ASSERT_FALSE(bucket.take(200, 0));
+  TEST_ASSERT_EQUAL(110, bucket.getAvailable(1000));
+  // never more than one minute worth
+  TEST_ASSERT_EQUAL(600, bucket.getAvailable(10 * 60 * 1000));
+}
+
+void test_heard_list_replaces_oldest(void) {
+  HeardList list;
+  char      call[10];
+  for (uint32_t i = 0; i < HeardList::SLOTS; i++) {
+    snprintf(call, sizeof(call), "OE5A-%u", (unsigned)i);
+    list.heard(PacketView(call, strlen(call)), i);
+  }
+  TEST_ASSERT_EQUAL(HeardList::SLOTS, list.size(100));
+  list.heard(PacketView("OE5A-0", 6), 100);
+  list.heard(PacketView("DL1NEW", 6), 101);
+  TEST_ASSERT_TRUE(list.wasHeard(PacketView("OE5A-0", 6), 102));
+  TEST_ASSERT_FALSE(list.wasHeard(PacketView("OE5A-1", 6), 102));
+  TEST_ASSERT_TRUE(list.wasHeard(PacketView("DL1NEW", 6), 102));
+  TEST_ASSERT_EQUAL(HeardList::SLOTS, list.size(102));
+}
+
+int main(void) {
+  AprsPacket::getPool().begin(8);
+  UNITY_BEGIN();
+  RUN_TEST(test_message_to_heard_station);
+  RUN_TEST(test_not_heard);
+  RUN_TEST(test_only_messages);
+  RUN_TEST(test_sender_heard_on_rf);
+  RUN_TEST(test_disabled);
+  RUN_TEST(test_too_long);
+  RUN_TEST(test_airtime);
+  RUN_TEST(test_airtime_budget);
+  RUN_TEST(test_token_bucket);
+  RUN_TEST(test_heard_list_replaces_oldest);
+  return UNITY_END();
+}
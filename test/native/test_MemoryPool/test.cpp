@@ -0,0 +1,140 @@
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <unity.h>
+
+#include "System/MemoryPool.h"
+#include "System/TaskQueue.h"
+
+struct Frame {
+  explicit Frame(int id) : id(id) {
+  }
+  int  id;
+  char text[100];
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_fallback_before_begin(void) {
+  MemoryPool pool("test", 64);
+  void      *p = pool.allocate(32);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL(1, pool.getFallbacks());
+  TEST_ASSERT_EQUAL(0, pool.getUsed());
+  pool.deallocate(p, 32);
+}
+
+void test_allocate_and_release(void) {
+  MemoryPool pool("test", 60);
+  TEST_ASSERT_TRUE(pool.begin(4));
+  TEST_ASSERT_EQUAL(4, pool.getSlots());
+  TEST_ASSERT_EQUAL(0, pool.getBlockSize() % alignof(std::max_align_t));
+  TEST_ASSERT_TRUE(pool.getBlockSize() >= 60);
+
+  void *blocks[4];
+  for (int i = 0; i < 4; i++) {
+    blocks[i] = pool.allocate(60);
+    TEST_ASSERT_NOT_NULL(blocks[i]);
+  }
+  TEST_ASSERT_EQUAL(4, pool.getUsed());
+  TEST_ASSERT_EQUAL(0, pool.getFallbacks());
+
+  // empty: the fifth one comes from the heap
+  void *heap = pool.allocate(60);
+  TEST_ASSERT_EQUAL(1, pool.getFallbacks());
+  pool.deallocate(heap, 60);
+
+  // too large for a block
+  heap = pool.allocate(pool.getBlockSize() + 1);
+  TEST_ASSERT_EQUAL(2, pool.getFallbacks());
+  pool.deallocate(heap, pool.getBlockSize() + 1);
+
+  for (int i = 0; i < 4; i++) {
+    pool.deallocate(blocks[i], 60);
+  }
+  TEST_ASSERT_EQUAL(0, pool.getUsed());
+  TEST_ASSERT_EQUAL(4, pool.getPeak());
+
+  // released blocks are handed out again
+  void *again = pool.allocate(60);
+  TEST_ASSERT_TRUE(again == blocks[0] || again == blocks[1] || again == blocks[2] || again == blocks[3]);
+  pool.deallocate(again, 60);
+}
+
+void test_begin_only_once(void) {
+  MemoryPool pool("test", 16);
+  TEST_ASSERT_FALSE(pool.begin(0));
+  TEST_ASSERT_TRUE(pool.begin(2));
+  TEST_ASSERT_TRUE(pool.begin(10));
+  TEST_ASSERT_EQUAL(2, pool.getSlots());
+}
+
+void test_allocate_shared_single_block(void) {
+  MemoryPool pool("frames", sizeof(Frame) + MemoryPool::SHARED_OVERHEAD);
+  pool.begin(2);
+  {
+    std::shared_ptr<Frame> a = std::allocate_shared<Frame>(PoolAllocator<Frame>(pool), 1);
+    std::shared_ptr<Frame> b = a;
+    TEST_ASSERT_EQUAL(1, a->id);
+    TEST_ASSERT_EQUAL(1, pool.getUsed());
+    TEST_ASSERT_EQUAL(0, pool.getFallbacks());
+  }
+  TEST_ASSERT_EQUAL(0, pool.getUsed());
+}
+
+void test_pools_are_listed(void) {
+  MemoryPool pool("listed", 16);
+  bool       found = false;
+  for (MemoryPool const *p = MemoryPool::getFirst(); p != 0; p = p->getNext()) {
+    found |= p == &pool;
+  }
+  TEST_ASSERT_TRUE(found);
+}
+
+// allocated by a producer thread, released by the consumer, like packets from the radio task
+void test_threads(void) {
+  const int                            COUNT = 200000;
+  MemoryPool                           pool("threads", sizeof(Frame) + MemoryPool::SHARED_OVERHEAD);
+  TaskQueue<std::shared_ptr<Frame>, 8> queue(TaskQueueOverflow::Reject);
+  pool.begin(16);
+
+  std::thread producer([&]() {
+    for (int i = 0; i < COUNT; i++) {
+      std::shared_ptr<Frame> frame = std::allocate_shared<Frame>(PoolAllocator<Frame>(pool), i);
+      while (!queue.addElement(frame)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < COUNT) {
+    std::shared_ptr<Frame> frame = queue.getElement();
+    if (!frame) {
+      std::this_thread::yield();
+      continue;
+    }
+    TEST_ASSERT_EQUAL(expected, frame->id);
+    expected++;
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL(0, pool.getUsed());
+  TEST_ASSERT_TRUE(pool.getPeak() <= 16);
+  TEST_ASSERT_EQUAL(0, pool.getFallbacks());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fallback_before_begin);
+  RUN_TEST(test_allocate_and_release);
+  RUN_TEST(test_begin_only_once);
+  RUN_TEST(test_allocate_shared_single_block);
+  RUN_TEST(test_pools_are_listed);
+  RUN_TEST(test_threads);
+  return UNITY_END();
+}
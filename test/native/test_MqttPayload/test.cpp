@@ -0,0 +1,123 @@
+#include <string.h>
+#include <unity.h>
+
+#include "Packet/MqttPayload.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static AprsPacket rfPacket(const char *line) {
+  AprsPacket p;
+  TEST_ASSERT_TRUE(p.decode(line));
+  p.setOrigin(OriginRf);
+  RxMetadata rx;
+  rx.rssi           = -97.5;
+  rx.snr            = 6.25;
+  rx.frequencyError = -120;
+  p.setRxMetadata(rx);
+  return p;
+}
+
+void test_json(void) {
+  AprsPacket p = rfPacket("OE5BPA-7>APLRT1,WIDE1-1:!4812.34N/01410.12E>");
+  char       out[512];
+  size_t     length = MqttPayload::encodeJson(p, "Position Without Timestamp", out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"source\":\"OE5BPA-7\",\"destination\":\"APLRT1\",\"path\":\"WIDE1-1\",\"type\":\"Position Without Timestamp\",\"data\":\"!4812.34N/01410.12E>\",\"rssi\":-97.5,\"snr\":6.25,\"frequency_error\":-120}", out);
+  TEST_ASSERT_EQUAL(strlen(out), length);
+
+  // no link quality for packets that did not come from RF
+  p.setOrigin(OriginAprsIs);
+  MqttPayload::encodeJson(p, "Status", out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"source\":\"OE5BPA-7\",\"destination\":\"APLRT1\",\"path\":\"WIDE1-1\",\"type\":\"Status\",\"data\":\"!4812.34N/01410.12E>\"}", out);
+}
+
+void test_json_escapes(void) {
+  AprsPacket p;
+  TEST_ASSERT_TRUE(p.decode("OE5BPA-7>APLRT1:>say \"hi\" \\ \x01"));
+  char out[256];
+  MqttPayload::encodeJson(p, "Status", out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"source\":\"OE5BPA-7\",\"destination\":\"APLRT1\",\"path\":\"\",\"type\":\"Status\",\"data\":\">say \\\"hi\\\" \\\\ \\u0001\"}", out);
+}
+
+// line feeds are dropped from the body, as before the payload was serialized by hand
+void test_body_newlines(void) {
+  AprsPacket p;
+  TEST_ASSERT_TRUE(p.decode("OE5BPA-7>APLRT1:>two\r\nlines"));
+  char out[256];
+  MqttPayload::encodeJson(p, "Status", out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"source\":\"OE5BPA-7\",\"destination\":\"APLRT1\",\"path\":\"\",\"type\":\"Status\",\"data\":\">two\\rlines\"}", out);
+
+  const size_t   length = MqttPayload::encodeMsgPack(p, "Status", out, sizeof(out));
+  const uint8_t *data   = (const uint8_t *)memmem(out, length, "\xa4" "data", 5);
+  TEST_ASSERT_NOT_NULL(data);
+  TEST_ASSERT_EQUAL(0xa0 | 10, data[5]);
+  TEST_ASSERT_EQUAL_MEMORY(">two\rlines", data + 6, 10);
+  TEST_ASSERT_EQUAL(out + length, (const char *)data + 16);
+}
+
+void test_json_too_long(void) {
+  AprsPacket p = rfPacket("OE5BPA-7>APLRT1:>status");
+  char       out[64];
+  TEST_ASSERT_EQUAL(0, MqttPayload::encodeJson(p, "Status", out, sizeof(out)));
+
+  char         exact[256];
+  const size_t length = MqttPayload::encodeJson(p, "Status", exact, sizeof(exact));
+  // the NUL has to fit as well
+  TEST_ASSERT_EQUAL(0, MqttPayload::encodeJson(p, "Status", exact, length));
+  TEST_ASSERT_EQUAL(length, MqttPayload::encodeJson(p, "Status", exact, length + 1));
+}
+
+void test_msgpack(void) {
+  AprsPacket p = rfPacket("OE5BPA-7>APLRT1:>status");
+  uint8_t    out[256];
+  size_t     length = MqttPayload::encodeMsgPack(p, "Status", (char *)out, sizeof(out));
+
+  const uint8_t expected[] = {
+      0x88,                                                                                                          // map of 8
+      0xa6, 's', 'o', 'u', 'r', 'c', 'e', 0xa8, 'O', 'E', '5', 'B', 'P', 'A', '-', '7',                              //
+      0xab, 'd', 'e', 's', 't', 'i', 'n', 'a', 't', 'i', 'o', 'n', 0xa6, 'A', 'P', 'L', 'R', 'T', '1',               //
+      0xa4, 'p', 'a', 't', 'h', 0xa0,                                                                                //
+      0xa4, 't', 'y', 'p', 'e', 0xa6, 'S', 't', 'a', 't', 'u', 's',                                                  //
+      0xa4, 'd', 'a', 't', 'a', 0xa7, '>', 's', 't', 'a', 't', 'u', 's',                                             //
+      0xa4, 'r', 's', 's', 'i', 0xca, 0xc2, 0xc3, 0x00, 0x00,                                                        // -97.5
+      0xa3, 's', 'n', 'r', 0xca, 0x40, 0xc8, 0x00, 0x00,                                                             // 6.25
+      0xaf, 'f', 'r', 'e', 'q', 'u', 'e', 'n', 'c', 'y', '_', 'e', 'r', 'r', 'o', 'r', 0xca, 0xc2, 0xf0, 0x00, 0x00, // -120
+  };
+  TEST_ASSERT_EQUAL(sizeof(expected), length);
+  TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(expected));
+
+  // longer strings use str8
+  AprsPacket longBody;
+  TEST_ASSERT_TRUE(longBody.decode("OE5BPA-7>APLRT1:>this status text is longer than thirty-one bytes"));
+  length = MqttPayload::encodeMsgPack(longBody, "Status", (char *)out, sizeof(out));
+  TEST_ASSERT_EQUAL(0x85, out[0]);
+  const uint8_t *data = (const uint8_t *)memmem(out, length, "\xa4" "data", 5);
+  TEST_ASSERT_NOT_NULL(data);
+  TEST_ASSERT_EQUAL(0xd9, data[5]);
+  TEST_ASSERT_EQUAL(strlen(">this status text is longer than thirty-one bytes"), data[6]);
+}
+
+void test_format(void) {
+  MqttFormat format;
+  TEST_ASSERT_TRUE(MqttPayload::parseFormat("msgpack", format));
+  TEST_ASSERT_EQUAL(MqttFormatMsgPack, format);
+  TEST_ASSERT_TRUE(MqttPayload::parseFormat("json", format));
+  TEST_ASSERT_EQUAL(MqttFormatJson, format);
+  TEST_ASSERT_FALSE(MqttPayload::parseFormat("cbor", format));
+  TEST_ASSERT_EQUAL(MqttFormatJson, format);
+  TEST_ASSERT_EQUAL_STRING("msgpack", MqttPayload::toString(MqttFormatMsgPack));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_json);
+  RUN_TEST(test_json_escapes);
+  RUN_TEST(test_body_newlines);
+  RUN_TEST(test_json_too_long);
+  RUN_TEST(test_msgpack);
+  RUN_TEST(test_format);
+  return UNITY_END();
+}
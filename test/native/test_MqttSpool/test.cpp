@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "Packet/MqttSpool.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void push(MqttSpool &spool, const char *message) {
+  TEST_ASSERT_TRUE(spool.push(message, strlen(message)));
+}
+
+static void expectNext(MqttSpool &spool, const char *message, uint32_t now) {
+  char         out[64];
+  const size_t length = spool.peek(out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(message), length);
+  out[length] = 0;
+  TEST_ASSERT_EQUAL_STRING(message, out);
+  spool.sent(now);
+}
+
+void test_fifo_and_confirm(void) {
+  MqttSpool spool;
+  TEST_ASSERT_TRUE(spool.begin(256));
+  spool.setConfirmDelay(1000);
+  push(spool, "one");
+  push(spool, "two");
+  TEST_ASSERT_EQUAL(2, spool.getPending());
+  TEST_ASSERT_TRUE(spool.canSend(0));
+
+  expectNext(spool, "one", 100);
+  expectNext(spool, "two", 600);
+  TEST_ASSERT_EQUAL(0, spool.getPending());
+  TEST_ASSERT_EQUAL(2, spool.getInFlight());
+  TEST_ASSERT_EQUAL(0, spool.peek(0, 0));
+
+  TEST_ASSERT_EQUAL(0, spool.confirm(1099));
+  TEST_ASSERT_EQUAL(1, spool.confirm(1100));
+  TEST_ASSERT_EQUAL(1, spool.confirm(1600));
+  TEST_ASSERT_EQUAL(0, spool.getInFlight());
+  TEST_ASSERT_EQUAL(0, spool.getUsedBytes());
+  TEST_ASSERT_EQUAL(2, spool.getConfirmed());
+}
+
+void test_resend_after_disconnect(void) {
+  MqttSpool spool;
+  spool.begin(256);
+  push(spool, "one");
+  push(spool, "two");
+  push(spool, "three");
+  expectNext(spool, "one", 0);
+  expectNext(spool, "two", 0);
+
+  // connection lost before the messages were confirmed: they go again, in order
+  spool.resend();
+  TEST_ASSERT_EQUAL(3, spool.getPending());
+  TEST_ASSERT_EQUAL(2, spool.getResent());
+  expectNext(spool, "one", 10);
+  expectNext(spool, "two", 10);
+  expectNext(spool, "three", 10);
+}
+
+void test_full_drops_oldest(void) {
+  MqttSpool spool;
+  // three records of 6 + 4 bytes
+  spool.begin(30);
+  push(spool, "msg1");
+  push(spool, "msg2");
+  push(spool, "msg3");
+  TEST_ASSERT_FALSE(spool.hasRoom(4));
+  push(spool, "msg4");
+  TEST_ASSERT_EQUAL(1, spool.getDropped());
+  TEST_ASSERT_EQUAL(3, spool.getPending());
+  expectNext(spool, "msg2", 0);
+
+  // a message in flight is dropped before pending ones
+  push(spool, "msg5");
+  TEST_ASSERT_EQUAL(2, spool.getDropped());
+  TEST_ASSERT_EQUAL(0, spool.getInFlight());
+  expectNext(spool, "msg3", 0);
+
+  // never fits
+  TEST_ASSERT_FALSE(spool.push("this one is far too long!", 25));
+  TEST_ASSERT_EQUAL(30, spool.getPeakBytes());
+}
+
+void test_wrap_around(void) {
+  MqttSpool spool;
+  spool.begin(50);
+  spool.setConfirmDelay(0);
+  char message[16];
+  for (int i = 0; i < 100; i++) {
+    snprintf(message, sizeof(message), "message %d", i);
+    push(spool, message);
+    expectNext(spool, message, i);
+    TEST_ASSERT_EQUAL(1, spool.confirm(i));
+  }
+  TEST_ASSERT_EQUAL(0, spool.getDropped());
+}
+
+void test_rate_limit(void) {
+  MqttSpool spool;
+  spool.begin(256);
+  spool.setRate(10, 2, 0);
+  for (int i = 0; i < 5; i++) {
+    push(spool, "msg");
+  }
+  // the burst goes at once, then one every 100 ms
+  TEST_ASSERT_TRUE(spool.canSend(0));
+  spool.sent(0);
+  TEST_ASSERT_TRUE(spool.canSend(0));
+  spool.sent(0);
+  TEST_ASSERT_FALSE(spool.canSend(50));
+  TEST_ASSERT_EQUAL(100, spool.getNextSend(50));
+  TEST_ASSERT_TRUE(spool.canSend(100));
+  spool.sent(100);
+  TEST_ASSERT_FALSE(spool.canSend(150));
+  TEST_ASSERT_TRUE(spool.canSend(200));
+
+  // nothing pending, nothing to wait for
+  spool.clear();
+  TEST_ASSERT_EQUAL(0, spool.getNextSend(300));
+  TEST_ASSERT_FALSE(spool.canSend(300));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo_and_confirm);
+  RUN_TEST(test_resend_after_disconnect);
+  RUN_TEST(test_full_drops_oldest);
+  RUN_TEST(test_wrap_around);
+  RUN_TEST(test_rate_limit);
+  return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#include <string.h>
+#include <unity.h>
+
+#include "LoRa/PacketTrace.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_read_records(void) {
+  const char *text = "# comment\n"
+                     "\n"
+                     "1500 -97.5 6.25 ok OE5BPA-7>APLRT1,WIDE1-1:!4812.34N/01410.12E>\r\n"
+                     "2000 -120 -12 crc OE5BPA-7>APLRT1:>status with spaces";
+  PacketTrace trace;
+  trace.begin(text, strlen(text));
+
+  TEST_ASSERT_TRUE(trace.available());
+  TEST_ASSERT_EQUAL(1500, trace.getNextTime());
+  TEST_ASSERT_EQUAL(AprsPacket::HEADER_LENGTH + strlen("OE5BPA-7>APLRT1,WIDE1-1:!4812.34N/01410.12E>"), trace.getNextLength());
+
+  uint8_t    data[AprsPacket::HEADER_LENGTH + AprsPacket::MAX_LENGTH];
+  RxMetadata rx;
+  size_t     length = trace.read(data, sizeof(data), rx);
+  TEST_ASSERT_EQUAL('<', data[0]);
+  TEST_ASSERT_EQUAL_STRING_LEN("OE5BPA-7>APLRT1,WIDE1-1:!4812.34N/01410.12E>", (const char *)data + AprsPacket::HEADER_LENGTH, length - AprsPacket::HEADER_LENGTH);
+  TEST_ASSERT_TRUE(rx.rssi == -97.5f);
+  TEST_ASSERT_TRUE(rx.snr == 6.25f);
+  TEST_ASSERT_EQUAL(RxOkay, rx.status);
+  TEST_ASSERT_EQUAL(1500000, rx.timestamp);
+
+  length = trace.read(data, sizeof(data), rx);
+  TEST_ASSERT_EQUAL(RxCrcError, rx.status);
+  TEST_ASSERT_EQUAL(AprsPacket::HEADER_LENGTH + strlen("OE5BPA-7>APLRT1:>status with spaces"), length);
+  TEST_ASSERT_FALSE(trace.available());
+  TEST_ASSERT_EQUAL(0, trace.read(data, sizeof(data), rx));
+  TEST_ASSERT_EQUAL(4, trace.getLineNumber());
+  TEST_ASSERT_EQUAL(0, trace.getErrors());
+}
+
+void test_malformed_lines_are_skipped(void) {
+  const char *text = "100 -90 5 ok A>B:one\n"
+                     "x -90 5 ok A>B:bad time\n"
+                     "200 -90 5 maybe A>B:bad status\n"
+                     "300 -90 5 ok\n"
+                     "50 -90 5 ok A>B:backwards\n"
+                     "400 -90 5 header A>B:two\n";
+  PacketTrace trace;
+  trace.begin(text, strlen(text));
+
+  uint8_t    data[AprsPacket::HEADER_LENGTH + AprsPacket::MAX_LENGTH];
+  RxMetadata rx;
+  TEST_ASSERT_EQUAL(100, trace.getNextTime());
+  trace.read(data, sizeof(data), rx);
+  TEST_ASSERT_EQUAL(400, trace.getNextTime());
+  trace.read(data, sizeof(data), rx);
+  TEST_ASSERT_EQUAL(RxHeaderError, rx.status);
+  TEST_ASSERT_FALSE(trace.available());
+  TEST_ASSERT_EQUAL(4, trace.getErrors());
+
+  trace.rewind();
+  TEST_ASSERT_TRUE(trace.available());
+  TEST_ASSERT_EQUAL(100, trace.getNextTime());
+}
+
+void test_record_too_long_for_buffer(void) {
+  const char *text = "100 -90 5 ok A>B:one\n"
+                     "200 -90 5 ok A>B:two\n";
+  PacketTrace trace;
+  trace.begin(text, strlen(text));
+
+  uint8_t    data[8];
+  RxMetadata rx;
+  TEST_ASSERT_EQUAL(0, trace.read(data, sizeof(data), rx));
+  TEST_ASSERT_TRUE(trace.available());
+  TEST_ASSERT_EQUAL(200, trace.getNextTime());
+  trace.skip();
+  TEST_ASSERT_FALSE(trace.available());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_read_records);
+  RUN_TEST(test_malformed_lines_are_skipped);
+  RUN_TEST(test_record_too_long_for_buffer);
+  return UNITY_END();
+}
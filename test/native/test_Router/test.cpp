@@ -0,0 +1,109 @@
+#include <unity.h>
+
+#include "Packet/Router.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static std::shared_ptr<AprsPacket> packet(const char *line) {
+  std::shared_ptr<AprsPacket> p = AprsPacket::create();
+  TEST_ASSERT_TRUE(p->decode(line));
+  p->setOrigin(OriginRf);
+  return p;
+}
+
+class Queues {
+public:
+  Queues() : router(toModem, toAprsIs, toMQTT) {
+    router.setCallsign("OE5GW-10");
+    router.setUplink(true);
+    router.setDigi(true);
+    router.setMQTT(true);
+    router.getIsGate().setBudget(60000, 0);
+  }
+
+  TxQueue                                toModem;
+  TaskQueue<std::shared_ptr<AprsPacket>> toAprsIs;
+  TaskQueue<std::shared_ptr<AprsPacket>> toMQTT;
+  Router                                 router;
+};
+
+void test_uplink_and_digi(void) {
+  Queues  q;
+  RfRoute route = q.router.fromRf(packet("OE5BPA-7>APLRT1,WIDE1-1:!4812.34N/01410.12E>"), 1000);
+  TEST_ASSERT_EQUAL(RouteUplinkForwarded, route.uplink);
+  TEST_ASSERT_EQUAL(RouteDigiQueued, route.digi);
+  TEST_ASSERT_EQUAL_STRING("OE5BPA-7>APLRT1,OE5GW-10,WIDE1*:!4812.34N/01410.12E>", route.digiPacket->c_str());
+  TEST_ASSERT_EQUAL(1, q.toAprsIs.size());
+  TEST_ASSERT_EQUAL(1, q.toMQTT.size());
+
+  TxQueue::Entry entry;
+  TEST_ASSERT_EQUAL(TxQueueReady, q.toModem.pop(entry, 1000));
+  TEST_ASSERT_EQUAL(TxClassDigi, entry.txClass);
+
+  // the same packet again through another digi
+  route = q.router.fromRf(packet("OE5BPA-7>APLRT1,OE5DIG-10*,WIDE1*:!4812.34N/01410.12E>"), 2000);
+  TEST_ASSERT_EQUAL(RouteUplinkDuplicate, route.uplink);
+  TEST_ASSERT_EQUAL(RouteDigiNoRepeat, route.digi);
+  TEST_ASSERT_EQUAL(1, q.toAprsIs.size());
+}
+
+void test_own_and_rfonly(void) {
+  Queues  q;
+  RfRoute route = q.router.fromRf(packet("OE5GW-10>APLG01,WIDE1-1:>status"), 0);
+  TEST_ASSERT_EQUAL(RouteUplinkOwnPacket, route.uplink);
+  TEST_ASSERT_EQUAL(RouteDigiDisabled, route.digi);
+
+  route = q.router.fromRf(packet("OE5BPA-7>APLRT1,RFONLY:>status"), 0);
+  TEST_ASSERT_EQUAL(RouteUplinkNoGate, route.uplink);
+  TEST_ASSERT_TRUE(q.toAprsIs.empty());
+  TEST_ASSERT_TRUE(q.toModem.empty());
+}
+
+void test_viscous_delay(void) {
+  Queues q;
+  q.router.getViscousQueue().setDelay(5000);
+  // WIDE2-2 is more than the default of one hop
+  RfRoute route = q.router.fromRf(packet("OE5BPA-7>APLRT1,WIDE2-2:>status"), 1000);
+  TEST_ASSERT_EQUAL(RouteDigiNoRepeat, route.digi);
+
+  q.router.getDigipeater().setMaxHops(2);
+  route = q.router.fromRf(packet("OE5BPA-7>APLRT1,WIDE2-2:>other"), 1000);
+  TEST_ASSERT_EQUAL(RouteDigiDelayed, route.digi);
+  TEST_ASSERT_EQUAL(6000, q.router.getDeadline());
+  TEST_ASSERT_EQUAL(0, q.router.release(5999));
+  TEST_ASSERT_EQUAL(1, q.router.release(6000));
+  TEST_ASSERT_FALSE(q.toModem.empty());
+}
+
+void test_message_from_aprs_is(void) {
+  Queues q;
+  q.router.fromRf(packet("OE5XYZ-7>APLT00:!4819.82N/01418.68E>"), 1000);
+
+  std::shared_ptr<AprsPacket> aprsIs = AprsPacket::create();
+  TEST_ASSERT_TRUE(aprsIs->decode("DL1ABC>APRS,TCPIP*,qAC,T2TEST::OE5XYZ-7 :hello{01"));
+  std::shared_ptr<AprsPacket> rf;
+  TEST_ASSERT_EQUAL(IsGateOkay, q.router.fromAprsIs(aprsIs, 2000, rf));
+  TEST_ASSERT_NOT_NULL(rf.get());
+
+  TxQueue::Entry entry;
+  TEST_ASSERT_EQUAL(TxQueueReady, q.toModem.pop(entry, 2000));
+  TEST_ASSERT_EQUAL(TxClassIsToRf, entry.txClass);
+
+  TEST_ASSERT_TRUE(aprsIs->decode("DL1ABC>APRS,TCPIP*,qAC,T2TEST::OE5ABC-7 :hello{02"));
+  TEST_ASSERT_EQUAL(IsGateNotHeard, q.router.fromAprsIs(aprsIs, 2000, rf));
+  TEST_ASSERT_TRUE(rf == nullptr);
+}
+
+int main(void) {
+  AprsPacket::getPool().begin(32);
+  UNITY_BEGIN();
+  RUN_TEST(test_uplink_and_digi);
+  RUN_TEST(test_own_and_rfonly);
+  RUN_TEST(test_viscous_delay);
+  RUN_TEST(test_message_from_aprs_is);
+  return UNITY_END();
+}
@@ -0,0 +1,114 @@
+#include <string.h>
+#include <unity.h>
+
+#include "LoRa/SimulatedRadio.h"
+
+static const LoRaModulation SF7(7, 125000, 5, 8);
+
+// airtime of "A>B:one" and friends with the LoRa APRS header
+static const uint32_t AIRTIME = LoRaAirtime::packetMillis(SF7, AprsPacket::HEADER_LENGTH + 7);
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_receive_at_trace_time(void) {
+  const char    *text = "1000 -90 5 ok A>B:one\n"
+                        "2000 -95 4 crc A>B:two\n";
+  SimulatedRadio radio;
+  radio.begin(text, strlen(text), SF7, 500);
+  radio.startReceive(500);
+
+  uint32_t time;
+  TEST_ASSERT_TRUE(radio.getNextInterrupt(time));
+  TEST_ASSERT_EQUAL(1500, time);
+  TEST_ASSERT_FALSE(radio.isSignalDetected(1500 - AIRTIME - 1));
+  TEST_ASSERT_TRUE(radio.isSignalDetected(1500 - AIRTIME));
+  TEST_ASSERT_TRUE(radio.isSignalDetected(1499));
+
+  uint8_t    data[AprsPacket::HEADER_LENGTH + AprsPacket::MAX_LENGTH];
+  RxMetadata rx;
+  TEST_ASSERT_EQUAL(AprsPacket::HEADER_LENGTH + 7, radio.getPacketLength());
+  TEST_ASSERT_EQUAL(AprsPacket::HEADER_LENGTH + 7, radio.readData(data, sizeof(data), rx));
+  TEST_ASSERT_EQUAL(RxOkay, rx.status);
+
+  TEST_ASSERT_TRUE(radio.getNextInterrupt(time));
+  TEST_ASSERT_EQUAL(2500, time);
+  radio.readData(data, sizeof(data), rx);
+  TEST_ASSERT_EQUAL(RxCrcError, rx.status);
+  TEST_ASSERT_FALSE(radio.getNextInterrupt(time));
+  TEST_ASSERT_EQUAL(2, radio.getReceived());
+  TEST_ASSERT_EQUAL(0, radio.getMissed());
+}
+
+void test_missed_while_transmitting(void) {
+  // both packets start while we are on the air
+  const char    *text = "100 -90 5 ok A>B:one\n"
+                        "150 -90 5 ok A>B:two\n"
+                        "1000 -90 5 ok A>B:six\n";
+  SimulatedRadio radio;
+  radio.begin(text, strlen(text), SF7, 0);
+  const uint32_t airtime = LoRaAirtime::packetMillis(SF7, 100);
+  radio.startTransmit(100, 0);
+
+  uint32_t time;
+  TEST_ASSERT_TRUE(radio.getNextInterrupt(time));
+  TEST_ASSERT_EQUAL(airtime, time);
+  TEST_ASSERT_EQUAL(1, radio.getTransmitted());
+  TEST_ASSERT_EQUAL(airtime, radio.getTransmittedAirtime());
+
+  radio.startReceive(time);
+  TEST_ASSERT_TRUE(radio.getNextInterrupt(time));
+  TEST_ASSERT_EQUAL(1000, time);
+  TEST_ASSERT_EQUAL(2, radio.getMissed());
+}
+
+void test_collision_while_receiving(void) {
+  const char    *text = "1000 -90 5 ok A>B:one\n"
+                        "1010 -90 5 ok A>B:two\n"
+                        "2000 -90 5 ok A>B:six\n";
+  SimulatedRadio radio;
+  radio.begin(text, strlen(text), SF7, 0);
+  radio.startReceive(0);
+
+  uint8_t    data[AprsPacket::HEADER_LENGTH + AprsPacket::MAX_LENGTH];
+  RxMetadata rx;
+  radio.readData(data, sizeof(data), rx);
+  uint32_t time;
+  TEST_ASSERT_TRUE(radio.getNextInterrupt(time));
+  TEST_ASSERT_EQUAL(2000, time);
+  TEST_ASSERT_EQUAL(1, radio.getMissed());
+}
+
+void test_channel_scan(void) {
+  const char    *text = "1000 -90 5 ok A>B:one\n";
+  SimulatedRadio radio;
+  radio.begin(text, strlen(text), SF7, 0);
+
+  radio.startChannelScan(0);
+  uint32_t time;
+  TEST_ASSERT_TRUE(radio.getNextInterrupt(time));
+  TEST_ASSERT_TRUE(time > 0);
+  TEST_ASSERT_FALSE(radio.isChannelBusy());
+
+  // the preamble starts during the scan
+  radio.startChannelScan(1000 - AIRTIME - 1);
+  TEST_ASSERT_TRUE(radio.isChannelBusy());
+  TEST_ASSERT_EQUAL(0, radio.getMissed());
+
+  // the packet is already on the air, its preamble is gone
+  radio.startChannelScan(1000 - AIRTIME + 1);
+  TEST_ASSERT_FALSE(radio.isChannelBusy());
+  TEST_ASSERT_EQUAL(1, radio.getMissed());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_receive_at_trace_time);
+  RUN_TEST(test_missed_while_transmitting);
+  RUN_TEST(test_collision_while_receiving);
+  RUN_TEST(test_channel_scan);
+  return UNITY_END();
+}
@@ -0,0 +1,160 @@
+#include <memory>
+#include <thread>
+#include <unity.h>
+
+#include "System/TaskQueue.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_fifo_order(void) {
+  TaskQueue<int, 8> queue;
+  TEST_ASSERT_TRUE(queue.empty());
+  for (int i = 0; i < 5; i++) {
+    TEST_ASSERT_TRUE(queue.addElement(i));
+  }
+  TEST_ASSERT_EQUAL(5, queue.size());
+  for (int i = 0; i < 5; i++) {
+    TEST_ASSERT_EQUAL(i, queue.getElement());
+  }
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_EQUAL(0, queue.getElement());
+}
+
+void test_wrap_around(void) {
+  TaskQueue<int, 4> queue;
+  for (int round = 0; round < 100; round++) {
+    TEST_ASSERT_TRUE(queue.addElement(round));
+    TEST_ASSERT_TRUE(queue.addElement(round + 1000));
+    TEST_ASSERT_EQUAL(round, queue.getElement());
+    TEST_ASSERT_EQUAL(round + 1000, queue.getElement());
+  }
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_EQUAL(2, queue.getHighWatermark());
+}
+
+void test_overflow_drop_oldest(void) {
+  TaskQueue<int, 4> queue(TaskQueueOverflow::DropOldest);
+  for (int i = 0; i < 6; i++) {
+    TEST_ASSERT_TRUE(queue.addElement(i));
+  }
+  TEST_ASSERT_EQUAL(4, queue.size());
+  TEST_ASSERT_EQUAL(2, queue.getDroppedCount());
+  for (int i = 2; i < 6; i++) {
+    TEST_ASSERT_EQUAL(i, queue.getElement());
+  }
+}
+
+void test_overflow_drop_newest(void) {
+  TaskQueue<int, 4> queue(TaskQueueOverflow::DropNewest);
+  for (int i = 0; i < 6; i++) {
+    TEST_ASSERT_TRUE(queue.addElement(i));
+  }
+  TEST_ASSERT_EQUAL(2, queue.getDroppedCount());
+  TEST_ASSERT_EQUAL(0, queue.getRejectedCount());
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(i, queue.getElement());
+  }
+}
+
+void test_overflow_reject(void) {
+  TaskQueue<int, 4> queue(TaskQueueOverflow::Reject);
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(queue.addElement(i));
+  }
+  TEST_ASSERT_FALSE(queue.addElement(4));
+  TEST_ASSERT_EQUAL(1, queue.getRejectedCount());
+  TEST_ASSERT_EQUAL(0, queue.getDroppedCount());
+  TEST_ASSERT_EQUAL(0, queue.getElement());
+  TEST_ASSERT_TRUE(queue.addElement(4));
+}
+
+void test_releases_shared_ptr(void) {
+  std::shared_ptr<int> elem = std::make_shared<int>(42);
+  {
+    TaskQueue<std::shared_ptr<int>, 4> queue;
+    queue.addElement(elem);
+    TEST_ASSERT_EQUAL(2, elem.use_count());
+    std::shared_ptr<int> out = queue.getElement();
+    TEST_ASSERT_EQUAL(42, *out);
+  }
+  TEST_ASSERT_EQUAL(1, elem.use_count());
+}
+
+static const uint32_t SPSC_COUNT = 200000;
+
+void test_spsc_threads(void) {
+  TaskQueue<uint32_t, 64> queue(TaskQueueOverflow::Reject);
+
+  std::thread producer([&queue]() {
+    for (uint32_t i = 1; i <= SPSC_COUNT;) {
+      if (queue.addElement(i)) {
+        i++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 1;
+  bool     inOrder  = true;
+  while (expected <= SPSC_COUNT) {
+    if (!queue.empty()) {
+      uint32_t elem = queue.getElement();
+      inOrder &= (elem == expected);
+      expected++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  TEST_ASSERT_TRUE(inOrder);
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_spsc_drop_oldest_threads(void) {
+  TaskQueue<uint32_t, 16> queue(TaskQueueOverflow::DropOldest);
+
+  std::atomic<bool> done(false);
+  std::thread       producer([&queue, &done]() {
+    for (uint32_t i = 1; i <= SPSC_COUNT; i++) {
+      queue.addElement(i);
+    }
+    done = true;
+  });
+
+  uint32_t last     = 0;
+  uint32_t received = 0;
+  bool     inOrder  = true;
+  while (!done || !queue.empty()) {
+    if (!queue.empty()) {
+      uint32_t elem = queue.getElement();
+      if (elem != 0) {
+        inOrder &= (elem > last);
+        last = elem;
+        received++;
+      }
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  TEST_ASSERT_TRUE(inOrder);
+  TEST_ASSERT_EQUAL(SPSC_COUNT, received + queue.getDroppedCount());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo_order);
+  RUN_TEST(test_wrap_around);
+  RUN_TEST(test_overflow_drop_oldest);
+  RUN_TEST(test_overflow_drop_newest);
+  RUN_TEST(test_overflow_reject);
+  RUN_TEST(test_releases_shared_ptr);
+  RUN_TEST(test_spsc_threads);
+  RUN_TEST(test_spsc_drop_oldest_threads);
+  return UNITY_END();
+}
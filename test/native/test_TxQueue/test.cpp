@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include "LoRa/TxQueue.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static std::shared_ptr<AprsPacket> packet(const char *source) {
+  std::shared_ptr<AprsPacket> p = AprsPacket::create();
+  char                        line[64];
+  snprintf(line, sizeof(line), "%s>APRS:>status", source);
+  TEST_ASSERT_TRUE(p->decode(line));
+  return p;
+}
+
+static void expectReady(TxQueue &queue, const char *source, uint32_t now) {
+  TxQueue::Entry entry;
+  TEST_ASSERT_EQUAL(TxQueueReady, queue.pop(entry, now));
+  TEST_ASSERT_TRUE(entry.packet->getSource().equals(source));
+}
+
+void test_fifo_within_class(void) {
+  TxQueue queue;
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_EQUAL(0, queue.getNextDue(0));
+  queue.push(packet("A"), TxClassBeacon, 10);
+  queue.push(packet("B"), TxClassBeacon, 20);
+  TEST_ASSERT_FALSE(queue.empty());
+  TEST_ASSERT_TRUE(queue.isDue(30));
+
+  TxQueue::Entry entry;
+  TEST_ASSERT_EQUAL(TxQueueReady, queue.pop(entry, 30));
+  TEST_ASSERT_EQUAL(TxClassBeacon, entry.txClass);
+  TEST_ASSERT_EQUAL(10, entry.queuedAt);
+  expectReady(queue, "B", 30);
+  TEST_ASSERT_EQUAL(TxQueueEmpty, queue.pop(entry, 30));
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_priority(void) {
+  TxQueue queue;
+  queue.push(packet("IS1"), TxClassIsToRf, 0);
+  queue.push(packet("IS2"), TxClassIsToRf, 0);
+  queue.push(packet("BCN"), TxClassBeacon, 0);
+  queue.push(packet("DIGI"), TxClassDigi, 0);
+  queue.push(packet("MSG"), TxClassMessage, 0);
+  expectReady(queue, "MSG", 1);
+  expectReady(queue, "DIGI", 1);
+  expectReady(queue, "BCN", 1);
+  expectReady(queue, "IS1", 1);
+  // arrives while IS to RF traffic is still queued, goes first
+  queue.push(packet("MSG2"), TxClassMessage, 2);
+  expectReady(queue, "MSG2", 3);
+  expectReady(queue, "IS2", 3);
+}
+
+void test_fair_share(void) {
+  TxQueue queue;
+  queue.setWeight(TxClassDigi, 3);
+  queue.setWeight(TxClassIsToRf, 1);
+  char name[8];
+  for (int i = 0; i < 8; i++) {
+    snprintf(name, sizeof(name), "D%d", i);
+    queue.push(packet(name), TxClassDigi, 0);
+    snprintf(name, sizeof(name), "I%d", i);
+    queue.push(packet(name), TxClassIsToRf, 0);
+  }
+
+  // per round three digipeats and one IS to RF packet
+  const char *expected[] = {"D0", "D1", "D2", "I0", "D3", "D4", "D5", "I1", "D6", "D7", "I2", "I3"};
+  for (const char *source : expected) {
+    expectReady(queue, source, 1);
+  }
+}
+
+void test_max_age(void) {
+  TxQueue queue;
+  queue.setMaxAge(TxClassIsToRf, 1000);
+  queue.push(packet("OLD"), TxClassIsToRf, 0);
+  queue.push(packet("NEW"), TxClassIsToRf, 800);
+
+  TxQueue::Entry entry;
+  TEST_ASSERT_EQUAL(TxQueueExpired, queue.pop(entry, 1500));
+  TEST_ASSERT_TRUE(entry.packet->getSource().equals("OLD"));
+  expectReady(queue, "NEW", 1500);
+
+  // no limit
+  queue.setMaxAge(TxClassIsToRf, 0);
+  queue.push(packet("ANY"), TxClassIsToRf, 0);
+  expectReady(queue, "ANY", 1000000);
+}
+
+void test_digi_slots(void) {
+  TxQueue queue;
+  queue.setDigiSlots(4, 100);
+  queue.setRandomSeed(12345);
+
+  int delayed = 0;
+  for (int i = 0; i < 16; i++) {
+    const uint32_t now = i * 1000;
+    queue.push(packet("DIGI"), TxClassDigi, now);
+    // not looked at yet
+    TEST_ASSERT_TRUE(queue.isDue(now));
+
+    TxQueue::Entry entry;
+    if (queue.pop(entry, now) == TxQueueReady) {
+      continue;
+    }
+    delayed++;
+    const uint32_t due = queue.getNextDue(now);
+    TEST_ASSERT_TRUE(due > now && due <= now + 400);
+    TEST_ASSERT_EQUAL(0, (due - now) % 100);
+    TEST_ASSERT_FALSE(queue.isDue(due - 1));
+    TEST_ASSERT_EQUAL(TxQueueWaiting, queue.pop(entry, due - 1));
+    TEST_ASSERT_TRUE(queue.isDue(due));
+    TEST_ASSERT_EQUAL(TxQueueReady, queue.pop(entry, due));
+  }
+  TEST_ASSERT_TRUE(delayed > 0 && delayed < 16);
+
+  // other classes are not held back
+  queue.setDigiSlots(0, 0);
+  queue.push(packet("DIGI"), TxClassDigi, 20000);
+  queue.push(packet("BCN"), TxClassBeacon, 20000);
+  expectReady(queue, "DIGI", 20000);
+  expectReady(queue, "BCN", 20000);
+}
+
+void test_waiting_digi_does_not_block(void) {
+  TxQueue        queue;
+  TxQueue::Entry entry;
+  queue.setDigiSlots(1, 500);
+  // find a seed that delays the digipeat
+  uint32_t seed = 1;
+  do {
+    queue.clear();
+    queue.setRandomSeed(seed++);
+    queue.push(packet("DIGI"), TxClassDigi, 0);
+  } while (queue.pop(entry, 0) != TxQueueWaiting);
+
+  queue.push(packet("IS"), TxClassIsToRf, 0);
+  expectReady(queue, "IS", 10);
+  TEST_ASSERT_EQUAL(TxQueueWaiting, queue.pop(entry, 10));
+  TEST_ASSERT_EQUAL(500, queue.getNextDue(10));
+  expectReady(queue, "DIGI", 500);
+  TEST_ASSERT_EQUAL(TxQueueEmpty, queue.pop(entry, 500));
+}
+
+void test_overflow_drops_oldest(void) {
+  TxQueue queue;
+  char    name[8];
+  for (size_t i = 0; i < TxQueue::CAPACITY + 2; i++) {
+    snprintf(name, sizeof(name), "P%u", (unsigned)i);
+    queue.push(packet(name), TxClassBeacon, 0);
+  }
+  TEST_ASSERT_EQUAL(2, queue.getDropped(TxClassBeacon));
+  TEST_ASSERT_EQUAL(0, queue.getDropped(TxClassDigi));
+  expectReady(queue, "P2", 0);
+
+  queue.clear();
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main(void) {
+  AprsPacket::getPool().begin(32);
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo_within_class);
+  RUN_TEST(test_priority);
+  RUN_TEST(test_fair_share);
+  RUN_TEST(test_max_age);
+  RUN_TEST(test_digi_slots);
+  RUN_TEST(test_waiting_digi_does_not_block);
+  RUN_TEST(test_overflow_drops_oldest);
+  return UNITY_END();
+}